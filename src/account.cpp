@@ -233,7 +233,11 @@ const QString &AssetsAccount::maintainer() const {return s_maintainer;}
 void AssetsAccount::setMaintainer(QString maintainer_name) {s_maintainer = maintainer_name.trimmed();}
 int AssetsAccount::accountType() const {return at_type;}
 Currency *AssetsAccount::currency() const {if(!o_currency) return o_budget->defaultCurrency(); return o_currency;}
-void AssetsAccount::setCurrency(Currency *new_currency) {o_currency = new_currency;}
+void AssetsAccount::setCurrency(Currency *new_currency) {
+	if(o_currency == new_currency) return;
+	o_currency = new_currency;
+	if(o_budget) o_budget->accountCurrencyModified(this);
+}
 
 bool account_list_less_than(Account *t1, Account *t2) {
 	if(t1->type() != ACCOUNT_TYPE_ASSETS && t2->type() != ACCOUNT_TYPE_ASSETS) {
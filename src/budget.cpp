@@ -39,7 +39,16 @@
 #include <QNetworkReply>
 #include <QProcess>
 #include <QTemporaryFile>
+#include <QBuffer>
+#include <QtEndian>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QCryptographicHash>
+#include <QUuid>
 #include <math.h>
+#include <string.h>
+#include <algorithm>
 
 #include <QDebug>
 
@@ -113,51 +122,744 @@ bool transactions_less_than_trade_stamp(Transactions *t1, SecurityTrade *t2) {
 }
 
 bool transaction_list_less_than_stamp(Transaction *t1, Transaction *t2) {
-	if(t1->timestamp() < t2->timestamp()) return true;
-	if(t1->timestamp() > t2->timestamp()) return false;
-	if(t1->timestamp() == 0) {
-		if(t1->date() < t2->date()) return true;
-		if(t1->date() > t2->date()) return false;
+	qint64 k1 = t1->stampSortKey(), k2 = t2->stampSortKey();
+	if(k1 >= 0 && k2 >= 0) {
+		if(k1 < k2) return true;
+		if(k1 > k2) return false;
+	} else {
+		if(t1->timestamp() < t2->timestamp()) return true;
+		if(t1->timestamp() > t2->timestamp()) return false;
+		if(t1->timestamp() == 0) {
+			if(t1->date() < t2->date()) return true;
+			if(t1->date() > t2->date()) return false;
+		}
 	}
 	if(t1->parentSplit()) {
 		if(!t2->parentSplit()) {
-			return t2->description().localeAwareCompare(t1->parentSplit()->description()) < 0;
+			return t2->descriptionSortKey().compare(t1->parentSplit()->descriptionSortKey()) < 0;
 		} else if(t1->parentSplit() != t2->parentSplit()) {
 			if(t1->parentSplit()->timestamp() != t2->parentSplit()->timestamp()) return t1->parentSplit()->timestamp() < t2->parentSplit()->timestamp();
-			int r = t2->parentSplit()->description().localeAwareCompare(t1->parentSplit()->description());
+			int r = t2->parentSplit()->descriptionSortKey().compare(t1->parentSplit()->descriptionSortKey());
 			if(r == 0) return (void*) t1->parentSplit() < (void*) t2->parentSplit();
 			else return r < 0;
 		}
 	} else if(t2->parentSplit()) {
-		return t2->parentSplit()->description().localeAwareCompare(t1->description()) < 0;
+		return t2->parentSplit()->descriptionSortKey().compare(t1->descriptionSortKey()) < 0;
 	}
-	return t2->description().localeAwareCompare(t1->description()) < 0;
+	return t2->descriptionSortKey().compare(t1->descriptionSortKey()) < 0;
 }
 bool transaction_list_less_than(Transaction *t1, Transaction *t2) {
-	if(t1->date() < t2->date()) return true;
-	if(t1->date() > t2->date()) return false;
-	if(t1->timestamp() < t2->timestamp()) return true;
-	if(t1->timestamp() > t2->timestamp()) return false;
+	qint64 k1 = t1->sortKey(), k2 = t2->sortKey();
+	if(k1 >= 0 && k2 >= 0) {
+		if(k1 < k2) return true;
+		if(k1 > k2) return false;
+	} else {
+		if(t1->date() < t2->date()) return true;
+		if(t1->date() > t2->date()) return false;
+		if(t1->timestamp() < t2->timestamp()) return true;
+		if(t1->timestamp() > t2->timestamp()) return false;
+	}
 	if(t1->parentSplit()) {
 		if(!t2->parentSplit()) {
-			return t2->description().localeAwareCompare(t1->parentSplit()->description()) < 0;
+			return t2->descriptionSortKey().compare(t1->parentSplit()->descriptionSortKey()) < 0;
 		} else if(t1->parentSplit() != t2->parentSplit()) {
 			if(t1->parentSplit()->timestamp() != t2->parentSplit()->timestamp()) return t1->parentSplit()->timestamp() < t2->parentSplit()->timestamp();
-			int r = t2->parentSplit()->description().localeAwareCompare(t1->parentSplit()->description());
+			int r = t2->parentSplit()->descriptionSortKey().compare(t1->parentSplit()->descriptionSortKey());
 			if(r == 0) return (void*) t1->parentSplit() < (void*) t2->parentSplit();
 			else return r < 0;
 		}
 	} else if(t2->parentSplit()) {
-		return t2->parentSplit()->description().localeAwareCompare(t1->description()) < 0;
+		return t2->parentSplit()->descriptionSortKey().compare(t1->descriptionSortKey()) < 0;
+	}
+	return t2->descriptionSortKey().compare(t1->descriptionSortKey()) < 0;
+}
+bool date_transaction_less_than(const QDate &date, Transaction *t) {
+	return date < t->date();
+}
+uint transaction_duplicate_key(const Transactions *transs) {
+	//fields that equals() compares strictly, also in non-strict mode; description is left out since it can change without notification
+	uint key = (uint) qHash(transs->date());
+	switch(transs->generaltype()) {
+		case GENERAL_TRANSACTION_TYPE_SINGLE: {
+			const Transaction *trans = (const Transaction*) transs;
+			key = key * 31 + (uint) trans->type();
+			key = key * 31 + (uint) qHash(trans->value());
+			key = key * 31 + (uint) qHash(trans->fromAccount());
+			key = key * 31 + (uint) qHash(trans->toAccount());
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SPLIT: {
+			const SplitTransaction *split = (const SplitTransaction*) transs;
+			key = key * 31 + (uint) split->type();
+			key = key * 31 + (uint) split->count();
+			for(QVector<Transaction*>::const_iterator it = split->splits.constBegin(); it != split->splits.constEnd(); ++it) key = key * 31 + transaction_duplicate_key(*it);
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
+			const ScheduledTransaction *strans = (const ScheduledTransaction*) transs;
+			if(strans->transaction()) key = transaction_duplicate_key(strans->transaction());
+			key = key * 31 + (uint) GENERAL_TRANSACTION_TYPE_SCHEDULE;
+			break;
+		}
+	}
+	return key;
+}
+void add_text_keys(const QString &str, QVector<quint64> &keys) {
+	//case folded trigrams
+	if(str.length() < 3) return;
+	QString folded = str.toCaseFolded();
+	for(int i = 0; i + 2 < folded.length(); i++) {
+		keys << (((quint64) folded.at(i).unicode() << 32) | ((quint64) folded.at(i + 1).unicode() << 16) | (quint64) folded.at(i + 2).unicode());
+	}
+}
+void add_transaction_text_keys(const Transactions *transs, QVector<quint64> &keys) {
+	switch(transs->generaltype()) {
+		case GENERAL_TRANSACTION_TYPE_SINGLE: {
+			const Transaction *trans = (const Transaction*) transs;
+			add_text_keys(trans->description(), keys);
+			add_text_keys(trans->comment(), keys);
+			add_text_keys(trans->payee(), keys);
+			int c = trans->tagsCount(true);
+			for(int i = 0; i < c; i++) add_text_keys(trans->getTag(i, true), keys);
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SPLIT: {
+			//splits are matched also by the text of their parts
+			const SplitTransaction *split = (const SplitTransaction*) transs;
+			add_text_keys(split->description(), keys);
+			add_text_keys(split->comment(), keys);
+			int c = split->tagsCount(false);
+			for(int i = 0; i < c; i++) add_text_keys(split->getTag(i, false), keys);
+			for(QVector<Transaction*>::const_iterator it = split->splits.constBegin(); it != split->splits.constEnd(); ++it) add_transaction_text_keys(*it, keys);
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
+			const ScheduledTransaction *strans = (const ScheduledTransaction*) transs;
+			if(strans->transaction()) add_transaction_text_keys(strans->transaction(), keys);
+			break;
+		}
+	}
+}
+Transactions *find_duplicate_transactions(const QMultiHash<uint, Transactions*> &index, Transactions *trans) {
+	uint key = transaction_duplicate_key(trans);
+	QMultiHash<uint, Transactions*>::const_iterator it = index.constFind(key);
+	while(it != index.constEnd() && it.key() == key) {
+		if(trans != *it && trans->equals(*it, false)) return *it;
+		++it;
+	}
+	return NULL;
+}
+/*
+Binary snapshot (see eqz_file_format). All numbers are little-endian.
+Header (64 bytes): magic, format version, file revision, record size, last id, string count, record count,
+and the positions of the string table, transaction records and embedded XML document (with size).
+*/
+#define BINARY_SNAPSHOT_MAGIC "EQZB"
+#define BINARY_SNAPSHOT_VERSION 1
+#define BINARY_SNAPSHOT_HEADER_SIZE 64
+#define BINARY_SNAPSHOT_RECORD_SIZE 112
+
+#define BINARY_RECORD_EXPENSE 1
+#define BINARY_RECORD_INCOME 2
+#define BINARY_RECORD_TRANSFER 3
+
+#define BINARY_RECORD_FROM_RECONCILED 0x01
+#define BINARY_RECORD_TO_RECONCILED 0x02
+
+struct BinarySnapshot {
+	QVector<QString> strings;
+	const uchar *records;
+	quint32 record_count, record_size;
+};
+struct BinaryStringTable {
+	QHash<QString, quint32> index;
+	QVector<QString> strings;
+};
+
+quint32 binary_get_u32(const uchar *p) {return qFromLittleEndian<quint32>(p);}
+qint64 binary_get_i64(const uchar *p) {return qFromLittleEndian<qint64>(p);}
+double binary_get_double(const uchar *p) {
+	quint64 bits = qFromLittleEndian<quint64>(p);
+	double d;
+	memcpy(&d, &bits, sizeof(double));
+	return d;
+}
+void binary_put_u32(uchar *p, quint32 v) {qToLittleEndian<quint32>(v, p);}
+void binary_put_i64(uchar *p, qint64 v) {qToLittleEndian<qint64>(v, p);}
+void binary_put_double(uchar *p, double d) {
+	quint64 bits;
+	memcpy(&bits, &d, sizeof(double));
+	qToLittleEndian<quint64>(bits, p);
+}
+quint32 binary_string_index(BinaryStringTable &table, const QString &str) {
+	if(str.isEmpty()) return 0;
+	QHash<QString, quint32>::const_iterator it = table.index.constFind(str);
+	if(it != table.index.constEnd()) return it.value();
+	quint32 i = table.strings.count();
+	table.strings << str;
+	table.index.insert(str, i);
+	return i;
+}
+int binary_snapshot_revision(QFile &file) {
+	file.setTextModeEnabled(false);
+	QByteArray header = file.read(BINARY_SNAPSHOT_HEADER_SIZE);
+	if(header.size() < BINARY_SNAPSHOT_HEADER_SIZE) return -1;
+	int revision = binary_get_u32((const uchar*) header.constData() + 8);
+	if(revision <= 0) revision = 1;
+	return revision;
+}
+QString binary_snapshot_string(const BinarySnapshot *snapshot, quint32 index) {
+	if(index < (quint32) snapshot->strings.count()) return snapshot->strings.at(index);
+	return QString();
+}
+int binary_record_type(const Transaction *trans, const AssetsAccount *balancing_account) {
+	if(trans->parentSplit()) return 0;
+	switch(trans->subtype()) {
+		case TRANSACTION_SUBTYPE_EXPENSE: return BINARY_RECORD_EXPENSE;
+		case TRANSACTION_SUBTYPE_INCOME: {
+			if(((Income*) trans)->security()) return 0;
+			return BINARY_RECORD_INCOME;
+		}
+		case TRANSACTION_SUBTYPE_TRANSFER: {
+			if(trans->fromAccount() == balancing_account || trans->toAccount() == balancing_account) return 0;
+			return BINARY_RECORD_TRANSFER;
+		}
+		default: {}
+	}
+	return 0;
+}
+/*
+Record layout (offset: field):
+0: type (u8), 1: flags (u8), 4: first revision (i32), 8: last revision (i32), 12: description (string index),
+16: id, 24: date (julian day), 32: timestamp, 40: value, 48: deposit (transfers), 56: quantity,
+64: from account id, 72: to account id, 80: reserved (i64),
+88: comment, 92: associated file, 96: payee/payer, 100: tags, 104: links (string indices), 108: reserved
+*/
+void write_binary_record(uchar *p, Transaction *trans, int type, BinaryStringTable &table) {
+	p[0] = type;
+	p[1] = 0;
+	binary_put_u32(p + 4, trans->firstRevision());
+	binary_put_u32(p + 8, trans->lastRevision());
+	binary_put_u32(p + 12, binary_string_index(table, trans->description()));
+	binary_put_i64(p + 16, trans->id());
+	binary_put_i64(p + 24, trans->date().toJulianDay());
+	binary_put_i64(p + 32, trans->timestamp());
+	binary_put_double(p + 40, trans->value());
+	binary_put_double(p + 48, type == BINARY_RECORD_TRANSFER ? ((Transfer*) trans)->deposit() : trans->value());
+	binary_put_double(p + 56, trans->quantity());
+	binary_put_i64(p + 64, trans->fromAccount()->id());
+	binary_put_i64(p + 72, trans->toAccount()->id());
+	binary_put_u32(p + 88, binary_string_index(table, trans->comment()));
+	binary_put_u32(p + 92, binary_string_index(table, trans->associatedFile()));
+	binary_put_u32(p + 100, binary_string_index(table, trans->writeTags(false)));
+	binary_put_u32(p + 104, binary_string_index(table, trans->writeLinks(false)));
+	switch(type) {
+		case BINARY_RECORD_EXPENSE: {
+			Expense *expense = (Expense*) trans;
+			if(expense->isReconciled(expense->from())) p[1] |= BINARY_RECORD_FROM_RECONCILED;
+			binary_put_u32(p + 96, binary_string_index(table, expense->payee()));
+			break;
+		}
+		case BINARY_RECORD_INCOME: {
+			Income *income = (Income*) trans;
+			if(income->isReconciled(income->to())) p[1] |= BINARY_RECORD_TO_RECONCILED;
+			binary_put_u32(p + 96, binary_string_index(table, income->payer()));
+			break;
+		}
+		case BINARY_RECORD_TRANSFER: {
+			Transfer *transfer = (Transfer*) trans;
+			if(transfer->isReconciled(transfer->from())) p[1] |= BINARY_RECORD_FROM_RECONCILED;
+			if(transfer->isReconciled(transfer->to())) p[1] |= BINARY_RECORD_TO_RECONCILED;
+			break;
+		}
+	}
+}
+Transaction *read_binary_record(Budget *budget, const BinarySnapshot *snapshot, const uchar *p, bool *valid) {
+	qlonglong id = binary_get_i64(p + 16);
+	QDate date = QDate::fromJulianDay(binary_get_i64(p + 24));
+	double value = binary_get_double(p + 40);
+	qlonglong id_from = binary_get_i64(p + 64);
+	qlonglong id_to = binary_get_i64(p + 72);
+	QString description = binary_snapshot_string(snapshot, binary_get_u32(p + 12));
+	QString comment = binary_snapshot_string(snapshot, binary_get_u32(p + 88));
+	Transaction *trans = NULL;
+	switch(p[0]) {
+		case BINARY_RECORD_EXPENSE: {
+			if(!budget->expensesAccounts_id.contains(id_to) || !budget->assetsAccounts_id.contains(id_from)) break;
+			Expense *expense = new Expense(budget, value, date, budget->expensesAccounts_id[id_to], budget->assetsAccounts_id[id_from], description, comment, id);
+			expense->setPayee(binary_snapshot_string(snapshot, binary_get_u32(p + 96)));
+			expense->setReconciled(expense->from(), p[1] & BINARY_RECORD_FROM_RECONCILED);
+			trans = expense;
+			break;
+		}
+		case BINARY_RECORD_INCOME: {
+			if(!budget->incomesAccounts_id.contains(id_from) || !budget->assetsAccounts_id.contains(id_to)) break;
+			Income *income = new Income(budget, value, date, budget->incomesAccounts_id[id_from], budget->assetsAccounts_id[id_to], description, comment, id);
+			income->setPayer(binary_snapshot_string(snapshot, binary_get_u32(p + 96)));
+			income->setReconciled(income->to(), p[1] & BINARY_RECORD_TO_RECONCILED);
+			trans = income;
+			break;
+		}
+		case BINARY_RECORD_TRANSFER: {
+			if(!budget->assetsAccounts_id.contains(id_from) || !budget->assetsAccounts_id.contains(id_to)) break;
+			Transfer *transfer = new Transfer(budget, value, binary_get_double(p + 48), date, budget->assetsAccounts_id[id_from], budget->assetsAccounts_id[id_to], description, comment, id);
+			transfer->setReconciled(transfer->from(), p[1] & BINARY_RECORD_FROM_RECONCILED);
+			transfer->setReconciled(transfer->to(), p[1] & BINARY_RECORD_TO_RECONCILED);
+			trans = transfer;
+			break;
+		}
 	}
-	return t2->description().localeAwareCompare(t1->description()) < 0;
+	if(!trans) {
+		if(valid) *valid = false;
+		return NULL;
+	}
+	if(valid && (*valid)) *valid = date.isValid();
+	trans->setFirstRevision(binary_get_u32(p + 4));
+	trans->setLastRevision(binary_get_u32(p + 8));
+	trans->readTimestampAndQuantity(binary_get_i64(p + 32), binary_get_double(p + 56));
+	trans->setAssociatedFile(binary_snapshot_string(snapshot, binary_get_u32(p + 92)));
+	QString tags_text = binary_snapshot_string(snapshot, binary_get_u32(p + 100));
+	if(!tags_text.isEmpty()) trans->readTags(tags_text);
+	QString links_text = binary_snapshot_string(snapshot, binary_get_u32(p + 104));
+	if(!links_text.isEmpty()) trans->readLinks(links_text);
+	return trans;
+}
+struct LoadedTransactionElement {
+	Transaction *trans;
+	SplitTransaction *split;
+	SecurityTrade *trade;
+	bool valid;
+	LoadedTransactionElement() : trans(NULL), split(NULL), trade(NULL), valid(true) {}
+};
+/*
+Constructs the object of a top level transaction element. Only reads from the budget (account and security id maps),
+and can therefore be run from several threads at once.
+*/
+void read_transaction_element(Budget *budget, QXmlStreamReader *xml, LoadedTransactionElement &element) {
+	QXmlStreamAttributes attr = xml->attributes();
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+	QStringView type = attr.value("type");
+#else
+	QStringRef type = attr.value("type");
+#endif
+	if(type.isEmpty()) {
+		if(attr.hasAttribute("shares") && attr.hasAttribute("security")) {
+			if(attr.hasAttribute("cost")) attr.append("type", "security_buy");
+			else if(attr.hasAttribute("income")) attr.append("type", "security_sell");
+			else if(attr.hasAttribute("from")) attr.append("type", "security_buy");
+			else if(attr.hasAttribute("to")) attr.append("type", "security_sell");
+		} else if(attr.hasAttribute("cost") || (attr.hasAttribute("category") && attr.hasAttribute("from"))) {
+			attr.append("type", "expense");
+		} else if(attr.hasAttribute("income") || (attr.hasAttribute("category") && attr.hasAttribute("to"))) {
+			attr.append("type", "income");
+		} else if(attr.hasAttribute("amount") || attr.hasAttribute("withdrawal")) {
+			attr.append("type", "transfer");
+		} else if(attr.hasAttribute("from") && attr.hasAttribute("to")) {
+			qlonglong id_from = attr.value("from").toLongLong();
+			qlonglong id_to = attr.value("to").toLongLong();
+			if(budget->expensesAccounts_id.contains(id_to) || budget->expensesAccounts_id.contains(id_from)) attr.append("type", "expense");
+			else if(budget->incomesAccounts_id.contains(id_from) || budget->incomesAccounts_id.contains(id_to)) attr.append("type", "income");
+			else if(budget->assetsAccounts_id.contains(id_from) && budget->assetsAccounts_id.contains(id_to)) attr.append("type", "transfer");
+		}
+		type = attr.value("type");
+	}
+	if(type == XML_COMPARE_CONST_CHAR("expense") || type == XML_COMPARE_CONST_CHAR("refund")) {
+		element.trans = new Expense(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("income") || type == XML_COMPARE_CONST_CHAR("repayment")) {
+		element.trans = new Income(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("dividend")) {
+		Income *income = new Income(budget, xml, &element.valid);
+		if(!income->security()) element.valid = false;
+		element.trans = income;
+	} else if(type == XML_COMPARE_CONST_CHAR("reinvested_dividend")) {
+		element.trans = new ReinvestedDividend(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("security_trade")) {
+		element.trade = new SecurityTrade(budget, xml, &element.valid);
+		xml->skipCurrentElement();
+	} else if(type == XML_COMPARE_CONST_CHAR("transfer")) {
+		element.trans = new Transfer(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("balancing")) {
+		element.trans = new Balancing(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("security_buy")) {
+		element.trans = new SecurityBuy(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("security_sell")) {
+		element.trans = new SecuritySell(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("multiitem") || type == XML_COMPARE_CONST_CHAR("split")) {
+		element.split = new MultiItemTransaction(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("multiaccount")) {
+		element.split = new MultiAccountTransaction(budget, xml, &element.valid);
+	} else if(type == XML_COMPARE_CONST_CHAR("debtpayment")) {
+		element.split = new DebtPayment(budget, xml, &element.valid);
+	} else {
+		xml->skipCurrentElement();
+		element.valid = false;
+	}
+}
+void delete_loaded_transaction_element(const LoadedTransactionElement &element) {
+	if(element.trans) delete element.trans;
+	if(element.split) delete element.split;
+	if(element.trade) delete element.trade;
+}
+void write_split_element(QXmlStreamWriter &xml, SplitTransaction *split) {
+	xml.writeStartElement("transaction");
+	switch(split->type()) {
+		case SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS: {
+			xml.writeAttribute("type", "multiitem");
+			break;
+		}
+		case SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS: {
+			xml.writeAttribute("type", "multiaccount");
+			break;
+		}
+		case SPLIT_TRANSACTION_TYPE_LOAN: {
+			xml.writeAttribute("type", "debtpayment");
+			break;
+		}
+	}
+	split->save(&xml);
+	xml.writeEndElement();
+}
+void write_trade_element(QXmlStreamWriter &xml, SecurityTrade *ts) {
+	xml.writeStartElement("transaction");
+	xml.writeAttribute("type", "security_trade");
+	ts->save(&xml);
+	xml.writeEndElement();
+}
+void write_transaction_element(QXmlStreamWriter &xml, Transaction *trans, Account *balancing_account) {
+	xml.writeStartElement("transaction");
+	switch(trans->type()) {
+		case TRANSACTION_TYPE_TRANSFER: {
+			if(trans->fromAccount() == balancing_account || trans->toAccount() == balancing_account) xml.writeAttribute("type", "balancing");
+			else xml.writeAttribute("type", "transfer");
+			break;
+		}
+		case TRANSACTION_TYPE_INCOME: {
+			if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) xml.writeAttribute("type", "reinvested_dividend");
+			else if(((Income*) trans)->security()) xml.writeAttribute("type", "dividend");
+			else if(trans->value() < 0.0) xml.writeAttribute("type", "repayment");
+			else xml.writeAttribute("type", "income");
+			break;
+		}
+		case TRANSACTION_TYPE_EXPENSE: {
+			if(trans->value() < 0.0) xml.writeAttribute("type", "refund");
+			else xml.writeAttribute("type", "expense");
+			break;
+		}
+		case TRANSACTION_TYPE_SECURITY_BUY: {
+			xml.writeAttribute("type", "security_buy");
+			break;
+		}
+		case TRANSACTION_TYPE_SECURITY_SELL: {
+			xml.writeAttribute("type", "security_sell");
+			break;
+		}
+	}
+	trans->save(&xml);
+	xml.writeEndElement();
+}
+
+/*
+A file saved in the background. The start of the document (including the split transactions) is written
+when the save is started, and copies of the security trades and the other transactions are written, together
+with the file, in a separate thread, while the original transactions might be modified.
+*/
+struct PendingSave {
+	QString filename;
+	QFile::Permissions permissions;
+	bool is_backup;
+	QString save_id;
+	QByteArray header_hash;
+	QByteArray data;
+	QXmlStreamWriter *xml;
+	QVector<SecurityTrade*> trades;
+	QVector<Transaction*> transactions;
+	Account *balancing_account;
+	//journal state before the save (restored if the save fails)
+	bool journal;
+	QSet<qlonglong> journal_modified_ids, journal_removed_ids;
+	QString error;
+	QAtomicInt finished;
+	QThreadPool *pool;
+	PendingSave() : is_backup(false), xml(NULL), balancing_account(NULL), journal(false), pool(NULL) {}
+};
+
+class PendingSaveWriter : public QRunnable {
+
+	protected:
+
+		PendingSave *save;
+
+	public:
+
+		PendingSaveWriter(PendingSave *pending_save) : save(pending_save) {}
+		void run() {
+			QXmlStreamWriter &xml = *save->xml;
+			for(int i = 0; i < save->trades.count(); i++) {
+				write_trade_element(xml, save->trades.at(i));
+			}
+			for(int i = 0; i < save->transactions.count(); i++) {
+				write_transaction_element(xml, save->transactions.at(i), save->balancing_account);
+			}
+			xml.writeEndElement();
+			QSaveFile ofile(save->filename);
+			ofile.setDirectWriteFallback(true);
+			ofile.open(QIODevice::WriteOnly);
+			ofile.setPermissions(save->permissions);
+			if(!ofile.isOpen()) {
+				ofile.cancelWriting();
+				save->error = Budget::tr("Couldn't open file for writing");
+			} else if(ofile.write(save->data) != save->data.size() || ofile.error() != QFile::NoError) {
+				ofile.cancelWriting();
+				save->error = Budget::tr("Error while writing file; file was not saved");
+			} else if(!ofile.commit()) {
+				save->error = Budget::tr("Error while writing file; file was not saved");
+			}
+			save->finished.storeRelease(1);
+		}
+
+};
+
+#define JOURNAL_MIN_FILE_SIZE 1000000
+#define JOURNAL_COMPACTION_RATIO 4
+
+/*
+The journal is a sequence of entry elements without a root element. Returns the revision of the last complete entry
+that belongs to the file with the specified save id, or -1 if there is none.
+*/
+int journal_revision(const QString &filename, const QString &save_id) {
+	if(save_id.isEmpty()) return -1;
+	QFile file(filename + JOURNAL_FILE_SUFFIX);
+	if(!file.open(QIODevice::ReadOnly)) return -1;
+	QByteArray data("<journal>");
+	data += file.readAll();
+	data += "</journal>";
+	file.close();
+	QXmlStreamReader xml(data);
+	int revision = -1;
+	if(xml.readNextStartElement()) {
+		while(xml.readNextStartElement()) {
+			bool is_entry = (xml.name() == XML_COMPARE_CONST_CHAR("entry") && xml.attributes().value("saveid") == save_id);
+			int entry_revision = xml.attributes().value("revision").toInt();
+			xml.skipCurrentElement();
+			if(xml.hasError()) break;
+			if(is_entry) revision = entry_revision;
+		}
+	}
+	return revision;
+}
+
+#define PARALLEL_LOAD_MIN_FILE_SIZE 1000000
+#define PARALLEL_LOAD_CHUNKS_PER_THREAD 4
+
+struct TransactionLoadState {
+	bool merge, ignore_duplicate_transactions;
+	QMultiHash<uint, Transactions*> merge_duplicates_index;
+	QHash<qlonglong, qlonglong> merge_transaction_ids;
+	QList<Transactions*> update_links_list;
+	bool set_ids;
+	int transaction_errors;
+	qint64 curtime;
+	int i_version[3];
+	TransactionLoadState(bool b_merge = false, bool b_ignore_duplicates = false) : merge(b_merge), ignore_duplicate_transactions(b_ignore_duplicates), set_ids(false), transaction_errors(0), curtime(QDateTime::currentMSecsSinceEpoch() / 1000) {
+		i_version[0] = 0; i_version[1] = 0; i_version[2] = 0;
+	}
+};
+
+struct TransactionChunk {
+	qint64 begin, end;
+	QVector<LoadedTransactionElement> elements;
+	QAtomicInt finished;
+	bool has_error;
+	QString error_string;
+	qint64 error_line, error_column;
+};
+struct TransactionChunks {
+	QByteArray data;
+	qint64 tail_begin, tail_end;
+	int threads;
+	QVector<TransactionChunk> chunks;
+	bool has_error;
+	QString error_string;
+	qint64 error_line, error_column;
+	//progressive loading: chunks are parsed in the background, and registered from the end of the document (most recent transactions first)
+	bool progressive;
+	QThreadPool *pool;
+	int next_chunk;
+	TransactionLoadState state;
+	TransactionChunks() : tail_begin(-1), tail_end(-1), threads(1), has_error(false), error_line(0), error_column(0), progressive(false), pool(NULL), next_chunk(-1) {}
+};
+qint64 transaction_chunk_error_line(const TransactionChunks *chunks, const TransactionChunk &chunk) {
+	return QByteArray::fromRawData(chunks->data.constData(), chunk.begin).count('\n') + chunk.error_line;
+}
+
+class TransactionChunkParser : public QRunnable {
+
+	protected:
+
+		Budget *budget;
+		const QByteArray *data;
+		TransactionChunk *chunk;
+
+	public:
+
+		TransactionChunkParser(Budget *parent_budget, const QByteArray *document_data, TransactionChunk *transaction_chunk) : budget(parent_budget), data(document_data), chunk(transaction_chunk) {}
+		void run() {
+			QByteArray chunk_data("<chunk>");
+			chunk_data.append(data->constData() + chunk->begin, chunk->end - chunk->begin);
+			chunk_data.append("</chunk>");
+			QXmlStreamReader xml(chunk_data);
+			if(xml.readNextStartElement()) {
+				while(xml.readNextStartElement()) {
+					LoadedTransactionElement element;
+					read_transaction_element(budget, &xml, element);
+					chunk->elements << element;
+				}
+			}
+			chunk->has_error = xml.hasError();
+			if(chunk->has_error) {
+				chunk->error_string = xml.errorString();
+				chunk->error_line = xml.lineNumber();
+				chunk->error_column = xml.columnNumber();
+			}
+			chunk->finished.storeRelease(1);
+		}
+
+};
+
+/*
+Finds the top level transaction elements at the end of the document (the elements that follow the last element of
+another type) and divides them into chunks. Returns false if the document cannot be split.
+*/
+bool split_transaction_chunks(TransactionChunks &chunks) {
+	QXmlStreamReader declaration(chunks.data.left(256));
+	if(declaration.readNext() == QXmlStreamReader::StartDocument && !declaration.documentEncoding().isEmpty() && declaration.documentEncoding().toString().compare("UTF-8", Qt::CaseInsensitive) != 0) return false;
+	const char *d = chunks.data.constData();
+	qint64 n = chunks.data.size();
+	QVector<qint64> starts;
+	qint64 tail_end = -1;
+	int depth = 0;
+	qint64 i = 0;
+	while(i < n && tail_end < 0) {
+		if(d[i] != '<') {
+			i++;
+			continue;
+		}
+		const char *end = NULL;
+		if(i + 1 >= n) return false;
+		if(d[i + 1] == '?') {
+			end = strstr(d + i, "?>");
+			if(end) end++;
+		} else if(d[i + 1] == '!') {
+			if(n - i >= 4 && strncmp(d + i, "<!--", 4) == 0) {
+				end = strstr(d + i, "-->");
+				if(end) end += 2;
+			} else if(n - i >= 9 && strncmp(d + i, "<![CDATA[", 9) == 0) {
+				end = strstr(d + i, "]]>");
+				if(end) end += 2;
+			} else {
+				end = strchr(d + i, '>');
+			}
+		} else if(d[i + 1] == '/') {
+			depth--;
+			if(depth == 0) tail_end = i;
+			end = strchr(d + i, '>');
+		} else {
+			qint64 j = i + 1;
+			char quote = 0;
+			while(j < n && (quote || d[j] != '>')) {
+				if(quote) {
+					if(d[j] == quote) quote = 0;
+				} else if(d[j] == '"' || d[j] == '\'') {
+					quote = d[j];
+				}
+				j++;
+			}
+			if(j >= n) return false;
+			if(depth == 1) {
+				if(n - i > 12 && strncmp(d + i + 1, "transaction", 11) == 0 && (d[i + 12] == '>' || d[i + 12] == '/' || d[i + 12] == ' ' || d[i + 12] == '\t' || d[i + 12] == '\n' || d[i + 12] == '\r')) {
+					starts << i;
+				} else {
+					starts.clear();
+				}
+			}
+			if(d[j - 1] != '/') depth++;
+			end = d + j;
+		}
+		if(!end || end - d >= n) return false;
+		i = end - d + 1;
+	}
+	if(tail_end < 0 || starts.isEmpty()) return false;
+	chunks.tail_begin = starts.first();
+	chunks.tail_end = tail_end;
+	int chunk_count = chunks.threads * PARALLEL_LOAD_CHUNKS_PER_THREAD;
+	if(chunk_count > starts.count()) chunk_count = starts.count();
+	qint64 chunk_size = (tail_end - chunks.tail_begin) / chunk_count + 1;
+	int start_index = 0;
+	while(start_index < starts.count()) {
+		TransactionChunk chunk;
+		chunk.begin = starts.at(start_index);
+		chunk.has_error = false;
+		chunk.error_line = 0;
+		chunk.error_column = 0;
+		start_index++;
+		while(start_index < starts.count() && starts.at(start_index) - chunk.begin < chunk_size) start_index++;
+		chunk.end = (start_index < starts.count() ? starts.at(start_index) : tail_end);
+		chunks.chunks << chunk;
+	}
+	return true;
+}
+void start_transaction_chunks(Budget *budget, TransactionChunks *chunks, QThreadPool *pool, bool reverse) {
+	//the id maps of the budget are only read while the chunks are parsed (detached here, since the readers use non-const iterators)
+	budget->assetsAccounts_id.detach();
+	budget->incomesAccounts_id.detach();
+	budget->expensesAccounts_id.detach();
+	budget->securities_id.detach();
+	pool->setMaxThreadCount(chunks->threads);
+	TransactionChunk *chunk_data = chunks->chunks.data();
+	int n = chunks->chunks.count();
+	for(int i = 0; i < n; i++) {
+		pool->start(new TransactionChunkParser(budget, &chunks->data, chunk_data + (reverse ? n - 1 - i : i)));
+	}
+}
+void parse_transaction_chunks(Budget *budget, TransactionChunks *chunks) {
+	QThreadPool pool;
+	start_transaction_chunks(budget, chunks, &pool, false);
+	pool.waitForDone();
+}
+/*
+Returns the parsed transaction elements in document order. As in the single-threaded parser, nothing after an XML error is loaded.
+*/
+bool next_loaded_transaction_element(TransactionChunks *chunks, int &chunk_index, int &element_index, LoadedTransactionElement &element) {
+	while(chunk_index < chunks->chunks.count()) {
+		const TransactionChunk &chunk = chunks->chunks.at(chunk_index);
+		if(element_index < chunk.elements.count()) {
+			element = chunk.elements.at(element_index);
+			element_index++;
+			return true;
+		}
+		if(chunk.has_error) {
+			chunks->has_error = true;
+			chunks->error_string = chunk.error_string;
+			chunks->error_line = transaction_chunk_error_line(chunks, chunk);
+			chunks->error_column = chunk.error_column;
+			for(int i = chunk_index + 1; i < chunks->chunks.count(); i++) {
+				const QVector<LoadedTransactionElement> &elements = chunks->chunks.at(i).elements;
+				for(int i2 = 0; i2 < elements.count(); i2++) delete_loaded_transaction_element(elements.at(i2));
+			}
+			chunk_index = chunks->chunks.count();
+			return false;
+		}
+		chunk_index++;
+		element_index = 0;
+	}
+	return false;
 }
 bool split_list_less_than_stamp(SplitTransaction *t1, SplitTransaction *t2) {
 	if(t1->timestamp() == 0 && t2->timestamp() == 0) return split_list_less_than(t1, t2);
-	return t1->timestamp() < t2->timestamp() || (t1->timestamp() == t2->timestamp() && t2->description().localeAwareCompare(t1->description()) < 0);
+	return t1->timestamp() < t2->timestamp() || (t1->timestamp() == t2->timestamp() && t2->descriptionSortKey().compare(t1->descriptionSortKey()) < 0);
 }
 bool split_list_less_than(SplitTransaction *t1, SplitTransaction *t2) {
-	return t1->date() < t2->date() || (t1->date() == t2->date() && (t1->timestamp() < t2->timestamp() || (t1->timestamp() == t2->timestamp() && t2->description().localeAwareCompare(t1->description()) < 0)));
+	return t1->date() < t2->date() || (t1->date() == t2->date() && (t1->timestamp() < t2->timestamp() || (t1->timestamp() == t2->timestamp() && t2->descriptionSortKey().compare(t1->descriptionSortKey()) < 0)));
 }
 bool schedule_list_less_than_stamp(ScheduledTransaction *t1, ScheduledTransaction *t2) {
 	if(t1->timestamp() == 0 && t2->timestamp() == 0) return schedule_list_less_than(t1, t2);
@@ -166,6 +868,13 @@ bool schedule_list_less_than_stamp(ScheduledTransaction *t1, ScheduledTransactio
 bool schedule_list_less_than(ScheduledTransaction *t1, ScheduledTransaction *t2) {
 	return t1->date() < t2->date() || (t1->date() == t2->date() && (t1->timestamp() < t2->timestamp() || (t1->timestamp() == t2->timestamp() && t2->description().localeAwareCompare(t1->description()) < 0)));
 }
+struct ScheduleOccurrenceCursor {
+	QDate date;
+	int schedule_index, date_index;
+};
+bool schedule_occurrence_cursor_greater(const ScheduleOccurrenceCursor &c1, const ScheduleOccurrenceCursor &c2) {
+	return c1.date > c2.date || (c1.date == c2.date && c1.schedule_index > c2.schedule_index);
+}
 bool trade_list_less_than_stamp(SecurityTrade *t1, SecurityTrade *t2) {
 	return t1->timestamp < t2->timestamp || (t1->timestamp == t2->timestamp && t1->date < t2->date);
 }
@@ -181,6 +890,7 @@ bool is_zero(double value) {
 }
 
 Budget::Budget() {
+	b_currencies_code_index_valid = false;
 	currencies.setAutoDelete(true);
 	expenses.setAutoDelete(true);
 	incomes.setAutoDelete(true);
@@ -221,6 +931,20 @@ Budget::Budget() {
 	b_record_new_accounts = false;
 	b_record_new_securities = false;
 	i_tcrd = TRANSACTION_CONVERSION_RATE_AT_DATE;
+	i_load_threads = 0;
+	pending_transactions = NULL;
+	o_thread = QThread::currentThread();
+	pending_save = NULL;
+	b_journal = false;
+	b_transactions_id_index_valid = false;
+	b_account_transactions_index_valid = false;
+	b_budget_month_aggregates_valid = false;
+	b_transactions_duplicate_index_valid = false;
+	b_transactions_text_index_valid = false;
+	b_budget_periods_valid = false;
+	b_accounts_name_index_valid = false;
+	b_securities_name_index_valid = false;
+	b_tags_index_valid = false;
 	null_incomes_account = new IncomesAccount(this, QString());
 	struct lconv *lc = localeconv();
 	monetary_decimal_separator = QString::fromLocal8Bit(lc->mon_decimal_point);
@@ -284,7 +1008,10 @@ Budget::Budget() {
 	if(monetary_decimal_separator.isEmpty()) monetary_decimal_separator = QLocale().decimalPoint();
 	if(monetary_group_separator.isEmpty()) monetary_group_separator = QLocale().groupSeparator();
 }
-Budget::~Budget() {}
+Budget::~Budget() {
+	finishSaving();
+	cancelLoading();
+}
 
 qlonglong Budget::getNewId() {
 	last_id++;
@@ -293,9 +1020,23 @@ qlonglong Budget::getNewId() {
 int Budget::revision() {return i_revision;}
 
 void Budget::clear() {
+	finishSaving();
+	cancelLoading();
+	stopJournal();
+	s_save_id = QString();
 	i_revision = 1;
 	i_opened_revision = 0;
 	last_id = 0;
+	invalidateTransactionIdIndex();
+	invalidateAccountTransactionsIndex();
+	invalidateBudgetMonthAggregates();
+	invalidateTransactionsDuplicateIndex();
+	invalidateTransactionsTextIndex();
+	invalidateScheduleOccurrences();
+	invalidateBudgetPeriods();
+	invalidateAccountNameIndex();
+	invalidateSecurityNameIndex();
+	invalidateTagIndex();
 	transactions.clear();
 	scheduledTransactions.clear();
 	splitTransactions.clear();
@@ -487,9 +1228,11 @@ void Budget::loadCurrenciesFile(QString filename, bool is_local) {
 					} else {
 						currency->setAsLocal();
 						currencies.append(currency);
+						invalidateCurrencyCodeIndex();
 					}
 				} else {
 					currencies.append(currency);
+					invalidateCurrencyCodeIndex();
 				}
 			} else {
 				currency_errors++;
@@ -553,13 +1296,13 @@ QString Budget::loadECBData(QByteArray data) {
 								}
 								Currency *cur = findCurrency(code);
 								if(cur) {
-									bool keep_old = cur->rates.size() > 1;
+									bool keep_old = cur->exchangeRateCount() > 1;
 									if(!keep_old) {
 										for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
 											if((*it)->currency() == cur) {keep_old = true; break;}
 										}
 									}
-									if(!keep_old) cur->rates.clear();
+									if(!keep_old) cur->clearExchangeRates();
 									cur->setExchangeRate(exrate, date);
 								} else {
 									cur = new Currency(this, code, QString(), QString(), exrate, date);
@@ -615,13 +1358,13 @@ QString Budget::loadExchangerateHostData(QByteArray data) {
 			}
 			Currency *cur = findCurrency(code);
 			if(cur && cur->exchangeRateSource() != EXCHANGE_RATE_SOURCE_ECB) {
-				bool keep_old = cur->rates.size() > 1;
+				bool keep_old = cur->exchangeRateCount() > 1;
 				if(!keep_old) {
 					for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
 						if((*it)->currency() == cur) {keep_old = true; break;}
 					}
 				}
-				if(!keep_old) cur->rates.clear();
+				if(!keep_old) cur->clearExchangeRates();
 				cur->setExchangeRate(exrate, date);
 				cur->setExchangeRateSource(EXCHANGE_RATE_SOURCE_EXCHANGERATE_HOST);
 			}
@@ -663,13 +1406,13 @@ QString Budget::loadFloatratesComData(QByteArray data) {
 			}
 			Currency *cur = findCurrency(code);
 			if(cur && cur->exchangeRateSource() != EXCHANGE_RATE_SOURCE_ECB) {
-				bool keep_old = cur->rates.size() > 1;
+				bool keep_old = cur->exchangeRateCount() > 1;
 				if(!keep_old) {
 					for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
 						if((*it)->currency() == cur) {keep_old = true; break;}
 					}
 				}
-				if(!keep_old) cur->rates.clear();
+				if(!keep_old) cur->clearExchangeRates();
 				cur->setExchangeRate(exrate);
 				cur->setExchangeRateSource(EXCHANGE_RATE_SOURCE_FLOATRATES_COM);
 			}
@@ -710,13 +1453,13 @@ QString Budget::loadMyCurrencyNetData(QByteArray data) {
 				}
 				Currency *cur = findCurrency(code);
 				if(cur && cur->exchangeRateSource() != EXCHANGE_RATE_SOURCE_ECB) {
-					bool keep_old = cur->rates.size() > 1;
+					bool keep_old = cur->exchangeRateCount() > 1;
 					if(!keep_old) {
 						for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
 							if((*it)->currency() == cur) {keep_old = true; break;}
 						}
 					}
-					if(!keep_old) cur->rates.clear();
+					if(!keep_old) cur->clearExchangeRates();
 					cur->setExchangeRate(exrate);
 					cur->setExchangeRateSource(EXCHANGE_RATE_SOURCE_MYCURRENCY_NET);
 				}
@@ -778,13 +1521,13 @@ QString Budget::loadMyCurrencyNetHtml(QByteArray data) {
 			}
 			Currency *cur = findCurrency(code);
 			if(cur && cur->exchangeRateSource() != EXCHANGE_RATE_SOURCE_ECB) {
-				bool keep_old = cur->rates.size() > 1;
+				bool keep_old = cur->exchangeRateCount() > 1;
 				if(!keep_old) {
 					for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
 						if((*it)->currency() == cur) {keep_old = true; break;}
 					}
 				}
-				if(!keep_old) cur->rates.clear();
+				if(!keep_old) cur->clearExchangeRates();
 				cur->setExchangeRate(exrate * usd_rate);
 				cur->setExchangeRateSource(EXCHANGE_RATE_SOURCE_MYCURRENCY_NET);
 			}
@@ -853,7 +1596,19 @@ QString Budget::saveCurrencies() {
 TransactionConversionRateDate Budget::defaultTransactionConversionRateDate() const {return i_tcrd;}
 void Budget::setDefaultTransactionConversionRateDate(TransactionConversionRateDate tcrd) {i_tcrd = tcrd;}
 
-QString Budget::loadFile(QString filename, QString &errors, bool *default_currency_created, bool merge, bool rename_duplicate_accounts, bool rename_duplicate_categories, bool rename_duplicate_securities, bool ignore_duplicate_transactions) {
+int Budget::loadThreadCount() const {
+	if(i_load_threads > 0) return i_load_threads;
+	return QThread::idealThreadCount();
+}
+void Budget::setLoadThreadCount(int threads) {i_load_threads = threads;}
+QString Budget::loadFile(QString filename, QString &errors, bool *default_currency_created, bool merge, bool rename_duplicate_accounts, bool rename_duplicate_categories, bool rename_duplicate_securities, bool ignore_duplicate_transactions, bool progressive) {
+
+	if(merge) {
+		finishLoading();
+		finishSaving();
+		//merged transactions are not recorded in the journal
+		stopJournal();
+	}
 
 	QFile file(filename);
 	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -862,17 +1617,329 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 		return QString();
 	}
 
-	QXmlStreamReader xml(&file);
+	if(file.peek(4) == BINARY_SNAPSHOT_MAGIC) {
+		file.close();
+		return loadBinary(filename, errors, default_currency_created, merge, rename_duplicate_accounts, rename_duplicate_categories, rename_duplicate_securities, ignore_duplicate_transactions);
+	}
+
+	//large files are read into memory, and the transactions at the end of the document parsed in parallel (or in the background, for progressive loading)
+	TransactionChunks *chunks = NULL;
+	QXmlStreamReader xml;
+	int threads = loadThreadCount();
+	if(progressive && (merge || QFileInfo(filename + JOURNAL_FILE_SUFFIX).size() > 0)) progressive = false;
+	if((threads > 1 || progressive) && file.size() >= PARALLEL_LOAD_MIN_FILE_SIZE) {
+		chunks = new TransactionChunks();
+		chunks->threads = threads;
+		chunks->progressive = progressive;
+		chunks->data = file.readAll();
+		if(split_transaction_chunks(*chunks)) {
+			xml.addData(chunks->data.left(chunks->tail_begin));
+			xml.addData(chunks->data.mid(chunks->tail_end));
+		} else {
+			xml.addData(chunks->data);
+			delete chunks;
+			chunks = NULL;
+		}
+	} else {
+		xml.setDevice(&file);
+	}
+	QString error = loadXml(&xml, errors, default_currency_created, merge, rename_duplicate_accounts, rename_duplicate_categories, rename_duplicate_securities, ignore_duplicate_transactions, NULL, chunks);
+	if(chunks && chunks->progressive && error.isNull()) {
+		pending_transactions = chunks;
+		chunks->pool = new QThreadPool();
+		chunks->next_chunk = chunks->chunks.count() - 1;
+		start_transaction_chunks(this, chunks, chunks->pool, true);
+	} else if(chunks) {
+		delete chunks;
+	}
+	file.close();
+	if(!merge && error.isNull() && loadJournal(filename, errors)) startJournal(filename);
+	return error;
+}
+bool Budget::isLoading() const {return pending_transactions != NULL;}
+int Budget::loadingProgress() const {
+	if(!pending_transactions) return 100;
+	return (pending_transactions->chunks.count() - 1 - pending_transactions->next_chunk) * 100 / pending_transactions->chunks.count();
+}
+bool Budget::loadPendingTransactions(QString &errors, bool wait) {
+	errors = QString();
+	if(!pending_transactions) {
+		errors = s_load_errors;
+		s_load_errors = QString();
+		return true;
+	}
+	TransactionChunks *chunks = pending_transactions;
+	if(wait) chunks->pool->waitForDone();
+	bool registered = false;
+	while(chunks->next_chunk >= 0 && chunks->chunks.at(chunks->next_chunk).finished.loadAcquire()) {
+		TransactionChunk &chunk = chunks->chunks[chunks->next_chunk];
+		for(int i = 0; i < chunk.elements.count(); i++) registerLoadedTransaction(chunk.elements[i], chunks->state);
+		chunk.elements.clear();
+		if(chunk.has_error) {
+			//unlike sequential loading, the transactions in the other chunks are kept
+			if(!s_load_errors.isEmpty()) s_load_errors += '\n';
+			s_load_errors += tr("XML parse error: \"%1\" at line %2, col %3").arg(chunk.error_string).arg(transaction_chunk_error_line(chunks, chunk)).arg(chunk.error_column);
+		}
+		chunks->next_chunk--;
+		registered = true;
+	}
+	if(registered) {
+		if(chunks->next_chunk < 0 && chunks->state.set_ids) {
+			setMissingIds();
+			stopJournal();
+		}
+		sortTransactionLists();
+		invalidateTransactionIdIndex();
+		invalidateAccountTransactionsIndex();
+		invalidateBudgetMonthAggregates();
+		invalidateTransactionsDuplicateIndex();
+		invalidateTransactionsTextIndex();
+	}
+	if(chunks->next_chunk >= 0) return false;
+	delete chunks->pool;
+	incomesAccounts_id.clear();
+	expensesAccounts_id.clear();
+	assetsAccounts_id.clear();
+	securities_id.clear();
+	if(chunks->state.transaction_errors > 0) {
+		if(!s_load_errors.isEmpty()) s_load_errors += '\n';
+		s_load_errors += tr("Unable to load %n transaction(s).", "", chunks->state.transaction_errors);
+	}
+	delete chunks;
+	pending_transactions = NULL;
+	errors = s_load_errors;
+	s_load_errors = QString();
+	return true;
+}
+void Budget::finishLoading() {
+	//errors are kept until the next call of loadPendingTransactions()
+	if(!pending_transactions) return;
+	QString errors;
+	loadPendingTransactions(errors, true);
+	s_load_errors = errors;
+}
+void Budget::cancelLoading() {
+	if(!pending_transactions) return;
+	TransactionChunks *chunks = pending_transactions;
+	chunks->pool->clear();
+	chunks->pool->waitForDone();
+	delete chunks->pool;
+	for(int i = 0; i <= chunks->next_chunk; i++) {
+		const QVector<LoadedTransactionElement> &elements = chunks->chunks.at(i).elements;
+		for(int i2 = 0; i2 < elements.count(); i2++) delete_loaded_transaction_element(elements.at(i2));
+	}
+	delete chunks;
+	pending_transactions = NULL;
+	s_load_errors = QString();
+	incomesAccounts_id.clear();
+	expensesAccounts_id.clear();
+	assetsAccounts_id.clear();
+	securities_id.clear();
+}
+bool Budget::inParseThread() const {
+	//transactions are constructed in other threads while loading, before they are added to the budget
+	return QThread::currentThread() != o_thread;
+}
+bool Budget::loadJournal(QString filename, QString &errors, bool recovery) {
+
+	QFile file(filename + JOURNAL_FILE_SUFFIX);
+	if(!file.exists() || file.size() == 0) return true;
+	if(!file.open(QIODevice::ReadOnly)) return false;
+	QByteArray data("<journal>");
+	data += file.readAll();
+	data += "</journal>";
+	file.close();
+
+	for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) assetsAccounts_id[(*it)->id()] = *it;
+	for(AccountList<IncomesAccount*>::const_iterator it = incomesAccounts.constBegin(); it != incomesAccounts.constEnd(); ++it) incomesAccounts_id[(*it)->id()] = *it;
+	for(AccountList<ExpensesAccount*>::const_iterator it = expensesAccounts.constBegin(); it != expensesAccounts.constEnd(); ++it) expensesAccounts_id[(*it)->id()] = *it;
+	//removing security transactions and trades also removes their quotations, which are unchanged in the file
+	QHash<Security*, QuotationList> quotations;
+	for(SecurityList<Security*>::const_iterator it = securities.constBegin(); it != securities.constEnd(); ++it) {
+		securities_id[(*it)->id()] = *it;
+		quotations[*it] = (*it)->quotations;
+	}
+
+	int transaction_errors = 0;
+	QXmlStreamReader xml(data);
+	if(xml.readNextStartElement()) {
+		while(xml.readNextStartElement()) {
+			if(xml.name() != XML_COMPARE_CONST_CHAR("entry") || xml.attributes().value("saveid") != s_save_id) {
+				xml.skipCurrentElement();
+				continue;
+			}
+			TransactionLoadState state;
+			QStringList s_versions = xml.attributes().value("version").toString().split('.');
+			if(s_versions.size() > 0) state.i_version[0] = s_versions[0].toInt();
+			if(s_versions.size() > 1) state.i_version[1] = s_versions[1].toInt();
+			if(s_versions.size() > 2) state.i_version[2] = s_versions[2].toInt();
+			int entry_revision = xml.attributes().value("revision").toInt();
+			qlonglong entry_last_id = xml.attributes().value("lastid").toLongLong();
+			QSet<qlonglong> ids;
+			QVector<LoadedTransactionElement> elements;
+			while(xml.readNextStartElement()) {
+				if(xml.name() == XML_COMPARE_CONST_CHAR("remove")) {
+					ids.insert(xml.attributes().value("id").toLongLong());
+					xml.skipCurrentElement();
+				} else if(xml.name() == XML_COMPARE_CONST_CHAR("transaction")) {
+					LoadedTransactionElement element;
+					read_transaction_element(this, &xml, element);
+					elements << element;
+				} else {
+					xml.skipCurrentElement();
+				}
+			}
+			if(xml.hasError()) {
+				//the last entry is incomplete if saving was interrupted
+				for(int i = 0; i < elements.count(); i++) delete_loaded_transaction_element(elements.at(i));
+				break;
+			}
+			//the entry contains the current version of each object, which replaces any object with the same id
+			for(int i = 0; i < elements.count(); i++) {
+				const LoadedTransactionElement &element = elements.at(i);
+				if(!element.valid) continue;
+				if(element.trans) {
+					ids.insert(element.trans->id());
+				} else if(element.split) {
+					ids.insert(element.split->id());
+					for(int i2 = 0; i2 < element.split->count(); i2++) ids.insert(element.split->at(i2)->id());
+				} else if(element.trade) {
+					ids.insert(element.trade->id);
+				}
+			}
+			removeJournaledTransactions(ids);
+			//replayed auto-saved changes have not been saved, and are recorded as removed (the current versions of objects that still exist are saved)
+			if(recovery) journal_removed_ids.unite(ids);
+			for(int i = 0; i < elements.count(); i++) {
+				LoadedTransactionElement &element = elements[i];
+				registerLoadedTransaction(element, state);
+				if(!element.valid || !b_transactions_id_index_valid) continue;
+				if(element.trans) {
+					transactions_id_index.insert(element.trans->id(), element.trans);
+				} else if(element.split) {
+					transactions_id_index.insert(element.split->id(), element.split);
+					for(int i2 = 0; i2 < element.split->count(); i2++) transactions_id_index.insert(element.split->at(i2)->id(), element.split->at(i2));
+				}
+			}
+			transaction_errors += state.transaction_errors;
+			if(entry_last_id > last_id) last_id = entry_last_id;
+			if(recovery) {
+				if(entry_revision > i_revision) i_revision = entry_revision;
+			} else if(entry_revision > 0) {
+				i_opened_revision = entry_revision;
+				i_revision = entry_revision + 1;
+			}
+		}
+	}
+
+	if(xml.hasError()) {
+		if(!errors.isEmpty()) errors += '\n';
+		errors += tr("XML parse error in %1: \"%2\" at line %3, col %4").arg(file.fileName()).arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
+	}
+	if(transaction_errors > 0) {
+		if(!errors.isEmpty()) errors += '\n';
+		errors += tr("Unable to load %n transaction(s).", "", transaction_errors);
+	}
+
+	for(QHash<Security*, QuotationList>::const_iterator it = quotations.constBegin(); it != quotations.constEnd(); ++it) it.key()->quotations = it.value();
+	incomesAccounts_id.clear();
+	expensesAccounts_id.clear();
+	assetsAccounts_id.clear();
+	securities_id.clear();
+
+	sortTransactionLists();
+	invalidateTransactionIdIndex();
+	invalidateAccountTransactionsIndex();
+	invalidateBudgetMonthAggregates();
+	invalidateTransactionsDuplicateIndex();
+	invalidateTransactionsTextIndex();
+
+	return !xml.hasError();
+}
+void Budget::removeJournaledTransactions(const QSet<qlonglong> &ids) {
+	for(QSet<qlonglong>::const_iterator it = ids.constBegin(); it != ids.constEnd(); ++it) {
+		if(*it == 0) continue;
+		//the parts of a debt payment share the id of the split
+		Transactions *transs = getTransaction(*it);
+		while(transs && transs->generaltype() != GENERAL_TRANSACTION_TYPE_SCHEDULE) {
+			removeTransactions(transs);
+			transs = getTransaction(*it);
+		}
+	}
+	QList<SecurityTrade*> trades;
+	for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
+		if(ids.contains((*it)->id)) trades << *it;
+	}
+	for(int i = 0; i < trades.count(); i++) removeSecurityTrade(trades.at(i));
+}
+QString Budget::loadBinary(QString filename, QString &errors, bool *default_currency_created, bool merge, bool rename_duplicate_accounts, bool rename_duplicate_categories, bool rename_duplicate_securities, bool ignore_duplicate_transactions) {
+
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly)) {
+		return tr("Couldn't open %1 for reading").arg(filename);
+	}
+	qint64 size = file.size();
+	if(size < BINARY_SNAPSHOT_HEADER_SIZE) return tr("Not a valid Eqonomize! binary file");
+	const uchar *data = file.map(0, size);
+	if(!data) return tr("Couldn't open %1 for reading").arg(filename);
+
+	if(binary_get_u32(data + 4) > BINARY_SNAPSHOT_VERSION) {
+		file.unmap((uchar*) data);
+		return tr("Unsupported Eqonomize! binary file version");
+	}
+
+	BinarySnapshot snapshot;
+	snapshot.record_size = binary_get_u32(data + 12);
+	quint32 string_count = binary_get_u32(data + 24);
+	snapshot.record_count = binary_get_u32(data + 28);
+	qint64 strings_pos = binary_get_i64(data + 32);
+	qint64 records_pos = binary_get_i64(data + 40);
+	qint64 document_pos = binary_get_i64(data + 48);
+	qint64 document_size = binary_get_i64(data + 56);
+	qint64 string_data_pos = strings_pos + ((qint64) string_count + 1) * 4;
+
+	bool valid = snapshot.record_size >= BINARY_SNAPSHOT_RECORD_SIZE && strings_pos >= BINARY_SNAPSHOT_HEADER_SIZE && string_data_pos <= size && records_pos >= string_data_pos && records_pos <= size && (size - records_pos) / snapshot.record_size >= snapshot.record_count && document_pos >= records_pos + (qint64) snapshot.record_count * snapshot.record_size && document_size >= 0 && document_pos <= size && document_size <= size - document_pos;
+	if(valid) {
+		snapshot.strings.reserve(string_count);
+		quint32 string_data_size = records_pos - string_data_pos;
+		quint32 prev_offset = binary_get_u32(data + strings_pos);
+		if(prev_offset > string_data_size) valid = false;
+		for(quint32 i = 1; valid && i <= string_count; i++) {
+			quint32 offset = binary_get_u32(data + strings_pos + i * 4);
+			if(offset < prev_offset || offset > string_data_size) {
+				valid = false;
+				break;
+			}
+			snapshot.strings << QString::fromUtf8((const char*) data + string_data_pos + prev_offset, offset - prev_offset);
+			prev_offset = offset;
+		}
+	}
+	if(!valid) {
+		file.unmap((uchar*) data);
+		return tr("Not a valid Eqonomize! binary file");
+	}
+	snapshot.records = data + records_pos;
+
+	QByteArray document = QByteArray::fromRawData((const char*) data + document_pos, document_size);
+	QXmlStreamReader xml(document);
+	QString error = loadXml(&xml, errors, default_currency_created, merge, rename_duplicate_accounts, rename_duplicate_categories, rename_duplicate_securities, ignore_duplicate_transactions, &snapshot);
+
+	file.unmap((uchar*) data);
+	file.close();
+	return error;
+}
+QString Budget::loadXml(QXmlStreamReader *xml_reader, QString &errors, bool *default_currency_created, bool merge, bool rename_duplicate_accounts, bool rename_duplicate_categories, bool rename_duplicate_securities, bool ignore_duplicate_transactions, const BinarySnapshot *snapshot, TransactionChunks *chunks) {
+
+	QXmlStreamReader &xml = *xml_reader;
 	if(!xml.readNextStartElement()) return tr("Not a valid Eqonomize! file (XML parse error: \"%1\" at line %2, col %3)").arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
 	if(xml.name() != XML_COMPARE_CONST_CHAR("EqonomizeDoc")) return tr("Invalid root element %1 in XML document").arg(xml.name().toString());
 
-	QStringList s_versions = xml.attributes().value("version").toString().split('.');
-	int i_version[] = {0, 0, 0};
-	if(s_versions.size() > 0) i_version[0] = s_versions[0].toInt();
-	if(s_versions.size() > 1) i_version[1] = s_versions[1].toInt();
-	if(s_versions.size() > 2) i_version[2] = s_versions[2].toInt();
+	TransactionLoadState state(merge, ignore_duplicate_transactions);
 
-	qint64 curtime = QDateTime::currentMSecsSinceEpoch() / 1000;
+	QStringList s_versions = xml.attributes().value("version").toString().split('.');
+	if(s_versions.size() > 0) state.i_version[0] = s_versions[0].toInt();
+	if(s_versions.size() > 1) state.i_version[1] = s_versions[1].toInt();
+	if(s_versions.size() > 2) state.i_version[2] = s_versions[2].toInt();
 
 	if(!merge) {
 		tags.clear();
@@ -882,27 +1949,59 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 		i_revision = i_opened_revision;
 		last_id = xml.attributes().value("lastid").toLongLong();
 		if(last_id < 0) last_id = 0;
+		s_save_id = xml.attributes().value("saveid").toString();
 	}
 
 	errors = QString();
-	int category_errors = 0, account_errors = 0, transaction_errors = 0, security_errors = 0;
+	int category_errors = 0, account_errors = 0, security_errors = 0;
 
-	assetsAccounts_id[balancingAccount->id()] = balancingAccount;
+	invalidateTransactionIdIndex();
+	invalidateAccountTransactionsIndex();
+	invalidateBudgetMonthAggregates();
+	invalidateTransactionsDuplicateIndex();
+	invalidateTransactionsTextIndex();
+	invalidateScheduleOccurrences();
+	invalidateBudgetPeriods();
+	invalidateTagIndex();
 
-	QHash<qlonglong, qlonglong> merge_transaction_ids;
-	QList<Transactions*> update_links_list;
+	if(merge && ignore_duplicate_transactions) {
+		state.merge_duplicates_index.reserve(transactions.count() + splitTransactions.count() + scheduledTransactions.count());
+		for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) state.merge_duplicates_index.insert(transaction_duplicate_key(*it), *it);
+		for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) state.merge_duplicates_index.insert(transaction_duplicate_key(*it), *it);
+		for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) state.merge_duplicates_index.insert(transaction_duplicate_key(*it), *it);
+	}
+
+	assetsAccounts_id[balancingAccount->id()] = balancingAccount;
 
 	Currency *cur = NULL, *prev_default_cur = default_currency;
 	if(default_currency_created) *default_currency_created = false;
 
-	bool set_ids = false;
-
 	if(!merge) o_sync->clear();
 
 	i_budget_month = 1;
 
-	while(xml.readNextStartElement()) {
-		if(xml.name() == XML_COMPARE_CONST_CHAR("budget_period")) {
+	int chunk_index = 0, chunk_element_index = 0;
+	bool chunks_parsed = false;
+
+	while(true) {
+		LoadedTransactionElement element;
+		bool is_transaction = false;
+		if(!xml.readNextStartElement()) {
+			//transactions at the end of the document are parsed in parallel, after the elements they depend on have been loaded
+			if(!chunks || chunks->progressive || xml.hasError()) break;
+			if(!chunks_parsed) {
+				parse_transaction_chunks(this, chunks);
+				chunks_parsed = true;
+			}
+			if(!next_loaded_transaction_element(chunks, chunk_index, chunk_element_index, element)) break;
+			is_transaction = true;
+		} else if(xml.name() == XML_COMPARE_CONST_CHAR("transaction")) {
+			read_transaction_element(this, &xml, element);
+			is_transaction = true;
+		}
+		if(is_transaction) {
+			registerLoadedTransaction(element, state);
+		} else if(xml.name() == XML_COMPARE_CONST_CHAR("budget_period")) {
 			if(merge) {
 				xml.skipCurrentElement();
 			} else {
@@ -963,35 +2062,31 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 		} else if(xml.name() == XML_COMPARE_CONST_CHAR("schedule")) {
 			bool valid = true;
 			ScheduledTransaction *strans = new ScheduledTransaction(this, &xml, &valid);
-			if(valid && merge && ignore_duplicate_transactions) {
-				for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
-					if((*it)->date() > strans->date()) break;
-					else if(strans->equals(*it, false)) {delete strans; strans = NULL; break;}
-				}
-			}
+			if(valid && merge && ignore_duplicate_transactions && find_duplicate_transactions(state.merge_duplicates_index, strans)) {delete strans; strans = NULL;}
 			if(valid && strans) {
 				if(merge) {
 					qlonglong old_id = strans->id();
 					strans->setId(getNewId());
-					merge_transaction_ids[old_id] = strans->id();
-					if(strans->linksCount(false) > 0) update_links_list << strans;
+					state.merge_transaction_ids[old_id] = strans->id();
+					if(strans->linksCount(false) > 0) state.update_links_list << strans;
 					strans->setId(getNewId());
 					strans->setFirstRevision(i_revision);
 					strans->setLastRevision(i_revision);
 					old_id = strans->transaction()->id();
 					strans->transaction()->setId(getNewId());
-					merge_transaction_ids[old_id] = strans->transaction()->id();
+					state.merge_transaction_ids[old_id] = strans->transaction()->id();
 					strans->transaction()->setFirstRevision(i_revision);
 					strans->transaction()->setLastRevision(i_revision);
 				} else {
-					if(!set_ids) set_ids = strans->id() == 0;
-					if(!set_ids) set_ids = strans->transaction()->id() == 0;
+					if(!state.set_ids) state.set_ids = strans->id() == 0;
+					if(!state.set_ids) state.set_ids = strans->transaction()->id() == 0;
 				}
-				if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 2)))) && strans->timestamp() > curtime) strans->setTimestamp(strans->timestamp() / 1000000L);
-				if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 4)))) && strans->associatedFile().contains(",")) {
+				if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 2)))) && strans->timestamp() > state.curtime) strans->setTimestamp(strans->timestamp() / 1000000L);
+				if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 4)))) && strans->associatedFile().contains(",")) {
 					strans->setAssociatedFile(QString("\"") + strans->associatedFile() + "\"");
 				}
 				scheduledTransactions.append(strans);
+				if(merge && ignore_duplicate_transactions) state.merge_duplicates_index.insert(transaction_duplicate_key(strans), strans);
 				if(strans->transaction()) {
 					if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
 						((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.append(strans);
@@ -1015,310 +2110,9 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 					}
 				}
 			} else if(!valid) {
-				transaction_errors++;
+				state.transaction_errors++;
 				if(strans) delete strans;
 			}
-		} else if(xml.name() == XML_COMPARE_CONST_CHAR("transaction")) {
-			SplitTransaction *split = NULL;
-			Transaction *trans = NULL;
-#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-			QStringView type = xml.attributes().value("type");
-#else
-			QStringRef type = xml.attributes().value("type");
-#endif
-			bool valid = true;
-			if(type.isEmpty()) {
-				QXmlStreamAttributes attr = xml.attributes();
-				if(attr.hasAttribute("shares") && attr.hasAttribute("security")) {
-					if(attr.hasAttribute("cost")) attr.append("type", "security_buy");
-					else if(attr.hasAttribute("income")) attr.append("type", "security_sell");
-					else if(attr.hasAttribute("from")) attr.append("type", "security_buy");
-					else if(attr.hasAttribute("to")) attr.append("type", "security_sell");
-				} else if(attr.hasAttribute("cost") || (attr.hasAttribute("category") && attr.hasAttribute("from"))) {
-					attr.append("type", "expense");
-				} else if(attr.hasAttribute("income") || (attr.hasAttribute("category") && attr.hasAttribute("to"))) {
-					attr.append("type", "income");
-				} else if(attr.hasAttribute("amount") || attr.hasAttribute("withdrawal")) {
-					attr.append("type", "transfer");
-				} else if(attr.hasAttribute("from") && attr.hasAttribute("to")) {
-					qlonglong id_from = attr.value("from").toLongLong();
-					qlonglong id_to = attr.value("to").toLongLong();
-					if(expensesAccounts_id.contains(id_to) || expensesAccounts_id.contains(id_from)) attr.append("type", "expense");
-					else if(incomesAccounts_id.contains(id_from) || incomesAccounts_id.contains(id_to)) attr.append("type", "income");
-					else if(assetsAccounts_id.contains(id_from) && assetsAccounts_id.contains(id_to)) attr.append("type", "transfer");
-				}
-				type = attr.value("type");
-			}
-			if(type == XML_COMPARE_CONST_CHAR("expense") || type == XML_COMPARE_CONST_CHAR("refund")) {
-				Expense *expense = new Expense(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(TransactionList<Expense*>::const_iterator it = expenses.constBegin(); it != expenses.constEnd(); ++it) {
-						if((*it)->date() > expense->date()) break;
-						else if(expense->equals(*it, false)) {delete expense; expense = NULL; break;}
-					}
-				}
-				if(valid && expense) {
-					trans = expense;
-					expenses.append(expense);
-				} else if(!valid) {
-					transaction_errors++;
-					if(expense) delete expense;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("income") || type == XML_COMPARE_CONST_CHAR("repayment")) {
-				Income *income = new Income(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					if(income->security()) {
-						for(SecurityTransactionList<Income*>::const_iterator it = income->security()->dividends.constBegin(); it != income->security()->dividends.constEnd(); ++it) {
-							if((*it)->date() > income->date()) break;
-							else if(income->equals(*it, false)) {delete income; income = NULL; break;}
-						}
-					} else {
-						for(TransactionList<Income*>::const_iterator it = incomes.constBegin(); it != incomes.constEnd(); ++it) {
-							if((*it)->date() > income->date()) break;
-							else if(income->equals(*it, false)) {delete income; income = NULL; break;}
-						}
-					}
-				}
-				if(valid && income) {
-					trans = income;
-					incomes.append(income);
-					if(income->security()) income->security()->dividends.append(income);
-				} else if(!valid) {
-					transaction_errors++;
-					if(income) delete income;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("dividend")) {
-				Income *income = new Income(this, &xml, &valid);
-				if(!income->security()) valid = false;
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(SecurityTransactionList<Income*>::const_iterator it = income->security()->dividends.constBegin(); it != income->security()->dividends.constEnd(); ++it) {
-						if((*it)->date() > income->date()) break;
-						else if(income->equals(*it, false)) {delete income; income = NULL; break;}
-					}
-				}
-				if(valid && income) {
-					trans = income;
-					incomes.append(income);
-					income->security()->dividends.append(income);
-				} else if(!valid) {
-					transaction_errors++;
-					if(income) delete income;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("reinvested_dividend")) {
-				ReinvestedDividend *rediv = new ReinvestedDividend(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = rediv->security()->reinvestedDividends.constBegin(); it != rediv->security()->reinvestedDividends.constEnd(); ++it) {
-						if((*it)->date() > rediv->date()) break;
-						else if(rediv->equals(*it, false)) {delete rediv; rediv = NULL; break;}
-					}
-				}
-				if(valid && rediv) {
-					trans = rediv;
-					incomes.append(rediv);
-					rediv->security()->reinvestedDividends.append(rediv);
-				} else if(!valid) {
-					transaction_errors++;
-					if(rediv) delete rediv;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("security_trade")) {
-				SecurityTrade *ts = new SecurityTrade(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
-						if((*it)->date > ts->date) break;
-						else if(ts->date == (*it)->date && ts->from_shares == (*it)->from_shares && ts->to_shares == (*it)->to_shares && ts->from_security == (*it)->from_security && ts->to_security == (*it)->to_security) {delete ts; ts = NULL; break;}
-					}
-				}
-				if(valid && ts) {
-					if(merge) {
-						ts->id = getNewId();
-						ts->first_revision = i_revision;
-						ts->last_revision = i_revision;
-					} else {
-						if(!set_ids) set_ids = ts->id == 0;
-					}
-					if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 2)))) && ts->timestamp > curtime) ts->timestamp = ts->timestamp / 1000000L;
-					securityTrades.append(ts);
-					ts->from_security->tradedShares.append(ts);
-					ts->to_security->tradedShares.append(ts);
-				} else if(!valid) {
-					transaction_errors++;
-					if(ts) delete ts;
-				}
-				xml.skipCurrentElement();
-			} else if(type == XML_COMPARE_CONST_CHAR("transfer")) {
-				Transfer *transfer = new Transfer(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(TransactionList<Transfer*>::const_iterator it = transfers.constBegin(); it != transfers.constEnd(); ++it) {
-						if((*it)->date() > transfer->date()) break;
-						else if(transfer->equals(*it, false)) {delete transfer; transfer = NULL; break;}
-					}
-				}
-				if(valid && transfer) {
-					trans = transfer;
-					transfers.append(transfer);
-				} else if(!valid) {
-					transaction_errors++;
-					if(transfer) delete transfer;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("balancing")) {
-				Transfer *transfer = new Balancing(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(TransactionList<Transfer*>::const_iterator it = transfers.constBegin(); it != transfers.constEnd(); ++it) {
-						if((*it)->date() > transfer->date()) break;
-						else if(transfer->equals(*it, false)) {delete transfer; transfer = NULL; break;}
-					}
-				}
-				if(valid && transfer) {
-					trans = transfer;
-					transfers.append(transfer);
-				} else if(!valid) {
-					transaction_errors++;
-					if(transfer) delete transfer;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("security_buy")) {
-				SecurityBuy *sectrans = new SecurityBuy(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = sectrans->security()->transactions.constBegin(); it != sectrans->security()->transactions.constEnd(); ++it) {
-						if((*it)->date() > sectrans->date()) break;
-						else if(sectrans->equals(*it, false)) {delete sectrans; sectrans = NULL; break;}
-					}
-				}
-				if(valid && sectrans) {
-					trans = sectrans;
-					securityTransactions.append(sectrans);
-					sectrans->security()->transactions.append(sectrans);
-				} else if(!valid) {
-					transaction_errors++;
-					if(sectrans) delete sectrans;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("security_sell")) {
-				SecuritySell *sectrans = new SecuritySell(this, &xml, &valid);
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = sectrans->security()->transactions.constBegin(); it != sectrans->security()->transactions.constEnd(); ++it) {
-						if((*it)->date() > sectrans->date()) break;
-						else if(sectrans->equals(*it, false)) {delete sectrans; sectrans = NULL; break;}
-					}
-				}
-				if(valid && sectrans) {
-					trans = sectrans;
-					securityTransactions.append(sectrans);
-					sectrans->security()->transactions.append(sectrans);
-				} else if(!valid) {
-					transaction_errors++;
-					if(sectrans) delete sectrans;
-				}
-			} else if(type == XML_COMPARE_CONST_CHAR("multiitem") || type == XML_COMPARE_CONST_CHAR("split")) {
-				split = new MultiItemTransaction(this, &xml, &valid);
-			} else if(type == XML_COMPARE_CONST_CHAR("multiaccount")) {
-				split = new MultiAccountTransaction(this, &xml, &valid);
-			} else if(type == XML_COMPARE_CONST_CHAR("debtpayment")) {
-				split = new DebtPayment(this, &xml, &valid);
-			} else {
-				xml.skipCurrentElement();
-				transaction_errors++;
-			}
-			if(split) {
-				if(valid && merge && ignore_duplicate_transactions) {
-					for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
-						if((*it)->date() > split->date()) break;
-						else if(split->equals(*it, false)) {delete split; split = NULL; break;}
-					}
-				}
-				if(!valid) {
-					transaction_errors++;
-					if(split) delete split;
-					split = NULL;
-				} else if(split) {
-					if(merge) {
-						qlonglong old_id = split->id();
-						split->setId(getNewId());
-						merge_transaction_ids[old_id] = split->id();
-						if(split->linksCount(false) > 0) update_links_list << split;
-						split->setFirstRevision(i_revision);
-						split->setLastRevision(i_revision);
-					} else {
-						if(!set_ids) set_ids = split->id() == 0;
-					}
-					if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 2)))) && split->timestamp() > curtime) split->setTimestamp(split->timestamp() / 1000000L);
-					if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 4)))) && split->associatedFile().contains(",")) {
-						split->setAssociatedFile(QString("\"") + split->associatedFile() + "\"");
-					}
-					splitTransactions.append(split);
-					for(int i = 0; i < split->tagsCount(false); i++) {
-						if(!tags.contains(split->getTag(i))) tags << split->getTag(i);
-					}
-					int c = split->count();
-					for(int i = 0; i < c; i++) {
-						trans = split->at(i);
-						if(merge) {
-							qlonglong old_id = trans->id();
-							trans->setId(getNewId());
-							merge_transaction_ids[old_id] = trans->id();
-							if(trans->linksCount(false) > 0) update_links_list << trans;
-							trans->setFirstRevision(i_revision);
-							trans->setLastRevision(i_revision);
-						} else {
-							if(!set_ids && split->type() != SPLIT_TRANSACTION_TYPE_LOAN) set_ids = trans->id() == 0;
-						}
-						switch(trans->type()) {
-							case TRANSACTION_TYPE_TRANSFER: {
-								transfers.append((Transfer*) trans);
-								break;
-							}
-							case TRANSACTION_TYPE_INCOME: {
-								incomes.append((Income*) trans);
-								if(((Income*) trans)->security()) ((Income*) trans)->security()->dividends.append((Income*) trans);
-								break;
-							}
-							case TRANSACTION_TYPE_EXPENSE: {
-								expenses.append((Expense*) trans);
-								break;
-							}
-							case TRANSACTION_TYPE_SECURITY_BUY: {
-								securityTransactions.append((SecurityBuy*) trans);
-								((SecurityBuy*) trans)->security()->transactions.append((SecurityBuy*) trans);
-								break;
-							}
-							case TRANSACTION_TYPE_SECURITY_SELL: {
-								securityTransactions.append((SecuritySell*) trans);
-								((SecuritySell*) trans)->security()->transactions.append((SecuritySell*) trans);
-								break;
-							}
-							default: {}
-						}
-						if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 4)))) && trans->associatedFile().contains(",")) {
-							trans->setAssociatedFile(QString("\"") + trans->associatedFile() + "\"");
-						}
-						transactions.append(trans);
-						for(int i2 = 0; i2 < trans->tagsCount(false); i2++) {
-							if(!tags.contains(trans->getTag(i2))) {
-								tags << trans->getTag(i2);
-							} else if(split->hasTag(trans->getTag(i2), false)) {
-								trans->removeTag(trans->getTag(i2));
-							}
-						}
-					}
-				}
-			} else if(trans) {
-				if(merge) {
-					qlonglong old_id = trans->id();
-					trans->setId(getNewId());
-					merge_transaction_ids[old_id] = trans->id();
-					if(trans->linksCount(false) > 0) update_links_list << trans;
-					trans->setFirstRevision(i_revision);
-					trans->setLastRevision(i_revision);
-				} else {
-					if(!set_ids) set_ids = trans->id() == 0;
-				}
-				if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 2)))) && trans->timestamp() > curtime) trans->setTimestamp(trans->timestamp() / 1000000L);
-				if((i_version[0] < 1 || (i_version[0] == 1 && (i_version[1] < 3 || (i_version[1] == 3 && i_version[2] <= 4)))) && trans->associatedFile().contains(",")) {
-					trans->setAssociatedFile(QString("\"") + trans->associatedFile() + "\"");
-				}
-				transactions.append(trans);
-				for(int i2 = 0; i2 < trans->tagsCount(false); i2++) {
-					if(!tags.contains(trans->getTag(i2))) tags << trans->getTag(i2);
-				}
-			}
 		} else if(xml.name() == XML_COMPARE_CONST_CHAR("category")) {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 			QStringView type = xml.attributes().value("type");
@@ -1356,6 +2150,7 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 						expensesAccounts.append(account);
 						accounts.append(account);
 					}
+					invalidateAccountNameIndex();
 				} else {
 					category_errors++;
 					delete account;
@@ -1390,6 +2185,7 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 						incomesAccounts.append(account);
 						accounts.append(account);
 					}
+					invalidateAccountNameIndex();
 				} else {
 					category_errors++;
 					delete account;
@@ -1425,6 +2221,7 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 					}
 					assetsAccounts.append(account);
 					accounts.append(account);
+					invalidateAccountNameIndex();
 				}
 			} else {
 				account_errors++;
@@ -1448,6 +2245,7 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 						security->setLastRevision(i_revision);
 					}
 					securities.append(security);
+					invalidateSecurityNameIndex();
 					i_quotation_decimals = security->quotationDecimals();
 					i_share_decimals = security->decimals();
 				}
@@ -1462,6 +2260,40 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 		}
 	}
 
+	if(snapshot) {
+		for(quint32 i = 0; i < snapshot->record_count; i++) {
+			bool valid = true;
+			Transaction *trans = read_binary_record(this, snapshot, snapshot->records + (qint64) i * snapshot->record_size, &valid);
+			if(valid && merge && ignore_duplicate_transactions && find_duplicate_transactions(state.merge_duplicates_index, trans)) {delete trans; trans = NULL;}
+			if(!valid) {
+				state.transaction_errors++;
+				if(trans) delete trans;
+			} else if(trans) {
+				if(merge) {
+					qlonglong old_id = trans->id();
+					trans->setId(getNewId());
+					state.merge_transaction_ids[old_id] = trans->id();
+					if(trans->linksCount(false) > 0) state.update_links_list << trans;
+					trans->setFirstRevision(i_revision);
+					trans->setLastRevision(i_revision);
+				} else {
+					if(!state.set_ids) state.set_ids = trans->id() == 0;
+				}
+				switch(trans->type()) {
+					case TRANSACTION_TYPE_TRANSFER: {transfers.append((Transfer*) trans); break;}
+					case TRANSACTION_TYPE_INCOME: {incomes.append((Income*) trans); break;}
+					case TRANSACTION_TYPE_EXPENSE: {expenses.append((Expense*) trans); break;}
+					default: {}
+				}
+				transactions.append(trans);
+				if(merge && ignore_duplicate_transactions) state.merge_duplicates_index.insert(transaction_duplicate_key(trans), trans);
+				for(int i2 = 0; i2 < trans->tagsCount(false); i2++) {
+					if(!tags.contains(trans->getTag(i2))) tags << trans->getTag(i2);
+				}
+			}
+		}
+	}
+
 	if(!cur && !merge) {
 		bool b = resetDefaultCurrency();
 		cur = defaultCurrency();
@@ -1473,63 +2305,35 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 	if (xml.hasError()) {
 		if(!errors.isEmpty()) errors += '\n';
 		errors += tr("XML parse error: \"%1\" at line %2, col %3").arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
+	} else if(chunks && chunks->has_error) {
+		if(!errors.isEmpty()) errors += '\n';
+		errors += tr("XML parse error: \"%1\" at line %2, col %3").arg(chunks->error_string).arg(chunks->error_line).arg(chunks->error_column);
 	}
 
-	incomesAccounts_id.clear();
-	expensesAccounts_id.clear();
-	assetsAccounts_id.clear();
-	securities_id.clear();
+	if(chunks && chunks->progressive && xml.hasError()) chunks->progressive = false;
+	if(chunks && chunks->progressive) {
+		//the id maps are needed until the remaining transactions have been parsed
+		chunks->state = state;
+		chunks->state.set_ids = false;
+		chunks->state.transaction_errors = 0;
+	} else {
+		incomesAccounts_id.clear();
+		expensesAccounts_id.clear();
+		assetsAccounts_id.clear();
+		securities_id.clear();
+	}
 
-	if(set_ids) {
-		std::sort(transactions.begin(), transactions.end(), transaction_list_less_than_stamp);
-		std::sort(scheduledTransactions.begin(), scheduledTransactions.end(), schedule_list_less_than_stamp);
-		std::sort(splitTransactions.begin(), splitTransactions.end(), split_list_less_than_stamp);
-		std::sort(securityTrades.begin(), securityTrades.end(), trade_list_less_than_stamp);
-		TransactionList<Transaction*>::const_iterator it1 = transactions.constBegin();
-		ScheduledTransactionList<ScheduledTransaction*>::const_iterator it2 = scheduledTransactions.constBegin();
-		SplitTransactionList<SplitTransaction*>::const_iterator it3 = splitTransactions.constBegin();
-		SecurityTradeList<SecurityTrade*>::const_iterator it4 = securityTrades.constBegin();
-		int it_i = 0;
-		while(true) {
-			while((it_i == 0 || it_i == 1) && it1 != transactions.constEnd() && ((*it1)->id() != 0 || ((*it1)->parentSplit() && (*it1)->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_LOAN))) ++it1;
-			while((it_i == 0 || it_i == 2) && it2 != scheduledTransactions.constEnd() && (*it2)->id() != 0) ++it2;
-			while((it_i == 0 || it_i == 3) && it3 != splitTransactions.constEnd() && (*it3)->id() != 0) ++it3;
-			while((it_i == 0 || it_i == 4) && it4 != securityTrades.constEnd() && (*it4)->id != 0) ++it4;
-			it_i = 4;
-			if(it1 != transactions.constEnd() && (it2 == scheduledTransactions.constEnd() || transactions_less_than_stamp(*it1, *it2))) {
-				if(it3 == splitTransactions.constEnd() || transactions_less_than_stamp(*it1, *it3)) {
-					if(it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it1, *it4)) it_i = 1;
-				} else if(it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it3, *it4)) it_i = 3;
-			} else if(it2 != scheduledTransactions.constEnd() && (it3 == splitTransactions.constEnd() || transactions_less_than_stamp(*it2, *it3))) {
-				if(it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it2, *it4)) it_i = 2;
-			} else if(it3 != splitTransactions.constEnd() && (it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it3, *it4))) it_i = 3;
-			else if(it4 == securityTrades.constEnd()) break;
-			last_id++;
-			if(it_i == 1) {
-				(*it1)->setId(last_id);
-				++it1;
-			} else if(it_i == 2) {
-				(*it2)->setId(last_id);
-				if((*it2)->transaction()->id() == 0) {
-					last_id++;
-					(*it2)->transaction()->setId(last_id);
-				}
-				++it2;
-			} else if(it_i == 3) {
-				(*it3)->setId(last_id);
-				++it3;
-			} else if(it_i == 4) {
-				(*it4)->id = last_id;
-				++it4;
-			}
-		}
+	if(state.set_ids) {
+		setMissingIds();
+		//journal entries would refer to ids that are not in the file
+		s_save_id = QString();
 	}
 
-	for(int i = 0; i < update_links_list.count(); i++) {
-		Transactions *trans = update_links_list.at(i);
+	for(int i = 0; i < state.update_links_list.count(); i++) {
+		Transactions *trans = state.update_links_list.at(i);
 		int n = trans->linksCount(false);
 		for(int i2 = 0; i2 < n; i2++) {
-			qlonglong new_id = merge_transaction_ids[trans->getLinkId(0, false)];
+			qlonglong new_id = state.merge_transaction_ids[trans->getLinkId(0, false)];
 			trans->removeLink(0);
 			trans->addLinkId(new_id);
 		}
@@ -1537,32 +2341,13 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 
 	i_revision++;
 
-	expenses.sort();
-	incomes.sort();
-	transfers.sort();
-	securityTransactions.sort();
-	securityTrades.sort();
-	for(SecurityList<Security*>::const_iterator it = securities.constBegin(); it != securities.constEnd(); ++it) {
-		Security *security = *it;
-		security->dividends.sort();
-		security->transactions.sort();
-		security->scheduledTransactions.sort();
-		security->scheduledDividends.sort();
-		security->scheduledReinvestedDividends.sort();
-		security->reinvestedDividends.sort();
-		security->tradedShares.sort();
-	}
-	transactions.sort();
-	scheduledTransactions.sort();
-	splitTransactions.sort();
+	sortTransactionLists();
 	expensesAccounts.sort();
 	incomesAccounts.sort();
 	assetsAccounts.sort();
 	accounts.sort();
 	securities.sort();
 
-	tags.sort(Qt::CaseInsensitive);
-
 	if(account_errors > 0) {
 		if(!errors.isEmpty()) errors += '\n';
 		errors += tr("Unable to load %n account(s).", "", account_errors);
@@ -1575,14 +2360,234 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 		if(!errors.isEmpty()) errors += '\n';
 		errors += tr("Unable to load %n security/securities.", "Financial security (e.g. stock, mutual fund)", security_errors);
 	}
-	if(transaction_errors > 0) {
+	if(state.transaction_errors > 0) {
 		if(!errors.isEmpty()) errors += '\n';
-		errors += tr("Unable to load %n transaction(s).", "", transaction_errors);
+		errors += tr("Unable to load %n transaction(s).", "", state.transaction_errors);
+	}
+
+	resetDefaultCurrencyChanged();
+	return QString();
+}
+void Budget::setMissingIds() {
+	std::sort(transactions.begin(), transactions.end(), transaction_list_less_than_stamp);
+	std::sort(scheduledTransactions.begin(), scheduledTransactions.end(), schedule_list_less_than_stamp);
+	std::sort(splitTransactions.begin(), splitTransactions.end(), split_list_less_than_stamp);
+	std::sort(securityTrades.begin(), securityTrades.end(), trade_list_less_than_stamp);
+	TransactionList<Transaction*>::const_iterator it1 = transactions.constBegin();
+	ScheduledTransactionList<ScheduledTransaction*>::const_iterator it2 = scheduledTransactions.constBegin();
+	SplitTransactionList<SplitTransaction*>::const_iterator it3 = splitTransactions.constBegin();
+	SecurityTradeList<SecurityTrade*>::const_iterator it4 = securityTrades.constBegin();
+	int it_i = 0;
+	while(true) {
+		while((it_i == 0 || it_i == 1) && it1 != transactions.constEnd() && ((*it1)->id() != 0 || ((*it1)->parentSplit() && (*it1)->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_LOAN))) ++it1;
+		while((it_i == 0 || it_i == 2) && it2 != scheduledTransactions.constEnd() && (*it2)->id() != 0) ++it2;
+		while((it_i == 0 || it_i == 3) && it3 != splitTransactions.constEnd() && (*it3)->id() != 0) ++it3;
+		while((it_i == 0 || it_i == 4) && it4 != securityTrades.constEnd() && (*it4)->id != 0) ++it4;
+		it_i = 4;
+		if(it1 != transactions.constEnd() && (it2 == scheduledTransactions.constEnd() || transactions_less_than_stamp(*it1, *it2))) {
+			if(it3 == splitTransactions.constEnd() || transactions_less_than_stamp(*it1, *it3)) {
+				if(it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it1, *it4)) it_i = 1;
+			} else if(it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it3, *it4)) it_i = 3;
+		} else if(it2 != scheduledTransactions.constEnd() && (it3 == splitTransactions.constEnd() || transactions_less_than_stamp(*it2, *it3))) {
+			if(it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it2, *it4)) it_i = 2;
+		} else if(it3 != splitTransactions.constEnd() && (it4 == securityTrades.constEnd() || transactions_less_than_trade_stamp(*it3, *it4))) it_i = 3;
+		else if(it4 == securityTrades.constEnd()) break;
+		last_id++;
+		if(it_i == 1) {
+			(*it1)->setId(last_id);
+			++it1;
+		} else if(it_i == 2) {
+			(*it2)->setId(last_id);
+			if((*it2)->transaction()->id() == 0) {
+				last_id++;
+				(*it2)->transaction()->setId(last_id);
+			}
+			++it2;
+		} else if(it_i == 3) {
+			(*it3)->setId(last_id);
+			++it3;
+		} else if(it_i == 4) {
+			(*it4)->id = last_id;
+			++it4;
+		}
+	}
+}
+void Budget::sortTransactionLists() {
+	expenses.sort();
+	incomes.sort();
+	transfers.sort();
+	securityTransactions.sort();
+	securityTrades.sort();
+	for(SecurityList<Security*>::const_iterator it = securities.constBegin(); it != securities.constEnd(); ++it) {
+		Security *security = *it;
+		security->dividends.sort();
+		security->transactions.sort();
+		security->scheduledTransactions.sort();
+		security->scheduledDividends.sort();
+		security->scheduledReinvestedDividends.sort();
+		security->reinvestedDividends.sort();
+		security->tradedShares.sort();
+		security->sharesModified();
+	}
+	transactions.sort();
+	scheduledTransactions.sort();
+	splitTransactions.sort();
+	tags.sort(Qt::CaseInsensitive);
+	invalidateTagIndex();
+}
+void Budget::registerLoadedTransaction(LoadedTransactionElement &element, TransactionLoadState &state) {
+	SplitTransaction *split = element.split;
+	Transaction *trans = element.trans;
+	SecurityTrade *ts = element.trade;
+	bool valid = element.valid;
+	if(ts) {
+		if(valid && state.merge && state.ignore_duplicate_transactions) {
+			for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
+				if((*it)->date > ts->date) break;
+				else if(ts->date == (*it)->date && ts->from_shares == (*it)->from_shares && ts->to_shares == (*it)->to_shares && ts->from_security == (*it)->from_security && ts->to_security == (*it)->to_security) {delete ts; ts = NULL; break;}
+			}
+		}
+		if(valid && ts) {
+			if(state.merge) {
+				ts->id = getNewId();
+				ts->first_revision = i_revision;
+				ts->last_revision = i_revision;
+			} else {
+				if(!state.set_ids) state.set_ids = ts->id == 0;
+			}
+			if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 2)))) && ts->timestamp > state.curtime) ts->timestamp = ts->timestamp / 1000000L;
+			securityTrades.append(ts);
+			ts->from_security->tradedShares.append(ts);
+			ts->to_security->tradedShares.append(ts);
+		} else if(!valid) {
+			state.transaction_errors++;
+			if(ts) delete ts;
+		}
+	} else if(split) {
+		if(valid && state.merge && state.ignore_duplicate_transactions && find_duplicate_transactions(state.merge_duplicates_index, split)) {delete split; split = NULL;}
+		if(!valid) {
+			state.transaction_errors++;
+			if(split) delete split;
+			split = NULL;
+		} else if(split) {
+			if(state.merge) {
+				qlonglong old_id = split->id();
+				split->setId(getNewId());
+				state.merge_transaction_ids[old_id] = split->id();
+				if(split->linksCount(false) > 0) state.update_links_list << split;
+				split->setFirstRevision(i_revision);
+				split->setLastRevision(i_revision);
+			} else {
+				if(!state.set_ids) state.set_ids = split->id() == 0;
+			}
+			if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 2)))) && split->timestamp() > state.curtime) split->setTimestamp(split->timestamp() / 1000000L);
+			if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 4)))) && split->associatedFile().contains(",")) {
+				split->setAssociatedFile(QString("\"") + split->associatedFile() + "\"");
+			}
+			splitTransactions.append(split);
+			if(state.merge && state.ignore_duplicate_transactions) state.merge_duplicates_index.insert(transaction_duplicate_key(split), split);
+			for(int i = 0; i < split->tagsCount(false); i++) {
+				if(!tags.contains(split->getTag(i))) tags << split->getTag(i);
+			}
+			int c = split->count();
+			for(int i = 0; i < c; i++) {
+				trans = split->at(i);
+				if(state.merge) {
+					qlonglong old_id = trans->id();
+					trans->setId(getNewId());
+					state.merge_transaction_ids[old_id] = trans->id();
+					if(trans->linksCount(false) > 0) state.update_links_list << trans;
+					trans->setFirstRevision(i_revision);
+					trans->setLastRevision(i_revision);
+				} else {
+					if(!state.set_ids && split->type() != SPLIT_TRANSACTION_TYPE_LOAN) state.set_ids = trans->id() == 0;
+				}
+				switch(trans->type()) {
+					case TRANSACTION_TYPE_TRANSFER: {
+						transfers.append((Transfer*) trans);
+						break;
+					}
+					case TRANSACTION_TYPE_INCOME: {
+						incomes.append((Income*) trans);
+						if(((Income*) trans)->security()) ((Income*) trans)->security()->dividends.append((Income*) trans);
+						break;
+					}
+					case TRANSACTION_TYPE_EXPENSE: {
+						expenses.append((Expense*) trans);
+						break;
+					}
+					case TRANSACTION_TYPE_SECURITY_BUY: {
+						securityTransactions.append((SecurityBuy*) trans);
+						((SecurityBuy*) trans)->security()->transactions.append((SecurityBuy*) trans);
+						break;
+					}
+					case TRANSACTION_TYPE_SECURITY_SELL: {
+						securityTransactions.append((SecuritySell*) trans);
+						((SecuritySell*) trans)->security()->transactions.append((SecuritySell*) trans);
+						break;
+					}
+					default: {}
+				}
+				if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 4)))) && trans->associatedFile().contains(",")) {
+					trans->setAssociatedFile(QString("\"") + trans->associatedFile() + "\"");
+				}
+				transactions.append(trans);
+				if(state.merge && state.ignore_duplicate_transactions) state.merge_duplicates_index.insert(transaction_duplicate_key(trans), trans);
+				for(int i2 = 0; i2 < trans->tagsCount(false); i2++) {
+					if(!tags.contains(trans->getTag(i2))) {
+						tags << trans->getTag(i2);
+					} else if(split->hasTag(trans->getTag(i2), false)) {
+						trans->removeTag(trans->getTag(i2));
+					}
+				}
+			}
+		}
+	} else if(trans) {
+		if(valid && state.merge && state.ignore_duplicate_transactions && find_duplicate_transactions(state.merge_duplicates_index, trans)) {delete trans; trans = NULL;}
+		if(!valid) {
+			state.transaction_errors++;
+			if(trans) delete trans;
+		} else if(trans) {
+			switch(trans->type()) {
+				case TRANSACTION_TYPE_EXPENSE: {expenses.append((Expense*) trans); break;}
+				case TRANSACTION_TYPE_INCOME: {
+					incomes.append((Income*) trans);
+					if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((ReinvestedDividend*) trans)->security()->reinvestedDividends.append((ReinvestedDividend*) trans);
+					else if(((Income*) trans)->security()) ((Income*) trans)->security()->dividends.append((Income*) trans);
+					break;
+				}
+				case TRANSACTION_TYPE_TRANSFER: {transfers.append((Transfer*) trans); break;}
+				case TRANSACTION_TYPE_SECURITY_BUY: {}
+				case TRANSACTION_TYPE_SECURITY_SELL: {
+					securityTransactions.append((SecurityTransaction*) trans);
+					((SecurityTransaction*) trans)->security()->transactions.append((SecurityTransaction*) trans);
+					break;
+				}
+				default: {}
+			}
+			if(state.merge) {
+				qlonglong old_id = trans->id();
+				trans->setId(getNewId());
+				state.merge_transaction_ids[old_id] = trans->id();
+				if(trans->linksCount(false) > 0) state.update_links_list << trans;
+				trans->setFirstRevision(i_revision);
+				trans->setLastRevision(i_revision);
+			} else {
+				if(!state.set_ids) state.set_ids = trans->id() == 0;
+			}
+			if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 2)))) && trans->timestamp() > state.curtime) trans->setTimestamp(trans->timestamp() / 1000000L);
+			if((state.i_version[0] < 1 || (state.i_version[0] == 1 && (state.i_version[1] < 3 || (state.i_version[1] == 3 && state.i_version[2] <= 4)))) && trans->associatedFile().contains(",")) {
+				trans->setAssociatedFile(QString("\"") + trans->associatedFile() + "\"");
+			}
+			transactions.append(trans);
+			if(state.merge && state.ignore_duplicate_transactions) state.merge_duplicates_index.insert(transaction_duplicate_key(trans), trans);
+			for(int i2 = 0; i2 < trans->tagsCount(false); i2++) {
+				if(!tags.contains(trans->getTag(i2))) tags << trans->getTag(i2);
+			}
+		}
+	} else if(!valid) {
+		state.transaction_errors++;
 	}
-	file.close();
-
-	resetDefaultCurrencyChanged();
-	return QString();
 }
 int Budget::fileRevision(QString filename, QString &error) const {
 
@@ -1594,6 +2599,17 @@ int Budget::fileRevision(QString filename, QString &error) const {
 		return -1;
 	}
 
+	if(file.peek(4) == BINARY_SNAPSHOT_MAGIC) {
+		int file_revision = binary_snapshot_revision(file);
+		file.close();
+		if(file_revision < 0) {
+			error = tr("Not a valid Eqonomize! binary file");
+			return -1;
+		}
+		error = QString();
+		return file_revision;
+	}
+
 	QXmlStreamReader xml(&file);
 	if(!xml.readNextStartElement()) {
 		error = tr("Not a valid Eqonomize! file (XML parse error: \"%1\" at line %2, col %3)").arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
@@ -1606,6 +2622,8 @@ int Budget::fileRevision(QString filename, QString &error) const {
 
 	int file_revision = xml.attributes().value("revision").toInt();
 	if(file_revision <= 0) file_revision = 1;
+	int journaled_revision = journal_revision(filename, xml.attributes().value("saveid").toString());
+	if(journaled_revision > file_revision) file_revision = journaled_revision;
 	file.close();
 
 	error = QString();
@@ -1625,6 +2643,17 @@ bool Budget::isUnsynced(QString filename, QString &error, int synced_revision) c
 		return false;
 	}
 
+	if(file.peek(4) == BINARY_SNAPSHOT_MAGIC) {
+		int file_revision = binary_snapshot_revision(file);
+		file.close();
+		if(file_revision < 0) {
+			error = tr("Not a valid Eqonomize! binary file");
+			return false;
+		}
+		error = QString();
+		return file_revision > synced_revision;
+	}
+
 	QXmlStreamReader xml(&file);
 	if(!xml.readNextStartElement()) {
 		error = tr("Not a valid Eqonomize! file (XML parse error: \"%1\" at line %2, col %3)").arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
@@ -1637,6 +2666,8 @@ bool Budget::isUnsynced(QString filename, QString &error, int synced_revision) c
 
 	int file_revision = xml.attributes().value("revision").toInt();
 	if(file_revision <= 0) file_revision = 1;
+	int journaled_revision = journal_revision(filename, xml.attributes().value("saveid").toString());
+	if(journaled_revision > file_revision) file_revision = journaled_revision;
 	file.close();
 
 	error = QString();
@@ -1768,6 +2799,9 @@ bool Budget::autosyncEnabled() const {return o_sync->autosync && o_sync->isCompl
 
 QString Budget::syncFile(QString filename, QString &errors, int synced_revision) {
 
+	finishLoading();
+	finishSaving();
+
 	if(synced_revision < 0) synced_revision = i_opened_revision;
 
 	QFile file(filename);
@@ -1795,8 +2829,19 @@ QString Budget::syncFile(QString filename, QString &errors, int synced_revision)
 		return QString();
 	}
 
+	//synchronized changes are not recorded in the journal
+	stopJournal();
+
 	last_id = file_last_id;
 
+	invalidateTransactionIdIndex();
+	invalidateAccountTransactionsIndex();
+	invalidateBudgetMonthAggregates();
+	invalidateTransactionsDuplicateIndex();
+	invalidateTransactionsTextIndex();
+	invalidateScheduleOccurrences();
+	invalidateBudgetPeriods();
+
 	i_revision += revision_diff;
 	i_opened_revision = i_revision;
 
@@ -2346,6 +3391,9 @@ QString Budget::syncFile(QString filename, QString &errors, int synced_revision)
 		errors += tr("XML parse error: \"%1\" at line %2, col %3").arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
 	}
 
+	invalidateAccountNameIndex();
+	invalidateSecurityNameIndex();
+
 	for(QHash<qlonglong, ScheduledTransaction*>::iterator it = scheduleds_id.begin(); it != scheduleds_id.end(); ++it) {
 		if((*it)->lastRevision() <= synced_revision) removeScheduledTransaction(*it);
 	}
@@ -2416,6 +3464,7 @@ QString Budget::syncFile(QString filename, QString &errors, int synced_revision)
 		security->scheduledReinvestedDividends.sort();
 		security->reinvestedDividends.sort();
 		security->tradedShares.sort();
+		security->sharesModified();
 	}
 	transactions.sort();
 	scheduledTransactions.sort();
@@ -2447,13 +3496,18 @@ QString Budget::syncFile(QString filename, QString &errors, int synced_revision)
 }
 
 
-QString Budget::saveFile(QString filename, QFile::Permissions permissions, bool is_backup) {
+QString Budget::saveFile(QString filename, QFile::Permissions permissions, bool is_backup, bool incremental) {
+
+	finishLoading();
+	finishSaving();
 
 	QFileInfo info(filename);
 	if(info.isDir()) {
 		return tr("File is a directory");
 	}
 
+	if(incremental && !is_backup && canSaveIncrementally(filename)) return saveJournal(filename, permissions);
+
 	QSaveFile ofile(filename);
 	ofile.setDirectWriteFallback(true);
 	ofile.open(QIODevice::WriteOnly);
@@ -2465,6 +3519,10 @@ QString Budget::saveFile(QString filename, QFile::Permissions permissions, bool
 
 	if(!is_backup) i_opened_revision = i_revision;
 
+	//the save id binds the journal entries appended by later incremental saves to this version of the file
+	QString save_id;
+	if(!is_backup) save_id = QUuid::createUuid().toString();
+
 	QXmlStreamWriter xml(&ofile);
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 	xml.setCodec("UTF-8");
@@ -2472,12 +3530,324 @@ QString Budget::saveFile(QString filename, QFile::Permissions permissions, bool
 	xml.setAutoFormatting(true);
 	xml.setAutoFormattingIndent(-1);
 
+	writeXml(&xml, false, save_id);
+
+	if(ofile.error() != QFile::NoError) {
+		ofile.cancelWriting();
+		return tr("Error while writing file; file was not saved");
+	}
+
+	if(!ofile.commit()) {
+		return tr("Error while writing file; file was not saved");
+	}
+
+	if(!is_backup) {
+		//the new file includes everything in the old journal
+		s_save_id = save_id;
+		QFile::remove(filename + JOURNAL_FILE_SUFFIX);
+		startJournal(filename);
+	} else if(filename == s_journal_file) {
+		stopJournal();
+	}
+
+	return QString();
+
+}
+bool Budget::canSaveIncrementally(QString filename) {
+	//only transactions, splits and security trades are journaled; any other change requires a full save
+	if(!b_journal || s_save_id.isEmpty() || filename != s_journal_file) return false;
+	QFileInfo info(filename);
+	if(!info.exists() || info.size() < JOURNAL_MIN_FILE_SIZE) return false;
+	QFileInfo journal_info(filename + JOURNAL_FILE_SUFFIX);
+	if(journal_info.size() > info.size() / JOURNAL_COMPACTION_RATIO) return false;
+	return xmlHeaderHash() == journal_header_hash;
+}
+QString Budget::startSaveFile(QString filename, QFile::Permissions permissions, bool is_backup, bool incremental) {
+
+	finishLoading();
+	finishSaving();
+
+	QFileInfo info(filename);
+	if(info.isDir()) {
+		return tr("File is a directory");
+	}
+
+	//journal entries are small and are appended directly
+	if(incremental && !is_backup && canSaveIncrementally(filename)) return saveJournal(filename, permissions);
+
+	PendingSave *save = new PendingSave();
+	save->filename = filename;
+	save->permissions = permissions;
+	save->is_backup = is_backup;
+	save->balancing_account = balancingAccount;
+
+	if(!is_backup) {
+		i_opened_revision = i_revision;
+		save->save_id = QUuid::createUuid().toString();
+		save->header_hash = xmlHeaderHash();
+		//changes made while the file is written are recorded for the next journal entry
+		save->journal = b_journal;
+		save->journal_modified_ids = journal_modified_ids;
+		save->journal_removed_ids = journal_removed_ids;
+		journal_modified_ids.clear();
+		journal_removed_ids.clear();
+		b_journal = true;
+	}
+
+	save->xml = new QXmlStreamWriter(&save->data);
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+	save->xml->setCodec("UTF-8");
+#endif
+	save->xml->setAutoFormatting(true);
+	save->xml->setAutoFormattingIndent(-1);
+
+	writeXmlStart(save->xml, save->save_id);
+
+	//split transactions are written directly, since the parts of a copied split would be removed from the budget when the copy is deleted
+	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+		SplitTransaction *split = *it;
+		if(split->count() > 0) write_split_element(*save->xml, split);
+	}
+
+	save->trades.reserve(securityTrades.count());
+	for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
+		save->trades << new SecurityTrade(**it);
+	}
+	save->transactions.reserve(transactions.count());
+	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		Transaction *trans = *it;
+		if(!trans->parentSplit()) save->transactions << trans->copy();
+	}
+
+	pending_save = save;
+	save->pool = new QThreadPool();
+	save->pool->setMaxThreadCount(1);
+	save->pool->start(new PendingSaveWriter(save));
+
+	return QString();
+
+}
+bool Budget::isSaving() const {return pending_save != NULL;}
+bool Budget::savingFinished(QString &error, bool wait) {
+	error = QString();
+	if(!pending_save) {
+		error = s_save_error;
+		s_save_error = QString();
+		return true;
+	}
+	PendingSave *save = pending_save;
+	if(wait) save->pool->waitForDone();
+	if(!save->finished.loadAcquire()) return false;
+	delete save->pool;
+	delete save->xml;
+	qDeleteAll(save->trades);
+	qDeleteAll(save->transactions);
+	error = save->error;
+	if(!save->is_backup) {
+		if(error.isNull()) {
+			//the new file includes everything in the old journal
+			s_save_id = save->save_id;
+			QFile::remove(save->filename + JOURNAL_FILE_SUFFIX);
+			s_journal_file = save->filename;
+			journal_header_hash = save->header_hash;
+		} else if(save->journal) {
+			journal_modified_ids.unite(save->journal_modified_ids);
+			journal_removed_ids.unite(save->journal_removed_ids);
+		} else {
+			stopJournal();
+		}
+	} else if(error.isNull() && save->filename == s_journal_file) {
+		stopJournal();
+	}
+	delete save;
+	pending_save = NULL;
+	return true;
+}
+void Budget::finishSaving() {
+	//errors are kept until the next call of savingFinished()
+	if(!pending_save) return;
+	QString error;
+	savingFinished(error, true);
+	s_save_error = error;
+}
+QByteArray Budget::journalEntry() {
+
+	QByteArray entry;
+	QBuffer buffer(&entry);
+	buffer.open(QIODevice::WriteOnly);
+	QXmlStreamWriter xml(&buffer);
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+	xml.setCodec("UTF-8");
+#endif
+	xml.setAutoFormatting(true);
+	xml.setAutoFormattingIndent(-1);
+
+	xml.writeStartElement("entry");
+	xml.writeAttribute("version", VERSION);
+	xml.writeAttribute("saveid", s_save_id);
+	xml.writeAttribute("revision", QString::number(i_revision));
+	xml.writeAttribute("lastid", QString::number(last_id));
+
+	//objects with a removed id are removed before the objects in the entry are added, so a removed id might also have been reused
+	QSet<qlonglong> ids = journal_modified_ids;
+	for(QSet<qlonglong>::const_iterator it = journal_removed_ids.constBegin(); it != journal_removed_ids.constEnd(); ++it) {
+		xml.writeEmptyElement("remove");
+		xml.writeAttribute("id", QString::number(*it));
+		ids.insert(*it);
+	}
+
+	if(!b_transactions_id_index_valid) rebuildTransactionIdIndex();
+	QSet<SplitTransaction*> splits;
+	QList<Transaction*> single_transactions;
+	for(QSet<qlonglong>::const_iterator it = ids.constBegin(); it != ids.constEnd(); ++it) {
+		if(*it == 0) continue;
+		QMultiHash<qlonglong, Transactions*>::const_iterator it2 = transactions_id_index.constFind(*it);
+		while(it2 != transactions_id_index.constEnd() && it2.key() == *it) {
+			Transactions *transs = *it2;
+			if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+				splits.insert((SplitTransaction*) transs);
+			} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+				//parts of a split are saved with the split
+				Transaction *trans = (Transaction*) transs;
+				if(trans->parentSplit()) splits.insert(trans->parentSplit());
+				else single_transactions << trans;
+			}
+			++it2;
+		}
+	}
+	for(QSet<SplitTransaction*>::const_iterator it = splits.constBegin(); it != splits.constEnd(); ++it) {
+		if((*it)->count() > 0) write_split_element(xml, *it);
+	}
+	for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
+		if(ids.contains((*it)->id)) write_trade_element(xml, *it);
+	}
+	for(int i = 0; i < single_transactions.count(); i++) {
+		write_transaction_element(xml, single_transactions.at(i), balancingAccount);
+	}
+
+	xml.writeEndElement();
+	buffer.close();
+	entry += '\n';
+
+	return entry;
+
+}
+QString Budget::saveJournal(QString filename, QFile::Permissions permissions) {
+
+	QByteArray entry = journalEntry();
+
+	QFile file(filename + JOURNAL_FILE_SUFFIX);
+	bool is_new = !file.exists();
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		return tr("Couldn't open file for writing");
+	}
+	if(is_new) file.setPermissions(permissions);
+	qint64 journal_size = file.size();
+	if(file.write(entry) != entry.size() || !file.flush()) {
+		//an incomplete entry would hide all entries appended after it
+		file.resize(journal_size);
+		file.close();
+		return tr("Error while writing file; file was not saved");
+	}
+	file.close();
+
+	i_opened_revision = i_revision;
+	journal_modified_ids.clear();
+	journal_removed_ids.clear();
+
+	return QString();
+
+}
+bool Budget::canSaveRecoveryJournal(QString filename) {
+	if(!b_journal || s_save_id.isEmpty() || filename != s_journal_file || !QFile::exists(filename)) return false;
+	return xmlHeaderHash() == journal_header_hash;
+}
+QString Budget::saveRecoveryJournal(QString filename, QFile::Permissions permissions) {
+
+	//a single entry with all changes that have not been saved (the recorded changes are kept for the next save)
+	QByteArray entry = journalEntry();
+
+	QSaveFile ofile(filename + JOURNAL_FILE_SUFFIX);
+	ofile.setDirectWriteFallback(true);
+	ofile.open(QIODevice::WriteOnly);
+	ofile.setPermissions(permissions);
+	if(!ofile.isOpen()) {
+		ofile.cancelWriting();
+		return tr("Couldn't open file for writing");
+	}
+	if(ofile.write(entry) != entry.size() || ofile.error() != QFile::NoError) {
+		ofile.cancelWriting();
+		return tr("Error while writing file; file was not saved");
+	}
+	if(!ofile.commit()) {
+		return tr("Error while writing file; file was not saved");
+	}
+
+	return QString();
+
+}
+QString Budget::loadRecoveryJournal(QString filename, QString &errors) {
+	finishLoading();
+	if(!b_journal || journal_revision(filename, s_save_id) < 0) return tr("The auto-saved changes do not match the saved file");
+	if(!loadJournal(filename, errors, true)) return tr("Error while reading auto-saved changes");
+	return QString();
+}
+void Budget::startJournal(QString filename) {
+	s_journal_file = filename;
+	journal_header_hash = xmlHeaderHash();
+	journal_modified_ids.clear();
+	journal_removed_ids.clear();
+	b_journal = !s_save_id.isEmpty();
+}
+void Budget::stopJournal() {
+	b_journal = false;
+	s_journal_file = QString();
+	journal_header_hash = QByteArray();
+	journal_modified_ids.clear();
+	journal_removed_ids.clear();
+}
+
+void Budget::writeXml(QXmlStreamWriter *xml_writer, bool skip_binary_records, const QString &save_id) {
+
+	QXmlStreamWriter &xml = *xml_writer;
+
+	writeXmlStart(&xml, save_id);
+
+	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+		SplitTransaction *split = *it;
+		if(split->count() > 0) write_split_element(xml, split);
+	}
+
+	for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
+		write_trade_element(xml, *it);
+	}
+
+	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		Transaction *trans = *it;
+		if(!trans->parentSplit() && (!skip_binary_records || !binary_record_type(trans, balancingAccount))) write_transaction_element(xml, trans, balancingAccount);
+	}
+
+	xml.writeEndElement();
+
+}
+void Budget::writeXmlStart(QXmlStreamWriter *xml_writer, const QString &save_id) {
+
+	QXmlStreamWriter &xml = *xml_writer;
+
 	xml.writeStartDocument();
 	xml.writeDTD("<!DOCTYPE EqonomizeDoc>");
 	xml.writeStartElement("EqonomizeDoc");
 	xml.writeAttribute("version", VERSION);
 	xml.writeAttribute("revision", QString::number(i_revision));
 	xml.writeAttribute("lastid", QString::number(last_id));
+	if(!save_id.isEmpty()) xml.writeAttribute("saveid", save_id);
+
+	writeXmlHeader(&xml);
+
+}
+void Budget::writeXmlHeader(QXmlStreamWriter *xml_writer) {
+
+	QXmlStreamWriter &xml = *xml_writer;
 
 	if(o_sync->isComplete()) {
 		xml.writeStartElement("synchronization");
@@ -2536,74 +3906,97 @@ QString Budget::saveFile(QString filename, QFile::Permissions permissions, bool
 		strans->save(&xml);
 		xml.writeEndElement();
 	}
-	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
-		SplitTransaction *split = *it;
-		if(split->count() > 0) {
-			xml.writeStartElement("transaction");
-			switch(split->type()) {
-				case SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS: {
-					xml.writeAttribute("type", "multiitem");
-					break;
-				}
-				case SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS: {
-					xml.writeAttribute("type", "multiaccount");
-					break;
-				}
-				case SPLIT_TRANSACTION_TYPE_LOAN: {
-					xml.writeAttribute("type", "debtpayment");
-					break;
-				}
-			}
-			split->save(&xml);
-			xml.writeEndElement();
-		}
-	}
+}
+QByteArray Budget::xmlHeaderHash() {
+	QByteArray header;
+	QBuffer buffer(&header);
+	buffer.open(QIODevice::WriteOnly);
+	QXmlStreamWriter xml(&buffer);
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+	xml.setCodec("UTF-8");
+#endif
+	writeXmlHeader(&xml);
+	buffer.close();
+	return QCryptographicHash::hash(header, QCryptographicHash::Sha1);
+}
+QString Budget::saveBinary(QString filename, QFile::Permissions permissions) {
 
-	for(SecurityTradeList<SecurityTrade*>::const_iterator it = securityTrades.constBegin(); it != securityTrades.constEnd(); ++it) {
-		SecurityTrade *ts = *it;
-		xml.writeStartElement("transaction");
-		xml.writeAttribute("type", "security_trade");
-		ts->save(&xml);
-		xml.writeEndElement();
+	finishLoading();
+	finishSaving();
+
+	QFileInfo info(filename);
+	if(info.isDir()) {
+		return tr("File is a directory");
 	}
 
+	i_opened_revision = i_revision;
+
+	BinaryStringTable table;
+	table.strings << QString();
+	QByteArray records, record(BINARY_SNAPSHOT_RECORD_SIZE, '\0');
+	records.reserve(transactions.count() * BINARY_SNAPSHOT_RECORD_SIZE);
+	quint32 record_count = 0;
 	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
 		Transaction *trans = *it;
-		if(!trans->parentSplit()) {
-			xml.writeStartElement("transaction");
-			switch(trans->type()) {
-				case TRANSACTION_TYPE_TRANSFER: {
-					if(trans->fromAccount() == balancingAccount || trans->toAccount() == balancingAccount) xml.writeAttribute("type", "balancing");
-					else xml.writeAttribute("type", "transfer");
-					break;
-				}
-				case TRANSACTION_TYPE_INCOME: {
-					if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) xml.writeAttribute("type", "reinvested_dividend");
-					else if(((Income*) trans)->security()) xml.writeAttribute("type", "dividend");
-					else if(trans->value() < 0.0) xml.writeAttribute("type", "repayment");
-					else xml.writeAttribute("type", "income");
-					break;
-				}
-				case TRANSACTION_TYPE_EXPENSE: {
-					if(trans->value() < 0.0) xml.writeAttribute("type", "refund");
-					else xml.writeAttribute("type", "expense");
-					break;
-				}
-				case TRANSACTION_TYPE_SECURITY_BUY: {
-					xml.writeAttribute("type", "security_buy");
-					break;
-				}
-				case TRANSACTION_TYPE_SECURITY_SELL: {
-					xml.writeAttribute("type", "security_sell");
-					break;
-				}
-			}
-			trans->save(&xml);
-			xml.writeEndElement();
+		int type = binary_record_type(trans, balancingAccount);
+		if(type) {
+			record.fill('\0');
+			write_binary_record((uchar*) record.data(), trans, type, table);
+			records += record;
+			record_count++;
 		}
 	}
 
-	xml.writeEndElement();
+	QByteArray string_offsets, string_data;
+	string_offsets.resize((table.strings.count() + 1) * 4);
+	binary_put_u32((uchar*) string_offsets.data(), 0);
+	for(int i = 0; i < table.strings.count(); i++) {
+		string_data += table.strings.at(i).toUtf8();
+		binary_put_u32((uchar*) string_offsets.data() + (i + 1) * 4, string_data.size());
+	}
+	//records are aligned to 8 bytes
+	while((BINARY_SNAPSHOT_HEADER_SIZE + string_offsets.size() + string_data.size()) % 8 != 0) string_data += '\0';
+
+	QByteArray document;
+	QBuffer buffer(&document);
+	buffer.open(QIODevice::WriteOnly);
+	QXmlStreamWriter xml(&buffer);
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+	xml.setCodec("UTF-8");
+#endif
+	writeXml(&xml, true);
+	buffer.close();
+
+	QByteArray header(BINARY_SNAPSHOT_HEADER_SIZE, '\0');
+	uchar *h = (uchar*) header.data();
+	memcpy(h, BINARY_SNAPSHOT_MAGIC, 4);
+	binary_put_u32(h + 4, BINARY_SNAPSHOT_VERSION);
+	binary_put_u32(h + 8, i_revision);
+	binary_put_u32(h + 12, BINARY_SNAPSHOT_RECORD_SIZE);
+	binary_put_i64(h + 16, last_id);
+	binary_put_u32(h + 24, table.strings.count());
+	binary_put_u32(h + 28, record_count);
+	qint64 strings_pos = BINARY_SNAPSHOT_HEADER_SIZE;
+	qint64 records_pos = strings_pos + string_offsets.size() + string_data.size();
+	qint64 document_pos = records_pos + records.size();
+	binary_put_i64(h + 32, strings_pos);
+	binary_put_i64(h + 40, records_pos);
+	binary_put_i64(h + 48, document_pos);
+	binary_put_i64(h + 56, document.size());
+
+	QSaveFile ofile(filename);
+	ofile.setDirectWriteFallback(true);
+	ofile.open(QIODevice::WriteOnly);
+	ofile.setPermissions(permissions);
+	if(!ofile.isOpen()) {
+		ofile.cancelWriting();
+		return tr("Couldn't open file for writing");
+	}
+	ofile.write(header);
+	ofile.write(string_offsets);
+	ofile.write(string_data);
+	ofile.write(records);
+	ofile.write(document);
 
 	if(ofile.error() != QFile::NoError) {
 		ofile.cancelWriting();
@@ -2614,6 +4007,10 @@ QString Budget::saveFile(QString filename, QFile::Permissions permissions, bool
 		return tr("Error while writing file; file was not saved");
 	}
 
+	//binary snapshots are never journaled
+	QFile::remove(filename + JOURNAL_FILE_SUFFIX);
+	if(filename == s_journal_file) stopJournal();
+
 	return QString();
 
 }
@@ -2625,6 +4022,110 @@ void Budget::addTransactions(Transactions *trans) {
 		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {addScheduledTransaction((ScheduledTransaction*) trans); break;}
 	}
 }
+void Budget::addTransactions(const QList<Transactions*> &list) {
+	if(list.isEmpty()) return;
+	if(list.count() == 1) {
+		addTransactions(list.first());
+		return;
+	}
+	//new transactions are collected per list, sorted, and merged into each list once, instead of one sorted insert per transaction
+	TransactionList<Transaction*> new_transactions;
+	TransactionList<Expense*> new_expenses;
+	TransactionList<Income*> new_incomes;
+	TransactionList<Transfer*> new_transfers;
+	TransactionList<SecurityTransaction*> new_security_transactions;
+	SplitTransactionList<SplitTransaction*> new_splits;
+	ScheduledTransactionList<ScheduledTransaction*> new_schedules;
+	for(QList<Transactions*>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) {
+		Transactions *transs = *it;
+		if(transs->id() == 0) transs->setId(getNewId());
+		if(transs->firstRevision() == 0) transs->setFirstRevision(i_revision);
+		if(transs->lastRevision() == 0) transs->setLastRevision(i_revision);
+		switch(transs->generaltype()) {
+			case GENERAL_TRANSACTION_TYPE_SINGLE: {new_transactions.append((Transaction*) transs); break;}
+			case GENERAL_TRANSACTION_TYPE_SPLIT: {
+				SplitTransaction *split = (SplitTransaction*) transs;
+				new_splits.append(split);
+				int c = split->count();
+				for(int i = 0; i < c; i++) {
+					Transaction *trans = split->at(i);
+					if(trans->id() == 0) trans->setId(getNewId());
+					if(trans->firstRevision() == 0) trans->setFirstRevision(i_revision);
+					if(trans->lastRevision() == 0) trans->setLastRevision(i_revision);
+					new_transactions.append(trans);
+				}
+				break;
+			}
+			case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
+				ScheduledTransaction *strans = (ScheduledTransaction*) transs;
+				new_schedules.append(strans);
+				if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
+					((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.inSort(strans);
+				} else if(strans->transactiontype() == TRANSACTION_TYPE_INCOME && ((Income*) strans->transaction())->security()) {
+					if(strans->transactionsubtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) strans->transaction())->security()->scheduledReinvestedDividends.inSort(strans);
+					else ((Income*) strans->transaction())->security()->scheduledDividends.inSort(strans);
+				}
+				break;
+			}
+		}
+	}
+	for(TransactionList<Transaction*>::const_iterator it = new_transactions.constBegin(); it != new_transactions.constEnd(); ++it) {
+		Transaction *trans = *it;
+		switch(trans->type()) {
+			case TRANSACTION_TYPE_EXPENSE: {new_expenses.append((Expense*) trans); break;}
+			case TRANSACTION_TYPE_INCOME: {
+				new_incomes.append((Income*) trans);
+				if(((Income*) trans)->security()) {
+					if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) {((Income*) trans)->security()->reinvestedDividends.inSort((ReinvestedDividend*) trans); ((Income*) trans)->security()->sharesModified();}
+					else ((Income*) trans)->security()->dividends.inSort((Income*) trans);
+				}
+				break;
+			}
+			case TRANSACTION_TYPE_TRANSFER: {new_transfers.append((Transfer*) trans); break;}
+			case TRANSACTION_TYPE_SECURITY_BUY: {}
+			case TRANSACTION_TYPE_SECURITY_SELL: {
+				SecurityTransaction *sectrans = (SecurityTransaction*) trans;
+				new_security_transactions.append(sectrans);
+				sectrans->security()->transactions.inSort(sectrans);
+				sectrans->security()->sharesModified();
+				break;
+			}
+		}
+	}
+	if(b_account_transactions_index_valid) {
+		for(QList<Transactions*>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) indexTransactionAccounts(*it);
+	}
+	if(b_budget_month_aggregates_valid) {
+		for(TransactionList<Transaction*>::const_iterator it = new_transactions.constBegin(); it != new_transactions.constEnd(); ++it) aggregateTransaction(*it);
+	}
+	if(b_transactions_duplicate_index_valid) {
+		for(TransactionList<Transaction*>::const_iterator it = new_transactions.constBegin(); it != new_transactions.constEnd(); ++it) indexTransactionDuplicateKey(*it);
+	}
+	if(b_transactions_text_index_valid) {
+		for(TransactionList<Transaction*>::const_iterator it = new_transactions.constBegin(); it != new_transactions.constEnd(); ++it) indexTransactionText(*it);
+		for(SplitTransactionList<SplitTransaction*>::const_iterator it = new_splits.constBegin(); it != new_splits.constEnd(); ++it) indexTransactionText(*it);
+		for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = new_schedules.constBegin(); it != new_schedules.constEnd(); ++it) indexTransactionText(*it);
+	}
+	if(b_transactions_id_index_valid) {
+		for(TransactionList<Transaction*>::const_iterator it = new_transactions.constBegin(); it != new_transactions.constEnd(); ++it) transactions_id_index.insert((*it)->id(), *it);
+		for(SplitTransactionList<SplitTransaction*>::const_iterator it = new_splits.constBegin(); it != new_splits.constEnd(); ++it) transactions_id_index.insert((*it)->id(), *it);
+		for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = new_schedules.constBegin(); it != new_schedules.constEnd(); ++it) {
+			transactions_id_index.insert((*it)->id(), *it);
+			if((*it)->transaction()) transactions_id_index.insert((*it)->transaction()->id(), *it);
+		}
+	}
+	expenses.inSort(new_expenses);
+	incomes.inSort(new_incomes);
+	transfers.inSort(new_transfers);
+	securityTransactions.inSort(new_security_transactions);
+	transactions.inSort(new_transactions);
+	splitTransactions.inSort(new_splits);
+	scheduledTransactions.inSort(new_schedules);
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = new_schedules.constBegin(); it != new_schedules.constEnd(); ++it) invalidateScheduleOccurrences(*it);
+	if(b_journal) {
+		for(QList<Transactions*>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) journalTransaction(*it);
+	}
+}
 void Budget::removeTransactions(Transactions *trans, bool keep) {
 	switch(trans->generaltype()) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {removeTransaction((Transaction*) trans, keep); break;}
@@ -2642,7 +4143,7 @@ void Budget::addTransaction(Transaction *trans) {
 		case TRANSACTION_TYPE_INCOME: {
 			incomes.inSort((Income*) trans);
 			if(((Income*) trans)->security()) {
-				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) trans)->security()->reinvestedDividends.inSort((ReinvestedDividend*) trans);
+				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) {((Income*) trans)->security()->reinvestedDividends.inSort((ReinvestedDividend*) trans); ((Income*) trans)->security()->sharesModified();}
 				else ((Income*) trans)->security()->dividends.inSort((Income*) trans);
 			}
 			break;
@@ -2653,17 +4154,31 @@ void Budget::addTransaction(Transaction *trans) {
 			SecurityTransaction *sectrans = (SecurityTransaction*) trans;
 			securityTransactions.inSort(sectrans);
 			sectrans->security()->transactions.inSort(sectrans);
+			sectrans->security()->sharesModified();
 			//if(sectrans->shareValue() > 0.0) sectrans->security()->setQuotation(sectrans->date(), sectrans->shareValue(), true);
 			break;
 		}
 	}
 	transactions.inSort(trans);
+	if(b_transactions_id_index_valid) transactions_id_index.insert(trans->id(), trans);
+	if(b_account_transactions_index_valid && !trans->parentSplit()) indexTransactionAccounts(trans);
+	if(b_budget_month_aggregates_valid) aggregateTransaction(trans);
+	if(b_transactions_duplicate_index_valid) indexTransactionDuplicateKey(trans);
+	if(b_transactions_text_index_valid) indexTransactionText(trans);
+	journalTransaction(trans);
 }
 void Budget::removeTransaction(Transaction *trans, bool keep) {
 	if(trans->parentSplit()) {
+		transactionModified(trans->parentSplit());
 		trans->parentSplit()->removeTransaction(trans, keep);
 		return;
 	}
+	if(b_journal) journal_removed_ids.insert(trans->id());
+	if(b_transactions_id_index_valid) transactions_id_index.remove(trans->id(), trans);
+	if(b_account_transactions_index_valid) unindexTransactionAccounts(trans);
+	if(b_budget_month_aggregates_valid) unaggregateTransaction(trans);
+	if(b_transactions_duplicate_index_valid) unindexTransactionDuplicateKey(trans);
+	if(b_transactions_text_index_valid) unindexTransactionText(trans);
 	transactions.removeRef(trans);
 	switch(trans->type()) {
 		case TRANSACTION_TYPE_EXPENSE: {
@@ -2676,7 +4191,7 @@ void Budget::removeTransaction(Transaction *trans, bool keep) {
 		case TRANSACTION_TYPE_INCOME: {
 			incomes.setAutoDelete(false);
 			if(((Income*) trans)->security()) {
-				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) trans)->security()->reinvestedDividends.removeRef((ReinvestedDividend*) trans);
+				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) {((Income*) trans)->security()->reinvestedDividends.removeRef((ReinvestedDividend*) trans); ((Income*) trans)->security()->sharesModified();}
 				else ((Income*) trans)->security()->dividends.removeRef((Income*) trans);
 			}
 			incomes.removeRef((Income*) trans);
@@ -2697,6 +4212,7 @@ void Budget::removeTransaction(Transaction *trans, bool keep) {
 			sectrans->security()->removeQuotation(sectrans->date(), true);
 			securityTransactions.setAutoDelete(false);
 			sectrans->security()->transactions.removeRef(sectrans);
+			sectrans->security()->sharesModified();
 			securityTransactions.removeRef(sectrans);
 			securityTransactions.setAutoDelete(true);
 			if(!keep) delete trans;
@@ -2709,15 +4225,24 @@ void Budget::addSplitTransaction(SplitTransaction *split) {
 	if(split->firstRevision() == 0) split->setFirstRevision(i_revision);
 	if(split->lastRevision() == 0) split->setLastRevision(i_revision);
 	splitTransactions.inSort(split);
+	if(b_transactions_id_index_valid) transactions_id_index.insert(split->id(), split);
 	int c = split->count();
 	for(int i = 0; i < c; i++) {
 		addTransaction(split->at(i));
 	}
+	if(b_account_transactions_index_valid) indexTransactionAccounts(split);
+	if(b_transactions_text_index_valid) indexTransactionText(split);
+	journalTransaction(split);
 }
 void Budget::removeSplitTransaction(SplitTransaction *split, bool keep) {
+	if(b_journal) journal_removed_ids.insert(split->id());
 	int c = split->count();
 	for(int i = 0; i < c; i++) {
 		Transaction *trans = split->at(i);
+		if(b_transactions_id_index_valid) transactions_id_index.remove(trans->id(), trans);
+		if(b_budget_month_aggregates_valid) unaggregateTransaction(trans);
+		if(b_transactions_duplicate_index_valid) unindexTransactionDuplicateKey(trans);
+		if(b_transactions_text_index_valid) unindexTransactionText(trans);
 		transactions.removeRef(trans);
 		switch(trans->type()) {
 			case TRANSACTION_TYPE_EXPENSE: {
@@ -2729,7 +4254,7 @@ void Budget::removeSplitTransaction(SplitTransaction *split, bool keep) {
 			case TRANSACTION_TYPE_INCOME: {
 				incomes.setAutoDelete(false);
 				incomes.removeRef((Income*) trans);
-				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) trans)->security()->reinvestedDividends.removeRef((ReinvestedDividend*) trans);
+				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) {((Income*) trans)->security()->reinvestedDividends.removeRef((ReinvestedDividend*) trans); ((Income*) trans)->security()->sharesModified();}
 				else if(((Income*) trans)->security()) ((Income*) trans)->security()->dividends.removeRef((Income*) trans);
 				incomes.setAutoDelete(true);
 				break;
@@ -2746,12 +4271,16 @@ void Budget::removeSplitTransaction(SplitTransaction *split, bool keep) {
 				sectrans->security()->removeQuotation(sectrans->date(), true);
 				securityTransactions.setAutoDelete(false);
 				sectrans->security()->transactions.removeRef(sectrans);
+				sectrans->security()->sharesModified();
 				securityTransactions.removeRef(sectrans);
 				securityTransactions.setAutoDelete(true);
 				break;
 			}
 		}
 	}
+	if(b_transactions_id_index_valid) transactions_id_index.remove(split->id(), split);
+	if(b_account_transactions_index_valid) unindexTransactionAccounts(split);
+	if(b_transactions_text_index_valid) unindexTransactionText(split);
 	if(keep) splitTransactions.setAutoDelete(false);
 	splitTransactions.removeRef(split);
 	if(keep) splitTransactions.setAutoDelete(true);
@@ -2761,6 +4290,13 @@ void Budget::addScheduledTransaction(ScheduledTransaction *strans) {
 	if(strans->firstRevision() == 0) strans->setFirstRevision(i_revision);
 	if(strans->lastRevision() == 0) strans->setLastRevision(i_revision);
 	scheduledTransactions.inSort(strans);
+	invalidateScheduleOccurrences(strans);
+	if(b_transactions_id_index_valid) {
+		transactions_id_index.insert(strans->id(), strans);
+		if(strans->transaction()) transactions_id_index.insert(strans->transaction()->id(), strans);
+	}
+	if(b_account_transactions_index_valid) indexTransactionAccounts(strans);
+	if(b_transactions_text_index_valid) indexTransactionText(strans);
 	if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
 		((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.inSort(strans);
 	} else if(strans->transactiontype() == TRANSACTION_TYPE_INCOME && ((Income*) strans->transaction())->security()) {
@@ -2775,6 +4311,13 @@ void Budget::removeScheduledTransaction(ScheduledTransaction *strans, bool keep)
 		if(strans->transactionsubtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) strans->transaction())->security()->scheduledReinvestedDividends.removeRef(strans);
 		else ((Income*) strans->transaction())->security()->scheduledDividends.removeRef(strans);
 	}
+	if(b_transactions_id_index_valid) {
+		transactions_id_index.remove(strans->id(), strans);
+		if(strans->transaction() && transactions_id_index.remove(strans->transaction()->id(), strans) == 0) invalidateTransactionIdIndex();
+	}
+	if(b_account_transactions_index_valid) unindexTransactionAccounts(strans);
+	if(b_transactions_text_index_valid) unindexTransactionText(strans);
+	invalidateScheduleOccurrences(strans);
 	if(keep) scheduledTransactions.setAutoDelete(false);
 	scheduledTransactions.removeRef(strans);
 	if(keep) scheduledTransactions.setAutoDelete(true);
@@ -2789,6 +4332,7 @@ void Budget::addAccount(Account *account) {
 		case ACCOUNT_TYPE_ASSETS: {assetsAccounts.inSort((AssetsAccount*) account); break;}
 	}
 	accounts.inSort(account);
+	invalidateAccountNameIndex();
 	if(b_record_new_accounts) newAccounts << account;
 }
 void Budget::setRecordNewAccounts(bool rna) {b_record_new_accounts = rna;}
@@ -2796,11 +4340,22 @@ void Budget::accountModified(Account *account) {
 	switch(account->type()) {
 		case ACCOUNT_TYPE_EXPENSES: {expensesAccounts.sort(); break;}
 		case ACCOUNT_TYPE_INCOMES: {incomesAccounts.sort(); break;}
-		case ACCOUNT_TYPE_ASSETS: {assetsAccounts.sort(); break;}
+		case ACCOUNT_TYPE_ASSETS: {
+			assetsAccounts.sort();
+			//the maintainer of a loan is the payee of debt payments
+			invalidateTransactionsTextIndex();
+			break;
+		}
 	}
 	accounts.sort();
+	invalidateAccountNameIndex();
+	//the parent category, which might have been changed, is indexed with the transactions of a subcategory
+	if(account->type() != ACCOUNT_TYPE_ASSETS) invalidateAccountTransactionsIndex();
 }
 void Budget::removeAccount(Account *account, bool keep) {
+	finishLoading();
+	//the transactions copied for a background save refer to the accounts and securities
+	finishSaving();
 	if(account->type() == ACCOUNT_TYPE_INCOMES || account->type() == ACCOUNT_TYPE_EXPENSES) {
 		for(AccountList<CategoryAccount*>::const_iterator it = ((CategoryAccount*) account)->subCategories.constBegin(); it != ((CategoryAccount*) account)->subCategories.constEnd(); ++it) {
 			CategoryAccount *subcat = *it;
@@ -2839,6 +4394,9 @@ void Budget::removeAccount(Account *account, bool keep) {
 			}
 		}
 	}
+	invalidateAccountNameIndex();
+	if(!keep) account_transactions_index.remove(account);
+	accountBalanceModified(account);
 	accounts.removeRef(account);
 	switch(account->type()) {
 		case ACCOUNT_TYPE_EXPENSES: {
@@ -2866,17 +4424,12 @@ bool Budget::accountHasTransactions(Account *account, bool check_subs) {
 		Security *security = *it;
 		if(security->account() == account) return true;
 	}
-	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
-		SplitTransaction *split = *it;
-		if(split->relatesToAccount(account, true, true)) return true;
-	}
-	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
-		Transaction *trans = *it;
-		if(trans->relatesToAccount(account, true, true)) return true;
-	}
-	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
-		ScheduledTransaction *strans = *it;
-		if(strans->relatesToAccount(account, true, true)) return true;
+	if(!b_account_transactions_index_valid) rebuildAccountTransactionsIndex();
+	QHash<Account*, QSet<Transactions*> >::const_iterator it_index = account_transactions_index.constFind(account);
+	if(it_index != account_transactions_index.constEnd()) {
+		for(QSet<Transactions*>::const_iterator it = it_index->constBegin(); it != it_index->constEnd(); ++it) {
+			if((*it)->relatesToAccount(account, true, true)) return true;
+		}
 	}
 	if(check_subs && (account->type() == ACCOUNT_TYPE_INCOMES || account->type() == ACCOUNT_TYPE_EXPENSES)) {
 		for(AccountList<CategoryAccount*>::const_iterator it = ((CategoryAccount*) account)->subCategories.constBegin(); it != ((CategoryAccount*) account)->subCategories.constEnd(); ++it) {
@@ -2899,17 +4452,13 @@ void Budget::moveTransactions(Account *account, Account *new_account, bool move_
 			if(security->account() == account) security->setAccount((AssetsAccount*) new_account);
 		}
 	}
-	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
-		SplitTransaction *split = *it;
-		split->replaceAccount(account, new_account);
-	}
-	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
-		Transaction *trans = *it;
+	if(!b_account_transactions_index_valid) rebuildAccountTransactionsIndex();
+	QSet<Transactions*> account_transactions = account_transactions_index.value(account);
+	for(QSet<Transactions*>::const_iterator it = account_transactions.constBegin(); it != account_transactions.constEnd(); ++it) {
+		Transactions *trans = *it;
 		trans->replaceAccount(account, new_account);
-	}
-	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
-		ScheduledTransaction *strans = *it;
-		strans->replaceAccount(account, new_account);
+		//reindexes, reaggregates and journals the transaction
+		transactionAccountsModified(trans);
 	}
 }
 void Budget::transactionsSortModified(Transactions *trans) {
@@ -2920,6 +4469,8 @@ void Budget::transactionsSortModified(Transactions *trans) {
 	}
 }
 void Budget::transactionSortModified(Transaction *t) {
+	if(inParseThread()) return;
+	if(b_transactions_text_index_valid) reindexTransactionText(t);
 	if(transactions.removeRef(t)) transactions.inSort(t);
 	switch(t->type()) {
 		case TRANSACTION_TYPE_EXPENSE: {
@@ -2958,7 +4509,13 @@ void Budget::transactionSortModified(Transaction *t) {
 		}
 	}
 }
-void Budget::transactionDateModified(Transaction*, const QDate&) {
+void Budget::transactionDateModified(Transaction *trans, const QDate&) {
+	if(inParseThread()) return;
+	transactionModified(trans);
+	transactionSharesModified(trans);
+	reaggregateTransaction(trans);
+	reindexTransactionDuplicateKey(trans);
+	rebalanceTransaction(trans);
 /*	switch(t->type()) {
 		case TRANSACTION_TYPE_SECURITY_BUY: {}
 		case TRANSACTION_TYPE_SECURITY_SELL: {
@@ -2974,7 +4531,8 @@ void Budget::transactionDateModified(Transaction*, const QDate&) {
 		}
 	}*/
 }
-void Budget::scheduledTransactionDateModified(ScheduledTransaction*) {
+void Budget::scheduledTransactionDateModified(ScheduledTransaction *strans) {
+	invalidateScheduleOccurrences(strans);
 }
 void Budget::scheduledTransactionSortModified(ScheduledTransaction *strans) {
 	if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
@@ -2986,8 +4544,10 @@ void Budget::scheduledTransactionSortModified(ScheduledTransaction *strans) {
 	scheduledTransactions.setAutoDelete(false);
 	if(scheduledTransactions.removeRef(strans)) scheduledTransactions.inSort(strans);
 	scheduledTransactions.setAutoDelete(true);
+	invalidateScheduleOccurrences(strans);
 }
 void Budget::splitTransactionSortModified(SplitTransaction *split) {
+	if(inParseThread()) return;
 	splitTransactions.setAutoDelete(false);
 	if(splitTransactions.removeRef(split)) splitTransactions.inSort(split);
 	splitTransactions.setAutoDelete(true);
@@ -2995,22 +4555,162 @@ void Budget::splitTransactionSortModified(SplitTransaction *split) {
 void Budget::splitTransactionDateModified(SplitTransaction*, const QDate&) {}
 
 Transaction *Budget::findDuplicateTransaction(Transaction *trans) {
-	TransactionList<Transaction*>::const_iterator it = std::lower_bound(transactions.constBegin(), transactions.constEnd(), trans, transaction_list_less_than);
-	TransactionList<Transaction*>::const_iterator it2 = it;
-	while(it != transactions.constEnd()) {
-		if((*it)->date() > trans->date()) break;
+	if(!b_transactions_duplicate_index_valid) rebuildTransactionsDuplicateIndex();
+	uint key = transaction_duplicate_key(trans);
+	QMultiHash<uint, Transaction*>::const_iterator it = transactions_duplicate_index.constFind(key);
+	while(it != transactions_duplicate_index.constEnd() && it.key() == key) {
 		if(trans != *it && trans->equals(*it, false)) return *it;
 		++it;
 	}
-	while(it2 != transactions.constBegin()) {
-		--it2;
-		if((*it2)->date() != trans->date()) break;
-		if(trans != *it2 && trans->equals(*it2, false)) return *it2;
+	return NULL;
+}
+Transaction *Budget::findDuplicateTransaction(Transaction *trans, const QMultiHash<uint, Transaction*> &pending) {
+	Transaction *dup = findDuplicateTransaction(trans);
+	if(dup) return dup;
+	uint key = transaction_duplicate_key(trans);
+	QMultiHash<uint, Transaction*>::const_iterator it = pending.constFind(key);
+	while(it != pending.constEnd() && it.key() == key) {
+		if(trans != *it && trans->equals(*it, false)) return *it;
+		++it;
 	}
 	return NULL;
 }
+void Budget::invalidateTransactionsDuplicateIndex() {
+	b_transactions_duplicate_index_valid = false;
+	transactions_duplicate_index.clear();
+	transaction_duplicate_keys.clear();
+}
+void Budget::rebuildTransactionsDuplicateIndex() {
+	transactions_duplicate_index.clear();
+	transaction_duplicate_keys.clear();
+	transactions_duplicate_index.reserve(transactions.count());
+	transaction_duplicate_keys.reserve(transactions.count());
+	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		indexTransactionDuplicateKey(*it);
+	}
+	b_transactions_duplicate_index_valid = true;
+}
+void Budget::indexTransactionDuplicateKey(Transaction *trans) {
+	uint key = transaction_duplicate_key(trans);
+	transactions_duplicate_index.insert(key, trans);
+	transaction_duplicate_keys[trans] = key;
+}
+void Budget::unindexTransactionDuplicateKey(Transaction *trans) {
+	QHash<Transaction*, uint>::iterator it = transaction_duplicate_keys.find(trans);
+	if(it == transaction_duplicate_keys.end()) return;
+	transactions_duplicate_index.remove(it.value(), trans);
+	transaction_duplicate_keys.erase(it);
+}
+void Budget::reindexTransactionDuplicateKey(Transaction *trans) {
+	//only transactions that are part of the budget have a key
+	if(!b_transactions_duplicate_index_valid || !transaction_duplicate_keys.contains(trans)) return;
+	unindexTransactionDuplicateKey(trans);
+	indexTransactionDuplicateKey(trans);
+}
+bool Budget::findTextCandidates(const QString &text, QSet<qlonglong> &ids) {
+	//returns false if the text is too short to look up; the returned ids (of transactions, splits and schedules) include all that contain the text in description, comment, payee or tags, but might also include some that do not
+	QVector<quint64> keys;
+	add_text_keys(text, keys);
+	if(keys.isEmpty()) return false;
+	if(!b_transactions_text_index_valid) rebuildTransactionsTextIndex();
+	QVector<const QVector<qlonglong>*> postings;
+	const QVector<qlonglong> *smallest = NULL;
+	for(QVector<quint64>::const_iterator it = keys.constBegin(); it != keys.constEnd(); ++it) {
+		QHash<quint64, QVector<qlonglong> >::const_iterator it_index = transactions_text_index.constFind(*it);
+		if(it_index == transactions_text_index.constEnd()) return true;
+		if(!smallest || it_index->count() < smallest->count()) smallest = &it_index.value();
+		postings << &it_index.value();
+	}
+	ids.reserve(smallest->count());
+	for(QVector<qlonglong>::const_iterator it = smallest->constBegin(); it != smallest->constEnd(); ++it) {
+		bool b = true;
+		for(QVector<const QVector<qlonglong>*>::const_iterator it2 = postings.constBegin(); it2 != postings.constEnd(); ++it2) {
+			if(*it2 != smallest && !std::binary_search((*it2)->constBegin(), (*it2)->constEnd(), *it)) {
+				b = false;
+				break;
+			}
+		}
+		if(b) ids.insert(*it);
+	}
+	return true;
+}
+void Budget::invalidateTransactionsTextIndex() {
+	b_transactions_text_index_valid = false;
+	transactions_text_index.clear();
+	transaction_text_keys.clear();
+}
+void Budget::rebuildTransactionsTextIndex() {
+	transactions_text_index.clear();
+	transaction_text_keys.clear();
+	transaction_text_keys.reserve(transactions.count() + splitTransactions.count() + scheduledTransactions.count());
+	//the lists are not sorted by id, so the ids are appended and each posting sorted afterwards
+	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		indexTransactionText(*it, false);
+	}
+	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+		indexTransactionText(*it, false);
+	}
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+		indexTransactionText(*it, false);
+	}
+	for(QHash<quint64, QVector<qlonglong> >::iterator it = transactions_text_index.begin(); it != transactions_text_index.end(); ++it) {
+		std::sort(it->begin(), it->end());
+	}
+	b_transactions_text_index_valid = true;
+}
+void Budget::indexTransactionText(Transactions *trans, bool keep_sorted) {
+	QVector<quint64> &keys = transaction_text_keys[trans];
+	keys.clear();
+	add_transaction_text_keys(trans, keys);
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	qlonglong id = trans->id();
+	for(QVector<quint64>::const_iterator it = keys.constBegin(); it != keys.constEnd(); ++it) {
+		QVector<qlonglong> &posting = transactions_text_index[*it];
+		//new transactions have the highest ids and are usually appended
+		if(keep_sorted) posting.insert(std::lower_bound(posting.begin(), posting.end(), id), id);
+		else posting << id;
+	}
+}
+void Budget::unindexTransactionText(Transactions *trans) {
+	QHash<Transactions*, QVector<quint64> >::iterator it_index = transaction_text_keys.find(trans);
+	if(it_index == transaction_text_keys.end()) return;
+	qlonglong id = trans->id();
+	for(QVector<quint64>::const_iterator it = it_index->constBegin(); it != it_index->constEnd(); ++it) {
+		QHash<quint64, QVector<qlonglong> >::iterator it2 = transactions_text_index.find(*it);
+		if(it2 != transactions_text_index.end()) {
+			QVector<qlonglong>::iterator it_id = std::lower_bound(it2->begin(), it2->end(), id);
+			if(it_id != it2->end() && *it_id == id) it2->erase(it_id);
+			if(it2->isEmpty()) transactions_text_index.erase(it2);
+		}
+	}
+	transaction_text_keys.erase(it_index);
+}
+void Budget::reindexTransactionText(Transactions *trans) {
+	//splits include the text of their parts, and parts the tags of their split
+	if(trans->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE && ((Transaction*) trans)->parentSplit()) {
+		SplitTransaction *split = ((Transaction*) trans)->parentSplit();
+		if(transaction_text_keys.contains(split)) {
+			unindexTransactionText(split);
+			indexTransactionText(split);
+		}
+	} else if(trans->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		SplitTransaction *split = (SplitTransaction*) trans;
+		for(QVector<Transaction*>::const_iterator it = split->splits.constBegin(); it != split->splits.constEnd(); ++it) {
+			if(transaction_text_keys.contains(*it)) {
+				unindexTransactionText(*it);
+				indexTransactionText(*it);
+			}
+		}
+	}
+	//only transactions that are part of the budget are indexed
+	if(!transaction_text_keys.contains(trans)) return;
+	unindexTransactionText(trans);
+	indexTransactionText(trans);
+}
 
 void Budget::accountNameModified(Account *account) {
+	invalidateAccountNameIndex();
 	if(accounts.removeRef(account)) accounts.inSort(account);
 	switch(account->type()) {
 		case ACCOUNT_TYPE_EXPENSES: {
@@ -3032,6 +4732,11 @@ void Budget::accountNameModified(Account *account) {
 			assetsAccounts.setAutoDelete(false);
 			if(assetsAccounts.removeRef(aaccount)) assetsAccounts.inSort(aaccount);
 			assetsAccounts.setAutoDelete(true);
+			//the description of debt payments, fees and interests includes the name of the loan
+			for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+				if((*it)->type() == SPLIT_TRANSACTION_TYPE_LOAN && ((DebtPayment*) *it)->loan() == aaccount) (*it)->resetDescriptionSortKey();
+			}
+			invalidateTransactionsTextIndex();
 			break;
 		}
 	}
@@ -3041,12 +4746,15 @@ void Budget::addSecurity(Security *security) {
 	if(security->firstRevision() == 0) security->setFirstRevision(i_revision);
 	if(security->lastRevision() == 0) security->setLastRevision(i_revision);
 	securities.inSort(security);
+	invalidateSecurityNameIndex();
 	i_quotation_decimals = security->quotationDecimals();
 	i_share_decimals = security->decimals();
 	if(b_record_new_securities) newSecurities << security;
 }
 void Budget::setRecordNewSecurities(bool rns) {b_record_new_securities = rns;}
 void Budget::removeSecurity(Security *security, bool keep) {
+	finishLoading();
+	finishSaving();
 	if(securityHasTransactions(security)) {
 		for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = security->transactions.constBegin(); it != security->transactions.constEnd(); ++it) {
 			SecurityTransaction *trans = *it;
@@ -3077,11 +4785,23 @@ void Budget::removeSecurity(Security *security, bool keep) {
 		}
 		for(TradedSharesList<SecurityTrade*>::const_iterator it = security->tradedShares.constBegin(); it != security->tradedShares.constEnd(); ++it) {
 			SecurityTrade *ts = *it;
-			if(ts->to_security == security) ts->from_security->tradedShares.removeRef(ts);
-			else ts->to_security->tradedShares.removeRef(ts);
+			if(ts->to_security == security) {
+				ts->from_security->tradedShares.removeRef(ts);
+				ts->from_security->sharesModified();
+			} else {
+				ts->to_security->tradedShares.removeRef(ts);
+				ts->to_security->sharesModified();
+			}
 			securityTrades.removeRef(ts);
 		}
-	}
+		invalidateTransactionIdIndex();
+		invalidateAccountTransactionsIndex();
+		invalidateBudgetMonthAggregates();
+		invalidateTransactionsDuplicateIndex();
+		invalidateTransactionsTextIndex();
+		invalidateScheduleOccurrences();
+	}
+	invalidateSecurityNameIndex();
 	if(keep) securities.setAutoDelete(false);
 	securities.removeRef(security);
 	if(keep) securities.setAutoDelete(true);
@@ -3090,6 +4810,9 @@ bool Budget::securityHasTransactions(Security *security) {
 	return security->reinvestedDividends.count() > 0 || security->scheduledReinvestedDividends.count() > 0 || security->tradedShares.count() > 0 || security->transactions.count() > 0 || security->dividends.count() > 0 || security->scheduledTransactions.count() > 0 || security->scheduledDividends.count() > 0;
 }
 void Budget::securityNameModified(Security *security) {
+	invalidateSecurityNameIndex();
+	//descriptions of dividends and security transactions include the security name
+	invalidateTransactionsTextIndex();
 	securities.setAutoDelete(false);
 	if(securities.removeRef(security)) {
 		securities.inSort(security);
@@ -3097,11 +4820,20 @@ void Budget::securityNameModified(Security *security) {
 	securities.setAutoDelete(true);
 }
 Security *Budget::findSecurity(QString name) {
-	for(SecurityList<Security*>::const_iterator it = securities.constBegin(); it != securities.constEnd(); ++it) {
-		Security *sec = *it;
-		if(sec->name() == name) return sec;
+	if(!b_securities_name_index_valid) rebuildSecurityNameIndex();
+	return securities_name_index.value(name, NULL);
+}
+void Budget::invalidateSecurityNameIndex() {
+	b_securities_name_index_valid = false;
+	securities_name_index.clear();
+}
+void Budget::rebuildSecurityNameIndex() {
+	securities_name_index.clear();
+	securities_name_index.reserve(securities.count());
+	for(int i = securities.count() - 1; i >= 0; i--) {
+		securities_name_index.insert(securities.at(i)->name(), securities.at(i));
 	}
-	return NULL;
+	b_securities_name_index_valid = true;
 }
 
 int Budget::defaultShareDecimals() const {return i_share_decimals;}
@@ -3116,10 +4848,16 @@ void Budget::addSecurityTrade(SecurityTrade *ts) {
 	securityTrades.inSort(ts);
 	ts->from_security->tradedShares.inSort(ts);
 	ts->to_security->tradedShares.inSort(ts);
+	ts->from_security->sharesModified();
+	ts->to_security->sharesModified();
+	if(b_journal) journal_modified_ids.insert(ts->id);
 }
 void Budget::removeSecurityTrade(SecurityTrade *ts, bool keep) {
+	if(b_journal) journal_removed_ids.insert(ts->id);
 	ts->from_security->tradedShares.removeRef(ts);
 	ts->to_security->tradedShares.removeRef(ts);
+	ts->from_security->sharesModified();
+	ts->to_security->sharesModified();
 	ts->from_security->removeQuotation(ts->date, true);
 	ts->to_security->removeQuotation(ts->date, true);
 	if(keep) securityTrades.setAutoDelete(false);
@@ -3127,6 +4865,7 @@ void Budget::removeSecurityTrade(SecurityTrade *ts, bool keep) {
 	if(keep) securityTrades.setAutoDelete(true);
 }
 void Budget::securityTradeDateModified(SecurityTrade *ts, const QDate &olddate) {
+	if(b_journal) journal_modified_ids.insert(ts->id);
 	securityTrades.setAutoDelete(false);
 	if(securityTrades.removeRef(ts)) {
 		securityTrades.inSort(ts);
@@ -3138,48 +4877,66 @@ void Budget::securityTradeDateModified(SecurityTrade *ts, const QDate &olddate)
 	if(ts->to_security->tradedShares.removeRef(ts)) {
 		ts->to_security->tradedShares.inSort(ts);
 	}
+	ts->from_security->sharesModified();
+	ts->to_security->sharesModified();
 	ts->from_security->removeQuotation(olddate, true);
 	ts->to_security->removeQuotation(olddate, true);
 }
-Account *Budget::findAccount(QString name) {
-	for(AccountList<Account*>::const_iterator it = accounts.constBegin(); it != accounts.constEnd(); ++it) {
-		Account *account = *it;
-		if(account->name() == name) return account;
+void Budget::invalidateAccountNameIndex() {
+	b_accounts_name_index_valid = false;
+	accounts_name_index.clear();
+	assetsAccounts_name_index.clear();
+	incomesAccounts_name_index.clear();
+	expensesAccounts_name_index.clear();
+}
+void Budget::rebuildAccountNameIndex() {
+	invalidateAccountNameIndex();
+	//inserted in reverse order, so that value() returns the first account in the list with the name
+	for(int i = accounts.count() - 1; i >= 0; i--) {
+		accounts_name_index.insert(accounts.at(i)->name(), accounts.at(i));
 	}
-	return NULL;
+	for(int i = assetsAccounts.count() - 1; i >= 0; i--) {
+		assetsAccounts_name_index.insert(assetsAccounts.at(i)->name(), assetsAccounts.at(i));
+	}
+	for(int i = incomesAccounts.count() - 1; i >= 0; i--) {
+		incomesAccounts_name_index.insert(incomesAccounts.at(i)->name(), incomesAccounts.at(i));
+	}
+	for(int i = expensesAccounts.count() - 1; i >= 0; i--) {
+		expensesAccounts_name_index.insert(expensesAccounts.at(i)->name(), expensesAccounts.at(i));
+	}
+	b_accounts_name_index_valid = true;
+}
+Account *Budget::findAccount(QString name) {
+	if(!b_accounts_name_index_valid) rebuildAccountNameIndex();
+	return accounts_name_index.value(name, NULL);
 }
 AssetsAccount *Budget::findAssetsAccount(QString name) {
-	for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
-		AssetsAccount *account = *it;
-		if(account->name() == name) return account;
-	}
-	return NULL;
+	if(!b_accounts_name_index_valid) rebuildAccountNameIndex();
+	return assetsAccounts_name_index.value(name, NULL);
 }
 IncomesAccount *Budget::findIncomesAccount(QString name) {
-	for(AccountList<IncomesAccount*>::const_iterator it = incomesAccounts.constBegin(); it != incomesAccounts.constEnd(); ++it) {
-		IncomesAccount *account = *it;
-		if(account->name() == name) return account;
-	}
-	return NULL;
+	if(!b_accounts_name_index_valid) rebuildAccountNameIndex();
+	return incomesAccounts_name_index.value(name, NULL);
 }
 ExpensesAccount *Budget::findExpensesAccount(QString name) {
-	for(AccountList<ExpensesAccount*>::const_iterator it = expensesAccounts.constBegin(); it != expensesAccounts.constEnd(); ++it) {
-		ExpensesAccount *account = *it;
-		if(account->name() == name) return account;
-	}
-	return NULL;
+	if(!b_accounts_name_index_valid) rebuildAccountNameIndex();
+	return expensesAccounts_name_index.value(name, NULL);
 }
 IncomesAccount *Budget::findIncomesAccount(QString name, CategoryAccount *parent_acc) {
-	for(AccountList<IncomesAccount*>::const_iterator it = incomesAccounts.constBegin(); it != incomesAccounts.constEnd(); ++it) {
-		IncomesAccount *account = *it;
-		if(account->name() == name && account->parentCategory() == parent_acc) return account;
+	if(!b_accounts_name_index_valid) rebuildAccountNameIndex();
+	QMultiHash<QString, IncomesAccount*>::const_iterator it = incomesAccounts_name_index.constFind(name);
+	while(it != incomesAccounts_name_index.constEnd() && it.key() == name) {
+		if((*it)->parentCategory() == parent_acc) return *it;
+		++it;
 	}
 	return NULL;
 }
 ExpensesAccount *Budget::findExpensesAccount(QString name, CategoryAccount *parent_acc) {
-	for(AccountList<ExpensesAccount*>::const_iterator it = expensesAccounts.constBegin(); it != expensesAccounts.constEnd(); ++it) {
-		ExpensesAccount *account = *it;
-		if(account->name() == name && account->parentCategory() == parent_acc) return account;
+	if(!b_accounts_name_index_valid) rebuildAccountNameIndex();
+	QMultiHash<QString, ExpensesAccount*>::const_iterator it = expensesAccounts_name_index.constFind(name);
+	while(it != expensesAccounts_name_index.constEnd() && it.key() == name) {
+		if((*it)->parentCategory() == parent_acc) return *it;
+		++it;
 	}
 	return NULL;
 }
@@ -3213,19 +4970,41 @@ bool Budget::currenciesModified() {return b_currency_modified;}
 void Budget::resetCurrenciesModified() {b_currency_modified = false;}
 void Budget::addCurrency(Currency *cur) {
 	currencies.inSort(cur);
+	invalidateCurrencyCodeIndex();
 }
 void Budget::currencyModified(Currency*) {
 	b_currency_modified = true;
 }
+void Budget::currencyCodeModified(Currency*) {
+	invalidateCurrencyCodeIndex();
+}
 void Budget::removeCurrency(Currency *cur) {
+	invalidateCurrencyCodeIndex();
+	default_currency_converters.remove(cur);
 	currencies.removeRef(cur);
 }
-Currency *Budget::findCurrency(QString code) {
-	for(CurrencyList<Currency*>::const_iterator it = currencies.constBegin(); it != currencies.constEnd(); ++it) {
-		Currency *cur = *it;
-		if(cur->code() == code) return cur;
+CurrencyConverter &Budget::defaultCurrencyConverter(const Currency *from) {
+	QHash<const Currency*, CurrencyConverter>::iterator it = default_currency_converters.find(from);
+	if(it == default_currency_converters.end() || it.value().toCurrency() != default_currency) {
+		it = default_currency_converters.insert(from, CurrencyConverter(from, default_currency));
 	}
-	return NULL;
+	return it.value();
+}
+void Budget::invalidateCurrencyCodeIndex() {
+	b_currencies_code_index_valid = false;
+	currencies_code_index.clear();
+}
+void Budget::rebuildCurrencyCodeIndex() {
+	currencies_code_index.clear();
+	currencies_code_index.reserve(currencies.count());
+	for(int i = currencies.count() - 1; i >= 0; i--) {
+		currencies_code_index.insert(currencies.at(i)->code(), currencies.at(i));
+	}
+	b_currencies_code_index_valid = true;
+}
+Currency *Budget::findCurrency(QString code) {
+	if(!b_currencies_code_index_valid) rebuildCurrencyCodeIndex();
+	return currencies_code_index.value(code, NULL);
 }
 Currency *Budget::findCurrencySymbol(QString symbol, bool require_unique)  {
 	Currency *found_cur = NULL;
@@ -3253,6 +5032,10 @@ bool Budget::usesMultipleCurrencies() {
 
 void Budget::setBudgetDay(int day_of_month) {
 	if(day_of_month <= 28 && day_of_month >= -26) {
+		if(day_of_month != i_budget_day) {
+			invalidateBudgetMonthAggregates();
+			invalidateBudgetPeriods();
+		}
 		i_budget_day = day_of_month;
 		if(i_budget_day < 1 || i_budget_day > 7) i_budget_week = 0;
 	}
@@ -3260,12 +5043,21 @@ void Budget::setBudgetDay(int day_of_month) {
 int Budget::budgetDay() const {return i_budget_day;}
 void Budget::setBudgetWeek(int week_of_month) {
 	if(week_of_month <= 4 && week_of_month >= -3) {
+		if(week_of_month != i_budget_week) {
+			invalidateBudgetMonthAggregates();
+			invalidateBudgetPeriods();
+		}
 		i_budget_week = week_of_month;
 		if(i_budget_week != 0 && (i_budget_day < 1 || i_budget_day > 7)) i_budget_day = 1;
 	}
 }
 int Budget::budgetWeek() const {return i_budget_week;}
-void Budget::setBudgetMonth(int month_of_year) {if(month_of_year <= 12 && month_of_year >= 1) i_budget_month = month_of_year;}
+void Budget::setBudgetMonth(int month_of_year) {
+	if(month_of_year <= 12 && month_of_year >= 1) {
+		if(month_of_year != i_budget_month) invalidateBudgetPeriods();
+		i_budget_month = month_of_year;
+	}
+}
 int Budget::budgetMonth() const {return i_budget_month;}
 
 bool isLeapYear(long int year) {
@@ -3332,7 +5124,61 @@ QDate nthWeekdayOfMonth(QDate date, int day, int week) {
 	return date;
 }
 
+#define BUDGET_PERIODS_YEARS_BEFORE 2
+#define BUDGET_PERIODS_YEARS_AFTER 10
+
+void Budget::invalidateBudgetPeriods() {
+	b_budget_periods_valid = false;
+	budget_periods.clear();
+	budget_period_index.clear();
+}
+void Budget::rebuildBudgetPeriods() const {
+	budget_periods.clear();
+	budget_period_index.clear();
+	budget_periods_day = i_budget_day;
+	budget_periods_week = i_budget_week;
+	budget_periods_month = i_budget_month;
+	//the index is empty until the table is complete, so the lookups below fall back to calculation
+	b_budget_periods_valid = true;
+	QDate first_date = QDate::currentDate(), last_date = first_date;
+	if(!transactions.isEmpty()) {
+		if(transactions.first()->date() < first_date) first_date = transactions.first()->date();
+		if(transactions.last()->date() > last_date) last_date = transactions.last()->date();
+	}
+	first_date = firstBudgetDay(first_date.addYears(-BUDGET_PERIODS_YEARS_BEFORE));
+	last_date = lastBudgetDay(last_date.addYears(BUDGET_PERIODS_YEARS_AFTER));
+	budget_periods_first_day = first_date.toJulianDay();
+	QVector<int> index;
+	index.reserve(first_date.daysTo(last_date) + 1);
+	budget_periods.reserve((int) (first_date.daysTo(last_date) / 28) + 1);
+	QDate date = first_date;
+	while(date <= last_date) {
+		BudgetPeriod period;
+		period.first_day = date;
+		period.last_day = lastBudgetDay(date);
+		period.year = budgetYear(date);
+		period.month = budgetMonth(date);
+		for(qint64 i = date.daysTo(period.last_day); i >= 0; i--) index << budget_periods.count();
+		budget_periods << period;
+		date = period.last_day.addDays(1);
+	}
+	budget_period_index = index;
+}
+const BudgetPeriod *Budget::budgetPeriod(const QDate &date) const {
+	//calendar months are cheap to calculate (and are temporarily selected by averageMonth() and similar functions)
+	if(i_budget_day == 1 && i_budget_week == 0) return NULL;
+	if(!b_budget_periods_valid || budget_periods_day != i_budget_day || budget_periods_week != i_budget_week) rebuildBudgetPeriods();
+	qint64 i = date.toJulianDay() - budget_periods_first_day;
+	if(i < 0 || i >= budget_period_index.count()) return NULL;
+	return &budget_periods.at(budget_period_index.at(i));
+}
+
 bool Budget::isSameBudgetMonth(const QDate &date1, const QDate &date2) const {
+	const BudgetPeriod *period1 = budgetPeriod(date1);
+	if(period1) {
+		const BudgetPeriod *period2 = budgetPeriod(date2);
+		if(period2) return period1 == period2;
+	}
 	return budgetYear(date1) == budgetYear(date2) && budgetMonth(date1) == budgetMonth(date2);
 }
 int Budget::daysInBudgetMonth(const QDate &date) const {
@@ -3342,6 +5188,8 @@ int Budget::daysInBudgetMonth(const QDate &date) const {
 		if(date.day() >= i_budget_day) return date.daysInMonth();
 		return date.addMonths(-1).daysInMonth();
 	} else {
+		const BudgetPeriod *period = budgetPeriod(date);
+		if(period) return period->first_day.daysTo(period->last_day) + 1;
 		return firstBudgetDay(date).daysTo(lastBudgetDay(date)) + 1;
 	}
 }
@@ -3358,9 +5206,13 @@ int Budget::dayOfBudgetYear(const QDate &date) const {
 }
 int Budget::dayOfBudgetMonth(const QDate &date) const {
 	if(i_budget_day == 1 && i_budget_week == 0) return date.day();
+	const BudgetPeriod *period = budgetPeriod(date);
+	if(period) return period->first_day.daysTo(date) + 1;
 	return firstBudgetDay(date).daysTo(date) + 1;
 }
 int Budget::budgetMonth(const QDate &date) const {
+	const BudgetPeriod *period = budgetPeriod(date);
+	if(period) return period->month;
 	if(i_budget_week != 0) {
 		QDate d = nthWeekdayOfMonth(date, i_budget_day, i_budget_week);
 		if(i_budget_week > 2 || (i_budget_week < 0 && i_budget_week >= -2)) {
@@ -3392,6 +5244,8 @@ int Budget::budgetMonth(const QDate &date) const {
 }
 int Budget::budgetYear(const QDate &date) const {
 	if(i_budget_day == 1 && i_budget_month == 1 && i_budget_week == 0) return date.year();
+	const BudgetPeriod *period = budgetPeriod(date);
+	if(period && budget_periods_month == i_budget_month) return period->year;
 	int year = date.year();
 	if(i_budget_week != 0) {
 		if(i_budget_week > 2 || (i_budget_week < 0 && i_budget_week >= -2)) {
@@ -3539,6 +5393,8 @@ QDate Budget::budgetDateToMonth(QDate date) const {
 	return date;
 }
 QDate Budget::firstBudgetDay(QDate date) const {
+	const BudgetPeriod *period = budgetPeriod(date);
+	if(period) return period->first_day;
 	if(i_budget_week != 0) {
 		QDate d = nthWeekdayOfMonth(date, i_budget_day, i_budget_week);
 		if(d > date) {
@@ -3557,6 +5413,8 @@ QDate Budget::firstBudgetDay(QDate date) const {
 	return date;
 }
 QDate Budget::lastBudgetDay(QDate date) const {
+	const BudgetPeriod *period = budgetPeriod(date);
+	if(period) return period->last_day;
 	if(i_budget_week != 0) {
 		QDate d = nthWeekdayOfMonth(date, i_budget_day, i_budget_week);
 		d = d.addDays(-1);
@@ -3813,32 +5671,722 @@ bool Budget::accountTypeIsOther(int at_type) {
 void Budget::tagAdded(const QString &tag) {
 	tags << tag;
 	tags.sort(Qt::CaseInsensitive);
+	if(b_tags_index_valid) {
+		QString key = tag.toCaseFolded();
+		if(!tags_index.contains(key)) tags_index.insert(key, tag);
+	}
 	if(b_record_new_tags) newTags << tag;
 }
 void Budget::tagRemoved(const QString &tag) {
 	tags.removeAll(tag);
+	if(b_tags_index_valid && tags_index.value(tag.toCaseFolded()) == tag) invalidateTagIndex();
 }
-QString Budget::findTag(const QString &tag) {
-	for(int i = 0; i < tags.count(); i++) {
-		int c = tags[i].compare(tag, Qt::CaseInsensitive);
-		if(c > 0) break;
-		if(c == 0) return tags[i];
+void Budget::invalidateTagIndex() {
+	b_tags_index_valid = false;
+	tags_index.clear();
+}
+void Budget::rebuildTagIndex() {
+	tags_index.clear();
+	tags_index.reserve(tags.count());
+	for(int i = tags.count() - 1; i >= 0; i--) {
+		tags_index.insert(tags[i].toCaseFolded(), tags[i]);
 	}
-	return QString();
+	b_tags_index_valid = true;
+}
+QString Budget::findTag(const QString &tag) {
+	if(!b_tags_index_valid) rebuildTagIndex();
+	return tags_index.value(tag.toCaseFolded());
 }
 void Budget::setRecordNewTags(bool rnt) {b_record_new_tags = rnt;}
 
-Transactions *Budget::getTransaction(qlonglong lid) {
+void Budget::invalidateTransactionIdIndex() {
+	b_transactions_id_index_valid = false;
+	transactions_id_index.clear();
+}
+void Budget::rebuildTransactionIdIndex() {
+	transactions_id_index.clear();
+	transactions_id_index.reserve(transactions.count() + splitTransactions.count() + scheduledTransactions.count() * 2);
 	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
-		if((*it)->id() == lid) return *it;
+		transactions_id_index.insert((*it)->id(), *it);
 	}
-	for(TransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
-		if((*it)->id() == lid) return *it;
+	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+		transactions_id_index.insert((*it)->id(), *it);
 	}
-	for(TransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
-		if((*it)->id() == lid) return *it;
-		if((*it)->transaction() && (*it)->transaction()->id() == lid) return *it;
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+		transactions_id_index.insert((*it)->id(), *it);
+		if((*it)->transaction()) transactions_id_index.insert((*it)->transaction()->id(), *it);
 	}
-	return NULL;
+	b_transactions_id_index_valid = true;
+}
+void Budget::transactionModified(Transactions *transs) {
+	if(inParseThread()) return;
+	if(b_transactions_text_index_valid) reindexTransactionText(transs);
+	//tags are modified in place
+	if(b_budget_month_aggregates_valid) {
+		if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+			reaggregateTransaction((Transaction*) transs);
+		} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+			SplitTransaction *split = (SplitTransaction*) transs;
+			for(QVector<Transaction*>::const_iterator it = split->splits.constBegin(); it != split->splits.constEnd(); ++it) reaggregateTransaction(*it);
+		}
+	}
+	journalTransaction(transs);
+}
+void Budget::journalTransaction(Transactions *transs) {
+	//modified transactions are written to the journal by the next incremental save
+	if(!b_journal || inParseThread()) return;
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		journal_modified_ids.insert(transs->id());
+	} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+		if(((Transaction*) transs)->parentSplit()) journal_modified_ids.insert(((Transaction*) transs)->parentSplit()->id());
+		else journal_modified_ids.insert(transs->id());
+	}
+}
+void Budget::transactionIdModified(Transactions *trans, qlonglong old_id) {
+	if(inParseThread()) return;
+	if(b_transactions_text_index_valid && old_id != trans->id()) {
+		//the text index refers to transactions by id
+		QHash<Transactions*, QVector<quint64> >::const_iterator it_keys = transaction_text_keys.constFind(trans);
+		if(it_keys != transaction_text_keys.constEnd()) {
+			for(QVector<quint64>::const_iterator it = it_keys->constBegin(); it != it_keys->constEnd(); ++it) {
+				QVector<qlonglong> &posting = transactions_text_index[*it];
+				QVector<qlonglong>::iterator it_id = std::lower_bound(posting.begin(), posting.end(), old_id);
+				if(it_id != posting.end() && *it_id == old_id) posting.erase(it_id);
+				posting.insert(std::lower_bound(posting.begin(), posting.end(), trans->id()), trans->id());
+			}
+		}
+	}
+	if(b_journal && old_id != trans->id()) {
+		journal_removed_ids.insert(old_id);
+		transactionModified(trans);
+	}
+	if(!b_transactions_id_index_valid || old_id == trans->id()) return;
+	if(transactions_id_index.remove(old_id, trans) > 0) {
+		transactions_id_index.insert(trans->id(), trans);
+		return;
+	}
+	//the transaction of a schedule is indexed with the schedule as value
+	QMultiHash<qlonglong, Transactions*>::iterator it = transactions_id_index.find(old_id);
+	while(it != transactions_id_index.end() && it.key() == old_id) {
+		if((*it)->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE && ((ScheduledTransaction*) *it)->transaction() == trans) {
+			Transactions *strans = *it;
+			transactions_id_index.erase(it);
+			transactions_id_index.insert(trans->id(), strans);
+			return;
+		}
+		++it;
+	}
+}
+void Budget::invalidateAccountTransactionsIndex() {
+	b_account_transactions_index_valid = false;
+	account_transactions_index.clear();
+	transaction_accounts_index.clear();
+	account_balance_index.clear();
+	transaction_balance_changes.clear();
+}
+void Budget::rebuildAccountTransactionsIndex() {
+	account_transactions_index.clear();
+	transaction_accounts_index.clear();
+	account_balance_index.clear();
+	transaction_balance_changes.clear();
+	transaction_accounts_index.reserve(transactions.count() + scheduledTransactions.count());
+	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		if(!(*it)->parentSplit()) indexTransactionAccounts(*it);
+	}
+	for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+		indexTransactionAccounts(*it);
+	}
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+		indexTransactionAccounts(*it);
+	}
+	b_account_transactions_index_valid = true;
+}
+void Budget::indexTransactionAccounts(Transactions *trans) {
+	QVector<Account*> &accounts = transaction_accounts_index[trans];
+	trans->relatedAccounts(accounts);
+	for(QVector<Account*>::const_iterator it = accounts.constBegin(); it != accounts.constEnd(); ++it) {
+		account_transactions_index[*it].insert(trans);
+	}
+	addTransactionBalanceChanges(trans);
+}
+void Budget::unindexTransactionAccounts(Transactions *trans) {
+	QHash<Transactions*, QVector<Account*> >::iterator it_index = transaction_accounts_index.find(trans);
+	if(it_index == transaction_accounts_index.end()) return;
+	for(QVector<Account*>::const_iterator it = it_index->constBegin(); it != it_index->constEnd(); ++it) {
+		QHash<Account*, QSet<Transactions*> >::iterator it2 = account_transactions_index.find(*it);
+		if(it2 != account_transactions_index.end()) {
+			it2->remove(trans);
+			if(it2->isEmpty()) account_transactions_index.erase(it2);
+		}
+	}
+	transaction_accounts_index.erase(it_index);
+	removeTransactionBalanceChanges(trans);
+}
+void Budget::transactionAccountsModified(Transactions *trans) {
+	if(inParseThread()) return;
+	transactionModified(trans);
+	if(b_budget_month_aggregates_valid || b_transactions_duplicate_index_valid) {
+		if(trans->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+			reaggregateTransaction((Transaction*) trans);
+			reindexTransactionDuplicateKey((Transaction*) trans);
+		} else if(trans->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+			SplitTransaction *split = (SplitTransaction*) trans;
+			for(QVector<Transaction*>::const_iterator it = split->splits.constBegin(); it != split->splits.constEnd(); ++it) {
+				reaggregateTransaction(*it);
+				reindexTransactionDuplicateKey(*it);
+			}
+		}
+	}
+	if(!b_account_transactions_index_valid) return;
+	//transactions are indexed as whole splits and schedules
+	if(trans->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE && ((Transaction*) trans)->parentSplit()) trans = ((Transaction*) trans)->parentSplit();
+	if(!transaction_accounts_index.contains(trans)) {
+		//the transaction of a schedule is indexed with the schedule as value
+		if(!b_transactions_id_index_valid) rebuildTransactionIdIndex();
+		Transactions *strans = NULL;
+		QMultiHash<qlonglong, Transactions*>::const_iterator it = transactions_id_index.constFind(trans->id());
+		while(it != transactions_id_index.constEnd() && it.key() == trans->id()) {
+			if((*it)->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE && ((ScheduledTransaction*) *it)->transaction() == trans) {
+				strans = *it;
+				break;
+			}
+			++it;
+		}
+		//not part of the budget (yet)
+		if(!strans) return;
+		trans = strans;
+	}
+	unindexTransactionAccounts(trans);
+	indexTransactionAccounts(trans);
+}
+void Budget::securityAccountModified(Security *security) {
+	if(!b_account_transactions_index_valid) return;
+	for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = security->transactions.constBegin(); it != security->transactions.constEnd(); ++it) {
+		transactionAccountsModified(*it);
+	}
+	for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = security->scheduledTransactions.constBegin(); it != security->scheduledTransactions.constEnd(); ++it) {
+		transactionAccountsModified(*it);
+	}
+}
+void Budget::transactionValueModified(Transaction *trans) {
+	if(inParseThread()) return;
+	transactionModified(trans);
+	reaggregateTransaction(trans);
+	reindexTransactionDuplicateKey(trans);
+	rebalanceTransaction(trans);
+}
+void Budget::transactionSharesModified(Transaction *trans) {
+	if(inParseThread()) return;
+	Security *security = NULL;
+	if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) security = ((SecurityTransaction*) trans)->security();
+	else if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) security = ((ReinvestedDividend*) trans)->security();
+	if(security) security->sharesModified();
+}
+void Budget::transactionQuantityModified(Transaction *trans) {
+	if(inParseThread()) return;
+	transactionModified(trans);
+	reaggregateTransaction(trans);
+}
+void Budget::accountCurrencyModified(AssetsAccount*) {
+	//aggregates are keyed by transaction currency
+	invalidateBudgetMonthAggregates();
+}
+void add_month_aggregate(BudgetMonthAggregate &aggregate, const TransactionAggregateEntry &entry) {
+	if(entry.b_from) aggregate.value_from += entry.value;
+	else aggregate.value_to += entry.value;
+	aggregate.quantity += entry.quantity;
+	aggregate.count++;
+}
+void subtract_month_aggregate(QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > &months, const TransactionAggregateEntry &entry) {
+	QMap<QDate, QHash<Currency*, BudgetMonthAggregate> >::iterator it_month = months.find(entry.month);
+	if(it_month == months.end()) return;
+	QHash<Currency*, BudgetMonthAggregate>::iterator it_cur = it_month->find(entry.currency);
+	if(it_cur != it_month->end()) {
+		if(entry.b_from) it_cur->value_from -= entry.value;
+		else it_cur->value_to -= entry.value;
+		it_cur->quantity -= entry.quantity;
+		it_cur->count--;
+		if(it_cur->count <= 0) it_month->erase(it_cur);
+	}
+	if(it_month->isEmpty()) months.erase(it_month);
+}
+void Budget::invalidateBudgetMonthAggregates() {
+	b_budget_month_aggregates_valid = false;
+	budget_month_aggregates.clear();
+	budget_month_tag_aggregates.clear();
+	transaction_aggregates.clear();
+}
+void Budget::rebuildBudgetMonthAggregates() {
+	budget_month_aggregates.clear();
+	budget_month_tag_aggregates.clear();
+	transaction_aggregates.clear();
+	transaction_aggregates.reserve(transactions.count());
+	for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		aggregateTransaction(*it);
+	}
+	b_budget_month_aggregates_valid = true;
+}
+void Budget::aggregateTransaction(Transaction *trans) {
+	TransactionAggregateEntry &entry = transaction_aggregates[trans];
+	entry.category = NULL;
+	if(trans->fromAccount()->type() != ACCOUNT_TYPE_ASSETS) {
+		entry.category = trans->fromAccount();
+		entry.b_from = true;
+	} else if(trans->toAccount()->type() != ACCOUNT_TYPE_ASSETS) {
+		entry.category = trans->toAccount();
+		entry.b_from = false;
+	} else {
+		return;
+	}
+	entry.month = firstBudgetDay(trans->date());
+	entry.currency = trans->currency();
+	entry.value = trans->value();
+	entry.quantity = trans->quantity();
+	add_month_aggregate(budget_month_aggregates[entry.category][entry.month][entry.currency], entry);
+	//tags (including those of the parent split) of transactions with a category
+	for(int i = 0; ; i++) {
+		const QString &tag = trans->getTag(i, true);
+		if(tag.isEmpty()) break;
+		entry.tags << tag;
+		add_month_aggregate(budget_month_tag_aggregates[tag][entry.month][entry.currency], entry);
+	}
+}
+void Budget::unaggregateTransaction(Transaction *trans) {
+	QHash<Transaction*, TransactionAggregateEntry>::iterator it_entry = transaction_aggregates.find(trans);
+	if(it_entry == transaction_aggregates.end()) return;
+	if(it_entry->category) {
+		QHash<Account*, QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > >::iterator it_cat = budget_month_aggregates.find(it_entry->category);
+		if(it_cat != budget_month_aggregates.end()) {
+			subtract_month_aggregate(*it_cat, *it_entry);
+			if(it_cat->isEmpty()) budget_month_aggregates.erase(it_cat);
+		}
+		for(QStringList::const_iterator it = it_entry->tags.constBegin(); it != it_entry->tags.constEnd(); ++it) {
+			QHash<QString, QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > >::iterator it_tag = budget_month_tag_aggregates.find(*it);
+			if(it_tag != budget_month_tag_aggregates.end()) {
+				subtract_month_aggregate(*it_tag, *it_entry);
+				if(it_tag->isEmpty()) budget_month_tag_aggregates.erase(it_tag);
+			}
+		}
+	}
+	transaction_aggregates.erase(it_entry);
+}
+void Budget::reaggregateTransaction(Transaction *trans) {
+	//only transactions that are part of the budget have an entry
+	if(!b_budget_month_aggregates_valid || !transaction_aggregates.contains(trans)) return;
+	unaggregateTransaction(trans);
+	aggregateTransaction(trans);
+}
+bool Budget::budgetMonthAggregatesAreExact() {
+	//values converted at the transaction date cannot be summed before conversion
+	if(i_tcrd != TRANSACTION_CONVERSION_RATE_AT_DATE) return true;
+	for(AccountList<AssetsAccount*>::const_iterator it = assetsAccounts.constBegin(); it != assetsAccounts.constEnd(); ++it) {
+		if((*it)->currency() && (*it)->currency() != default_currency) return false;
+	}
+	return true;
+}
+void sum_month_aggregates(const QHash<Currency*, BudgetMonthAggregate> &currencies, BudgetMonthAggregate &aggregate, Currency *default_currency) {
+	for(QHash<Currency*, BudgetMonthAggregate>::const_iterator it_cur = currencies.constBegin(); it_cur != currencies.constEnd(); ++it_cur) {
+		Currency *cur = it_cur.key();
+		if(cur && cur != default_currency) {
+			aggregate.value_from += cur->convertTo(it_cur->value_from, default_currency);
+			aggregate.value_to += cur->convertTo(it_cur->value_to, default_currency);
+		} else {
+			aggregate.value_from += it_cur->value_from;
+			aggregate.value_to += it_cur->value_to;
+		}
+		aggregate.quantity += it_cur->quantity;
+		aggregate.count += it_cur->count;
+	}
+}
+void Budget::getBudgetMonthAggregates(const QDate &first_month, const QDate &last_month, QMap<QDate, QHash<Account*, BudgetMonthAggregate> > &aggregates) {
+	if(!b_budget_month_aggregates_valid) rebuildBudgetMonthAggregates();
+	for(QHash<Account*, QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > >::const_iterator it_cat = budget_month_aggregates.constBegin(); it_cat != budget_month_aggregates.constEnd(); ++it_cat) {
+		for(QMap<QDate, QHash<Currency*, BudgetMonthAggregate> >::const_iterator it_month = it_cat->lowerBound(first_month); it_month != it_cat->constEnd() && it_month.key() <= last_month; ++it_month) {
+			sum_month_aggregates(*it_month, aggregates[it_month.key()][it_cat.key()], default_currency);
+		}
+	}
+}
+void Budget::getBudgetMonthTagAggregates(const QDate &first_month, const QDate &last_month, QMap<QDate, QHash<QString, BudgetMonthAggregate> > &aggregates) {
+	//values of tagged transactions with a category; value_from is from incomes and value_to to expenses, as for categories
+	if(!b_budget_month_aggregates_valid) rebuildBudgetMonthAggregates();
+	for(QHash<QString, QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > >::const_iterator it_tag = budget_month_tag_aggregates.constBegin(); it_tag != budget_month_tag_aggregates.constEnd(); ++it_tag) {
+		for(QMap<QDate, QHash<Currency*, BudgetMonthAggregate> >::const_iterator it_month = it_tag->lowerBound(first_month); it_month != it_tag->constEnd() && it_month.key() <= last_month; ++it_month) {
+			sum_month_aggregates(*it_month, aggregates[it_month.key()][it_tag.key()], default_currency);
+		}
+	}
+}
+void Budget::accountBalanceModified(Account *account) {
+	//only used for removed accounts; the balance changes of their transactions have already been removed
+	if(account && account->type() == ACCOUNT_TYPE_ASSETS) account_balance_index.remove((AssetsAccount*) account);
+}
+void add_balance_change(Transaction *trans, AssetsAccount *account, QVector<AccountBalanceChange> &changes) {
+	double value = trans->accountChange(account, false, false);
+	if(value == 0.0) return;
+	AccountBalanceChange change;
+	change.account = account;
+	change.day = trans->date().toJulianDay();
+	change.value = value;
+	changes << change;
+}
+void add_balance_changes(Transactions *transs, AssetsAccount *account, QVector<AccountBalanceChange> &changes) {
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+		add_balance_change((Transaction*) transs, account, changes);
+	} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		SplitTransaction *split = (SplitTransaction*) transs;
+		int c = split->count();
+		for(int i = 0; i < c; i++) add_balance_change(split->at(i), account, changes);
+	}
+}
+const AccountBalanceTimeline &Budget::accountBalanceTimeline(AssetsAccount *account) {
+	if(!b_account_transactions_index_valid) rebuildAccountTransactionsIndex();
+	QHash<AssetsAccount*, AccountBalanceTimeline>::const_iterator it_timeline = account_balance_index.constFind(account);
+	if(it_timeline != account_balance_index.constEnd()) return *it_timeline;
+	//the changes are recorded for each transaction, so that they can be subtracted after the transaction has been modified
+	QMap<qint64, double> changes;
+	QVector<AccountBalanceChange> trans_changes;
+	QHash<Account*, QSet<Transactions*> >::const_iterator it_index = account_transactions_index.constFind(account);
+	if(it_index != account_transactions_index.constEnd()) {
+		for(QSet<Transactions*>::const_iterator it = it_index->constBegin(); it != it_index->constEnd(); ++it) {
+			Transactions *transs = *it;
+			trans_changes.clear();
+			add_balance_changes(transs, account, trans_changes);
+			if(trans_changes.isEmpty()) continue;
+			for(QVector<AccountBalanceChange>::const_iterator it2 = trans_changes.constBegin(); it2 != trans_changes.constEnd(); ++it2) changes[it2->day] += it2->value;
+			transaction_balance_changes[transs] += trans_changes;
+		}
+	}
+	AccountBalanceTimeline &timeline = account_balance_index[account];
+	timeline.days.reserve(changes.count());
+	timeline.balances.reserve(changes.count());
+	double balance = 0.0;
+	for(QMap<qint64, double>::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it) {
+		balance += it.value();
+		timeline.days << it.key();
+		timeline.balances << balance;
+	}
+	return timeline;
+}
+void Budget::changeAccountBalance(AssetsAccount *account, qint64 julian_day, double value) {
+	//updates the balances from the day onward
+	QHash<AssetsAccount*, AccountBalanceTimeline>::iterator it_timeline = account_balance_index.find(account);
+	if(it_timeline == account_balance_index.end()) return;
+	AccountBalanceTimeline &timeline = *it_timeline;
+	int i = std::lower_bound(timeline.days.constBegin(), timeline.days.constEnd(), julian_day) - timeline.days.constBegin();
+	if(i == timeline.days.count() || timeline.days.at(i) != julian_day) {
+		timeline.days.insert(i, julian_day);
+		timeline.balances.insert(i, i > 0 ? timeline.balances.at(i - 1) : 0.0);
+	}
+	int n = timeline.balances.count();
+	double *balances = timeline.balances.data();
+	for(; i < n; i++) balances[i] += value;
+}
+void Budget::addTransactionBalanceChanges(Transactions *transs) {
+	//only accounts with a timeline are updated, with the indexed accounts of the transaction as when the timeline is built
+	if(account_balance_index.isEmpty()) return;
+	QHash<Transactions*, QVector<Account*> >::const_iterator it_index = transaction_accounts_index.constFind(transs);
+	if(it_index == transaction_accounts_index.constEnd()) return;
+	QVector<AccountBalanceChange> changes;
+	for(QVector<Account*>::const_iterator it = it_index->constBegin(); it != it_index->constEnd(); ++it) {
+		Account *account = *it;
+		if(account->type() != ACCOUNT_TYPE_ASSETS || !account_balance_index.contains((AssetsAccount*) account)) continue;
+		//an account might be listed more than once
+		if(std::find(it_index->constBegin(), it, account) != it) continue;
+		add_balance_changes(transs, (AssetsAccount*) account, changes);
+	}
+	if(changes.isEmpty()) return;
+	for(QVector<AccountBalanceChange>::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it) changeAccountBalance(it->account, it->day, it->value);
+	transaction_balance_changes[transs] += changes;
+}
+void Budget::removeTransactionBalanceChanges(Transactions *transs) {
+	QHash<Transactions*, QVector<AccountBalanceChange> >::iterator it_changes = transaction_balance_changes.find(transs);
+	if(it_changes == transaction_balance_changes.end()) return;
+	for(QVector<AccountBalanceChange>::const_iterator it = it_changes->constBegin(); it != it_changes->constEnd(); ++it) changeAccountBalance(it->account, it->day, -it->value);
+	transaction_balance_changes.erase(it_changes);
+}
+void Budget::rebalanceTransaction(Transaction *trans) {
+	//transactions are indexed as whole splits
+	if(account_balance_index.isEmpty()) return;
+	Transactions *transs = trans;
+	if(trans->parentSplit()) transs = trans->parentSplit();
+	if(!transaction_accounts_index.contains(transs)) return;
+	removeTransactionBalanceChanges(transs);
+	addTransactionBalanceChanges(transs);
+}
+double Budget::accountBalanceAt(AssetsAccount *account, qint64 julian_day) {
+	const AccountBalanceTimeline &timeline = accountBalanceTimeline(account);
+	QVector<qint64>::const_iterator it = std::upper_bound(timeline.days.constBegin(), timeline.days.constEnd(), julian_day);
+	if(it == timeline.days.constBegin()) return 0.0;
+	return timeline.balances.at(it - timeline.days.constBegin() - 1);
+}
+double Budget::accountBalance(AssetsAccount *account, const QDate &date, bool include_initial) {
+	double balance = accountBalanceAt(account, date.toJulianDay());
+	if(include_initial) balance += account->initialBalance();
+	return balance;
+}
+double Budget::accountBalanceChange(AssetsAccount *account, const QDate &from_date, const QDate &to_date) {
+	if(to_date < from_date) return 0.0;
+	return accountBalanceAt(account, to_date.toJulianDay()) - accountBalanceAt(account, from_date.toJulianDay() - 1);
+}
+bool transaction_id_less_than(Transactions *t1, Transactions *t2) {
+	//order of objects sharing the same id (e.g. debt payment parts): single transactions, then splits, then schedules; parts of the same split in part order, and otherwise in list order
+	if(t1->generaltype() != t2->generaltype()) return t1->generaltype() < t2->generaltype();
+	switch(t1->generaltype()) {
+		case GENERAL_TRANSACTION_TYPE_SINGLE: {
+			Transaction *trans1 = (Transaction*) t1, *trans2 = (Transaction*) t2;
+			SplitTransaction *split = trans1->parentSplit();
+			if(split && split == trans2->parentSplit()) {
+				int c = split->count();
+				for(int i = 0; i < c; i++) {
+					Transaction *trans = split->at(i);
+					if(trans == trans1) return true;
+					if(trans == trans2) return false;
+				}
+				return false;
+			}
+			return transaction_list_less_than(trans1, trans2);
+		}
+		case GENERAL_TRANSACTION_TYPE_SPLIT: {return split_list_less_than((SplitTransaction*) t1, (SplitTransaction*) t2);}
+		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {return schedule_list_less_than((ScheduledTransaction*) t1, (ScheduledTransaction*) t2);}
+	}
+	return false;
+}
+Transactions *Budget::getTransaction(qlonglong lid) {
+	if(!b_transactions_id_index_valid) rebuildTransactionIdIndex();
+	Transactions *found = NULL;
+	QMultiHash<qlonglong, Transactions*>::const_iterator it = transactions_id_index.constFind(lid);
+	while(it != transactions_id_index.constEnd() && it.key() == lid) {
+		if(!found || transaction_id_less_than(*it, found)) found = *it;
+		++it;
+	}
+	return found;
+}
+
+
+#define MAX_SCHEDULE_OCCURRENCE_WINDOWS 8
+
+void Budget::invalidateScheduleOccurrences() {
+	schedule_expansions.clear();
+	schedule_occurrence_windows.clear();
+}
+void Budget::invalidateScheduleOccurrences(ScheduledTransaction *strans) {
+	schedule_expansions.remove(strans);
+	//merged windows are cheap to rebuild from the remaining expansions
+	schedule_occurrence_windows.clear();
+}
+void Budget::getScheduleOccurrences(ScheduledTransaction *strans, const QDate &first_date, const QDate &last_date, QVector<QDate> &dates) {
+	if(strans->isOneTimeTransaction()) {
+		if((first_date.isNull() || strans->firstOccurrence() >= first_date) && strans->firstOccurrence() <= last_date) dates << strans->firstOccurrence();
+		return;
+	}
+	if(!b_transactions_id_index_valid) rebuildTransactionIdIndex();
+	if(!transactions_id_index.contains(strans->id(), strans)) {
+		//copies and schedules not (yet) part of the budget are not cached
+		strans->recurrence()->expandOccurrences(first_date, last_date, dates);
+		return;
+	}
+	QHash<ScheduledTransaction*, ScheduleExpansion>::iterator it = schedule_expansions.find(strans);
+	if(it == schedule_expansions.end() || (first_date.isNull() ? !it->first_date.isNull() : first_date < it->first_date) || last_date > it->last_date) {
+		ScheduleExpansion expansion;
+		expansion.first_date = first_date;
+		expansion.last_date = last_date;
+		if(it != schedule_expansions.end()) {
+			if(!expansion.first_date.isNull() && it->first_date < expansion.first_date) expansion.first_date = it->first_date;
+			if(it->last_date > expansion.last_date) expansion.last_date = it->last_date;
+		}
+		strans->recurrence()->expandOccurrences(expansion.first_date, expansion.last_date, expansion.dates);
+		it = schedule_expansions.insert(strans, expansion);
+	}
+	QVector<QDate>::const_iterator it_first = it->dates.constBegin();
+	if(!first_date.isNull()) it_first = std::lower_bound(it->dates.constBegin(), it->dates.constEnd(), first_date);
+	QVector<QDate>::const_iterator it_last = std::upper_bound(it_first, it->dates.constEnd(), last_date);
+	dates.reserve(dates.count() + (it_last - it_first));
+	for(; it_first != it_last; ++it_first) dates << *it_first;
+}
+QVector<ScheduleOccurrence> Budget::getScheduleOccurrences(const QDate &first_date, const QDate &last_date) {
+	for(int i = 0; i < schedule_occurrence_windows.count(); i++) {
+		if(schedule_occurrence_windows.at(i).first_date == first_date && schedule_occurrence_windows.at(i).last_date == last_date) {
+			if(i > 0) schedule_occurrence_windows.move(i, 0);
+			return schedule_occurrence_windows.first().occurrences;
+		}
+	}
+	QVector<ScheduledTransaction*> schedules;
+	QVector<QVector<QDate> > schedule_dates;
+	QVector<ScheduleOccurrenceCursor> queue;
+	int n = 0;
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+		ScheduledTransaction *strans = *it;
+		if(strans->firstOccurrence() > last_date) break;
+		QVector<QDate> dates;
+		getScheduleOccurrences(strans, first_date, last_date, dates);
+		if(dates.isEmpty()) continue;
+		ScheduleOccurrenceCursor cursor;
+		cursor.date = dates.first();
+		cursor.schedule_index = schedules.count();
+		cursor.date_index = 0;
+		queue << cursor;
+		n += dates.count();
+		schedules << strans;
+		schedule_dates << dates;
+	}
+	ScheduleOccurrenceWindow window;
+	window.first_date = first_date;
+	window.last_date = last_date;
+	window.occurrences.reserve(n);
+	//k-way merge of the per-schedule date lists, ordered by date and then by schedule list order
+	std::make_heap(queue.begin(), queue.end(), schedule_occurrence_cursor_greater);
+	while(!queue.isEmpty()) {
+		std::pop_heap(queue.begin(), queue.end(), schedule_occurrence_cursor_greater);
+		ScheduleOccurrenceCursor &cursor = queue.last();
+		ScheduleOccurrence occurrence;
+		occurrence.date = cursor.date;
+		occurrence.strans = schedules.at(cursor.schedule_index);
+		window.occurrences << occurrence;
+		cursor.date_index++;
+		if(cursor.date_index < schedule_dates.at(cursor.schedule_index).count()) {
+			cursor.date = schedule_dates.at(cursor.schedule_index).at(cursor.date_index);
+			std::push_heap(queue.begin(), queue.end(), schedule_occurrence_cursor_greater);
+		} else {
+			queue.removeLast();
+		}
+	}
+	schedule_occurrence_windows.prepend(window);
+	while(schedule_occurrence_windows.count() > MAX_SCHEDULE_OCCURRENCE_WINDOWS) schedule_occurrence_windows.removeLast();
+	return window.occurrences;
 }
 
+TransactionChanges::TransactionChanges() : b_reset(false), b_open_end(false) {}
+void TransactionChanges::clear() {
+	b_reset = false;
+	b_open_end = false;
+	change_list.clear();
+	change_index.clear();
+	changed_accounts.clear();
+	changed_tags.clear();
+	first_changed_date = QDate();
+	last_changed_date = QDate();
+}
+bool TransactionChanges::isEmpty() const {return !b_reset && change_list.isEmpty();}
+void TransactionChanges::setReset() {b_reset = true;}
+bool TransactionChanges::isReset() const {return b_reset;}
+const QList<TransactionChange> &TransactionChanges::changes() const {return change_list;}
+const QSet<Account*> &TransactionChanges::accounts() const {return changed_accounts;}
+void TransactionChanges::addTransaction(Transactions *transs) {
+	//dates, accounts (with parent categories) and tags that might be affected by the change
+	QDate date = transs->date();
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE && ((ScheduledTransaction*) transs)->recurrence()) b_open_end = true;
+	if(first_changed_date.isNull() || date < first_changed_date) first_changed_date = date;
+	if(last_changed_date.isNull() || date > last_changed_date) last_changed_date = date;
+	QVector<Account*> related;
+	transs->relatedAccounts(related);
+	for(QVector<Account*>::const_iterator it = related.constBegin(); it != related.constEnd(); ++it) {
+		Account *account = *it;
+		while(account) {
+			changed_accounts.insert(account);
+			if(account->type() == ACCOUNT_TYPE_ASSETS) break;
+			account = ((CategoryAccount*) account)->parentCategory();
+		}
+	}
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE) transs = ((ScheduledTransaction*) transs)->transaction();
+	if(!transs) return;
+	int c = transs->tagsCount(true);
+	for(int i = 0; i < c; i++) changed_tags.insert(transs->getTag(i, true));
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		SplitTransaction *split = (SplitTransaction*) transs;
+		for(QVector<Transaction*>::const_iterator it = split->splits.constBegin(); it != split->splits.constEnd(); ++it) {
+			c = (*it)->tagsCount(false);
+			for(int i = 0; i < c; i++) changed_tags.insert((*it)->getTag(i, false));
+		}
+	}
+}
+void TransactionChanges::transactionAdded(Transactions *transs) {
+	addTransaction(transs);
+	QHash<qlonglong, int>::const_iterator it = change_index.constFind(transs->id());
+	if(it != change_index.constEnd()) {
+		//a transaction removed and added again in the same round
+		TransactionChange &change = change_list[it.value()];
+		change.type = TRANSACTION_CHANGE_MODIFIED;
+		change.date = transs->date();
+		change.value = transs->value(true);
+		change.accounts.clear();
+		transs->relatedAccounts(change.accounts);
+		return;
+	}
+	TransactionChange change;
+	change.type = TRANSACTION_CHANGE_ADDED;
+	change.generaltype = transs->generaltype();
+	change.id = transs->id();
+	change.date = transs->date();
+	change.value = transs->value(true);
+	change.old_value = 0.0;
+	transs->relatedAccounts(change.accounts);
+	change_index[change.id] = change_list.count();
+	change_list << change;
+}
+void TransactionChanges::transactionModified(Transactions *transs, Transactions *oldtranss) {
+	addTransaction(transs);
+	if(oldtranss && oldtranss != transs) addTransaction(oldtranss);
+	//several changes of the same transaction are merged, keeping the oldest previous state
+	QHash<qlonglong, int>::const_iterator it = change_index.constFind(transs->id());
+	if(it != change_index.constEnd()) {
+		TransactionChange &change = change_list[it.value()];
+		change.date = transs->date();
+		change.value = transs->value(true);
+		change.accounts.clear();
+		transs->relatedAccounts(change.accounts);
+		return;
+	}
+	if(!oldtranss) oldtranss = transs;
+	TransactionChange change;
+	change.type = TRANSACTION_CHANGE_MODIFIED;
+	change.generaltype = transs->generaltype();
+	change.id = transs->id();
+	change.date = transs->date();
+	change.old_date = oldtranss->date();
+	change.value = transs->value(true);
+	change.old_value = oldtranss->value(true);
+	transs->relatedAccounts(change.accounts);
+	oldtranss->relatedAccounts(change.old_accounts);
+	change_index[change.id] = change_list.count();
+	change_list << change;
+}
+void TransactionChanges::transactionRemoved(Transactions *transs) {
+	addTransaction(transs);
+	QHash<qlonglong, int>::const_iterator it = change_index.constFind(transs->id());
+	if(it != change_index.constEnd()) {
+		//the previous state of an earlier change is kept
+		TransactionChange &change = change_list[it.value()];
+		change.type = TRANSACTION_CHANGE_REMOVED;
+		change.date = QDate();
+		change.value = 0.0;
+		change.accounts.clear();
+		return;
+	}
+	TransactionChange change;
+	change.type = TRANSACTION_CHANGE_REMOVED;
+	change.generaltype = transs->generaltype();
+	change.id = transs->id();
+	change.old_date = transs->date();
+	change.value = 0.0;
+	change.old_value = transs->value(true);
+	transs->relatedAccounts(change.old_accounts);
+	change_index[change.id] = change_list.count();
+	change_list << change;
+}
+bool TransactionChanges::affectsAccount(Account *account) const {
+	return b_reset || changed_accounts.contains(account);
+}
+bool TransactionChanges::affectsTag(const QString &tag) const {
+	if(b_reset) return true;
+	for(QSet<QString>::const_iterator it = changed_tags.constBegin(); it != changed_tags.constEnd(); ++it) {
+		if(it->compare(tag, Qt::CaseInsensitive) == 0) return true;
+	}
+	return false;
+}
+bool TransactionChanges::affectsPeriod(const QDate &first_date, const QDate &last_date) const {
+	//a null date means that the period is unbounded in that direction
+	if(b_reset) return true;
+	if(change_list.isEmpty()) return false;
+	if(!last_date.isNull() && first_changed_date > last_date) return false;
+	if(!first_date.isNull() && !b_open_end && last_changed_date < first_date) return false;
+	return true;
+}
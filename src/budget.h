@@ -23,6 +23,8 @@
 
 #include <QList>
 #include <QHash>
+#include <QMap>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QCoreApplication>
@@ -43,6 +45,7 @@
 #define SAVE_QUANTITY_PRECISION 15
 #define QUANTITY_DECIMAL_PLACES 2
 #define IS_GREGORIAN_CALENDAR true
+#define JOURNAL_FILE_SUFFIX ".journal"
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #	define XML_COMPARE_CONST_CHAR(x) QLatin1String(x)
@@ -54,6 +57,13 @@
 
 class QProcess;
 class QNetworkReply;
+class QThread;
+
+struct BinarySnapshot;
+struct TransactionChunks;
+struct PendingSave;
+struct TransactionLoadState;
+struct LoadedTransactionElement;
 
 typedef enum {
 	TRANSACTION_CONVERSION_RATE_AT_DATE,
@@ -67,6 +77,8 @@ void write_id(QXmlStreamAttributes *attr, qlonglong &id, int &rev1, int &rev2);
 void write_id(QXmlStreamWriter *writer, qlonglong &id, int &rev1, int &rev2);
 
 bool transaction_list_less_than(Transaction *t1, Transaction *t2);
+bool date_transaction_less_than(const QDate &date, Transaction *t);
+uint transaction_duplicate_key(const Transactions *trans);
 bool split_list_less_than(SplitTransaction *t1, SplitTransaction *t2);
 bool schedule_list_less_than(ScheduledTransaction *t1, ScheduledTransaction *t2);
 bool trade_list_less_than(SecurityTrade *t1, SecurityTrade *t2);
@@ -81,6 +93,13 @@ template<class type> class TransactionList : public EqonomizeList<type> {
 		void inSort(type value) {
 			QList<type>::insert(std::lower_bound(QList<type>::begin(), QList<type>::end(), value, transaction_list_less_than), value);
 		}
+		void inSort(const QList<type> &values) {
+			if(values.isEmpty()) return;
+			int n = QList<type>::count();
+			QList<type>::append(values);
+			std::sort(QList<type>::begin() + n, QList<type>::end(), transaction_list_less_than);
+			std::inplace_merge(QList<type>::begin(), QList<type>::begin() + n, QList<type>::end(), transaction_list_less_than);
+		}
 };
 template<class type> class SplitTransactionList : public EqonomizeList<type> {
 	public:
@@ -91,6 +110,13 @@ template<class type> class SplitTransactionList : public EqonomizeList<type> {
 		void inSort(type value) {
 			QList<type>::insert(std::lower_bound(QList<type>::begin(), QList<type>::end(), value, split_list_less_than), value);
 		}
+		void inSort(const QList<type> &values) {
+			if(values.isEmpty()) return;
+			int n = QList<type>::count();
+			QList<type>::append(values);
+			std::sort(QList<type>::begin() + n, QList<type>::end(), split_list_less_than);
+			std::inplace_merge(QList<type>::begin(), QList<type>::begin() + n, QList<type>::end(), split_list_less_than);
+		}
 };
 template<class type> class ScheduledTransactionList : public EqonomizeList<type> {
 	public:
@@ -101,6 +127,13 @@ template<class type> class ScheduledTransactionList : public EqonomizeList<type>
 		void inSort(type value) {
 			QList<type>::insert(std::lower_bound(QList<type>::begin(), QList<type>::end(), value, schedule_list_less_than), value);
 		}
+		void inSort(const QList<type> &values) {
+			if(values.isEmpty()) return;
+			int n = QList<type>::count();
+			QList<type>::append(values);
+			std::sort(QList<type>::begin() + n, QList<type>::end(), schedule_list_less_than);
+			std::inplace_merge(QList<type>::begin(), QList<type>::begin() + n, QList<type>::end(), schedule_list_less_than);
+		}
 
 };
 template<class type> class SecurityList : public EqonomizeList<type> {
@@ -140,6 +173,98 @@ struct BudgetSynchronization {
 	}
 };
 
+struct AccountBalanceTimeline {
+	QVector<qint64> days;
+	QVector<double> balances;
+};
+
+struct AccountBalanceChange {
+	AssetsAccount *account;
+	qint64 day;
+	double value;
+};
+
+struct BudgetMonthAggregate {
+	double value_from, value_to, quantity;
+	int count;
+};
+
+struct BudgetPeriod {
+	QDate first_day, last_day;
+	int year, month;
+};
+
+struct ScheduleOccurrence {
+	QDate date;
+	ScheduledTransaction *strans;
+};
+
+struct ScheduleExpansion {
+	QDate first_date, last_date;
+	QVector<QDate> dates;
+};
+
+struct ScheduleOccurrenceWindow {
+	QDate first_date, last_date;
+	QVector<ScheduleOccurrence> occurrences;
+};
+
+struct TransactionAggregateEntry {
+	Account *category;
+	QDate month;
+	Currency *currency;
+	double value, quantity;
+	bool b_from;
+	QStringList tags;
+};
+
+typedef enum {
+	TRANSACTION_CHANGE_ADDED,
+	TRANSACTION_CHANGE_MODIFIED,
+	TRANSACTION_CHANGE_REMOVED
+} TransactionChangeType;
+
+struct TransactionChange {
+	TransactionChangeType type;
+	GeneralTransactionType generaltype;
+	qlonglong id;
+	QDate date, old_date;
+	double value, old_value;
+	QVector<Account*> accounts, old_accounts;
+};
+
+class TransactionChanges {
+
+	public:
+
+		TransactionChanges();
+
+		void clear();
+		bool isEmpty() const;
+		void setReset();
+		bool isReset() const;
+		void transactionAdded(Transactions*);
+		void transactionModified(Transactions*, Transactions*);
+		void transactionRemoved(Transactions*);
+		const QList<TransactionChange> &changes() const;
+		const QSet<Account*> &accounts() const;
+		bool affectsAccount(Account*) const;
+		bool affectsTag(const QString&) const;
+		bool affectsPeriod(const QDate &first_date, const QDate &last_date) const;
+
+	protected:
+
+		bool b_reset, b_open_end;
+		QList<TransactionChange> change_list;
+		QHash<qlonglong, int> change_index;
+		QSet<Account*> changed_accounts;
+		QSet<QString> changed_tags;
+		QDate first_changed_date, last_changed_date;
+
+		void addTransaction(Transactions*);
+
+};
+
 class Budget {
 
 	Q_DECLARE_TR_FUNCTIONS(Budget)
@@ -149,14 +274,137 @@ class Budget {
 		int i_quotation_decimals, i_share_decimals, i_budget_day, i_budget_week, i_budget_month, i_opened_revision, i_revision;
 		bool b_record_new_tags, b_record_new_accounts, b_record_new_securities, b_default_currency_changed, b_currency_modified;
 		TransactionConversionRateDate i_tcrd;
+		int i_load_threads;
+		TransactionChunks *pending_transactions;
+		QString s_load_errors;
+		QThread *o_thread;
+		PendingSave *pending_save;
+		QString s_save_error;
+
+		QString s_save_id, s_journal_file;
+		QByteArray journal_header_hash;
+		QSet<qlonglong> journal_modified_ids, journal_removed_ids;
+		bool b_journal;
 
 		qlonglong last_id;
 
 		Currency *default_currency;
+		QHash<const Currency*, CurrencyConverter> default_currency_converters;
 
 		QNetworkReply *syncReply;
 		QProcess *syncProcess;
 
+		QMultiHash<qlonglong, Transactions*> transactions_id_index;
+		bool b_transactions_id_index_valid;
+
+		void rebuildTransactionIdIndex();
+		void invalidateTransactionIdIndex();
+
+		QMultiHash<QString, Account*> accounts_name_index;
+		QMultiHash<QString, AssetsAccount*> assetsAccounts_name_index;
+		QMultiHash<QString, IncomesAccount*> incomesAccounts_name_index;
+		QMultiHash<QString, ExpensesAccount*> expensesAccounts_name_index;
+		QHash<QString, Security*> securities_name_index;
+		QHash<QString, Currency*> currencies_code_index;
+		QHash<QString, QString> tags_index;
+		bool b_accounts_name_index_valid, b_securities_name_index_valid, b_currencies_code_index_valid, b_tags_index_valid;
+
+		void rebuildAccountNameIndex();
+		void invalidateAccountNameIndex();
+		void rebuildSecurityNameIndex();
+		void invalidateSecurityNameIndex();
+		void rebuildCurrencyCodeIndex();
+		void invalidateCurrencyCodeIndex();
+		void rebuildTagIndex();
+		void invalidateTagIndex();
+
+		QHash<Account*, QSet<Transactions*> > account_transactions_index;
+		QHash<Transactions*, QVector<Account*> > transaction_accounts_index;
+		bool b_account_transactions_index_valid;
+
+		void rebuildAccountTransactionsIndex();
+		void invalidateAccountTransactionsIndex();
+		void indexTransactionAccounts(Transactions*);
+		void unindexTransactionAccounts(Transactions*);
+
+		QHash<AssetsAccount*, AccountBalanceTimeline> account_balance_index;
+		QHash<Transactions*, QVector<AccountBalanceChange> > transaction_balance_changes;
+
+		const AccountBalanceTimeline &accountBalanceTimeline(AssetsAccount*);
+		double accountBalanceAt(AssetsAccount*, qint64 julian_day);
+		void accountBalanceModified(Account*);
+		void changeAccountBalance(AssetsAccount*, qint64 julian_day, double value);
+		void addTransactionBalanceChanges(Transactions*);
+		void removeTransactionBalanceChanges(Transactions*);
+		void rebalanceTransaction(Transaction*);
+
+		QHash<Account*, QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > > budget_month_aggregates;
+		QHash<QString, QMap<QDate, QHash<Currency*, BudgetMonthAggregate> > > budget_month_tag_aggregates;
+		QHash<Transaction*, TransactionAggregateEntry> transaction_aggregates;
+		bool b_budget_month_aggregates_valid;
+
+		void rebuildBudgetMonthAggregates();
+		void invalidateBudgetMonthAggregates();
+		void aggregateTransaction(Transaction*);
+		void unaggregateTransaction(Transaction*);
+		void reaggregateTransaction(Transaction*);
+
+		QMultiHash<uint, Transaction*> transactions_duplicate_index;
+		QHash<Transaction*, uint> transaction_duplicate_keys;
+		bool b_transactions_duplicate_index_valid;
+
+		void rebuildTransactionsDuplicateIndex();
+		void invalidateTransactionsDuplicateIndex();
+		void indexTransactionDuplicateKey(Transaction*);
+		void unindexTransactionDuplicateKey(Transaction*);
+		void reindexTransactionDuplicateKey(Transaction*);
+
+		QHash<quint64, QVector<qlonglong> > transactions_text_index;
+		QHash<Transactions*, QVector<quint64> > transaction_text_keys;
+		bool b_transactions_text_index_valid;
+
+		void rebuildTransactionsTextIndex();
+		void invalidateTransactionsTextIndex();
+		void indexTransactionText(Transactions*, bool keep_sorted = true);
+		void unindexTransactionText(Transactions*);
+		void reindexTransactionText(Transactions*);
+
+		QHash<ScheduledTransaction*, ScheduleExpansion> schedule_expansions;
+		QList<ScheduleOccurrenceWindow> schedule_occurrence_windows;
+
+		void invalidateScheduleOccurrences();
+		void invalidateScheduleOccurrences(ScheduledTransaction*);
+
+		mutable QVector<BudgetPeriod> budget_periods;
+		mutable QVector<int> budget_period_index;
+		mutable qint64 budget_periods_first_day;
+		mutable int budget_periods_day, budget_periods_week, budget_periods_month;
+		mutable bool b_budget_periods_valid;
+
+		void rebuildBudgetPeriods() const;
+		void invalidateBudgetPeriods();
+		const BudgetPeriod *budgetPeriod(const QDate &date) const;
+
+		QString loadBinary(QString filename, QString &errors, bool *default_currency_created, bool merge, bool rename_duplicate_accounts, bool rename_duplicate_categories, bool rename_duplicate_securities, bool ignore_duplicate_transactions);
+		QString loadXml(QXmlStreamReader *xml, QString &errors, bool *default_currency_created, bool merge, bool rename_duplicate_accounts, bool rename_duplicate_categories, bool rename_duplicate_securities, bool ignore_duplicate_transactions, const BinarySnapshot *snapshot = NULL, TransactionChunks *chunks = NULL);
+		void registerLoadedTransaction(LoadedTransactionElement &element, TransactionLoadState &state);
+		void setMissingIds();
+		void sortTransactionLists();
+		void cancelLoading();
+		bool inParseThread() const;
+		void writeXml(QXmlStreamWriter *xml, bool skip_binary_records = false, const QString &save_id = QString());
+		void writeXmlStart(QXmlStreamWriter *xml, const QString &save_id);
+		void writeXmlHeader(QXmlStreamWriter *xml);
+		QByteArray xmlHeaderHash();
+
+		bool loadJournal(QString filename, QString &errors, bool recovery = false);
+		void removeJournaledTransactions(const QSet<qlonglong> &ids);
+		QByteArray journalEntry();
+		QString saveJournal(QString filename, QFile::Permissions permissions);
+		void startJournal(QString filename);
+		void stopJournal();
+		void journalTransaction(Transactions*);
+
 	public:
 
 		BudgetSynchronization *o_sync;
@@ -187,8 +435,24 @@ class Budget {
 		TransactionConversionRateDate defaultTransactionConversionRateDate() const;
 		void setDefaultTransactionConversionRateDate(TransactionConversionRateDate tcrd);
 
-		QString loadFile(QString filename, QString &errors, bool *default_currency_created = NULL, bool merge = false, bool rename_duplicate_accounts = false, bool rename_duplicate_categories = false, bool rename_duplicate_securities = false, bool ignore_duplicate_transactions = false);
-		QString saveFile(QString filename, QFile::Permissions permissions = QFile::ReadUser | QFile::WriteUser, bool is_backup = false);
+		int loadThreadCount() const;
+		void setLoadThreadCount(int threads);
+
+		QString loadFile(QString filename, QString &errors, bool *default_currency_created = NULL, bool merge = false, bool rename_duplicate_accounts = false, bool rename_duplicate_categories = false, bool rename_duplicate_securities = false, bool ignore_duplicate_transactions = false, bool progressive = false);
+		bool isLoading() const;
+		int loadingProgress() const;
+		bool loadPendingTransactions(QString &errors, bool wait = false);
+		void finishLoading();
+		QString saveFile(QString filename, QFile::Permissions permissions = QFile::ReadUser | QFile::WriteUser, bool is_backup = false, bool incremental = false);
+		bool canSaveIncrementally(QString filename);
+		QString startSaveFile(QString filename, QFile::Permissions permissions = QFile::ReadUser | QFile::WriteUser, bool is_backup = false, bool incremental = false);
+		bool canSaveRecoveryJournal(QString filename);
+		QString saveRecoveryJournal(QString filename, QFile::Permissions permissions = QFile::ReadUser | QFile::WriteUser);
+		QString loadRecoveryJournal(QString filename, QString &errors);
+		bool isSaving() const;
+		bool savingFinished(QString &error, bool wait = false);
+		void finishSaving();
+		QString saveBinary(QString filename, QFile::Permissions permissions = QFile::ReadUser | QFile::WriteUser);
 		int fileRevision(QString filename, QString &error) const;
 		bool isUnsynced(QString filename, QString &error, int synced_revision = -1) const;
 		QString syncFile(QString filename, QString &errors, int revision_synced = -1);
@@ -207,6 +471,7 @@ class Budget {
 		void removeTransactions(Transactions*, bool keep = false);
 
 		void addTransactions(Transactions*);
+		void addTransactions(const QList<Transactions*>&);
 		void removeTransaction(Transaction*, bool keep = false);
 
 		void addScheduledTransaction(ScheduledTransaction*);
@@ -223,6 +488,8 @@ class Budget {
 		void moveTransactions(Account*, Account*, bool move_from_subs = true);
 
 		Transaction *findDuplicateTransaction(Transaction *trans);
+		Transaction *findDuplicateTransaction(Transaction *trans, const QMultiHash<uint, Transaction*> &pending);
+		bool findTextCandidates(const QString &text, QSet<qlonglong> &ids);
 
 		void addSecurity(Security*);
 		void removeSecurity(Security*, bool keep = false);
@@ -261,6 +528,7 @@ class Budget {
 		bool resetDefaultCurrency();
 		void addCurrency(Currency*);
 		void removeCurrency(Currency*);
+		CurrencyConverter &defaultCurrencyConverter(const Currency *from);
 		Currency *findCurrency(QString code);
 		Currency *findCurrencySymbol(QString symbol, bool require_unique = false);
 		bool usesMultipleCurrencies();
@@ -269,6 +537,7 @@ class Budget {
 		bool currenciesModified();
 		void resetCurrenciesModified();
 		void currencyModified(Currency*);
+		void currencyCodeModified(Currency*);
 
 		qlonglong getNewId();
 		int revision();
@@ -303,6 +572,23 @@ class Budget {
 		QHash<qlonglong, Security*> securities_id;
 
 		Transactions *getTransaction(qlonglong tid);
+		void transactionModified(Transactions*);
+		void transactionIdModified(Transactions*, qlonglong old_id);
+		void transactionAccountsModified(Transactions*);
+		void securityAccountModified(Security*);
+		void transactionValueModified(Transaction*);
+
+		double accountBalance(AssetsAccount *account, const QDate &date, bool include_initial = true);
+		double accountBalanceChange(AssetsAccount *account, const QDate &from_date, const QDate &to_date);
+
+		void transactionQuantityModified(Transaction*);
+		void transactionSharesModified(Transaction*);
+		void accountCurrencyModified(AssetsAccount*);
+		bool budgetMonthAggregatesAreExact();
+		void getBudgetMonthAggregates(const QDate &first_month, const QDate &last_month, QMap<QDate, QHash<Account*, BudgetMonthAggregate> > &aggregates);
+		void getBudgetMonthTagAggregates(const QDate &first_month, const QDate &last_month, QMap<QDate, QHash<QString, BudgetMonthAggregate> > &aggregates);
+		void getScheduleOccurrences(ScheduledTransaction *strans, const QDate &first_date, const QDate &last_date, QVector<QDate> &dates);
+		QVector<ScheduleOccurrence> getScheduleOccurrences(const QDate &first_date, const QDate &last_date);
 
 		void setBudgetDay(int day_of_month);
 		int budgetDay() const;
@@ -721,10 +721,41 @@ void CategoriesComparisonChart::updateDisplay() {
 	Currency *currency = budget->defaultCurrency();
 	if(single_assets) currency = ((AssetsAccount*) accountCombo->selectedAccounts()[0])->currency();
 
+	bool b_aggregates = false;
+	QDate aggregates_first, aggregates_last;
+	if(type != ACCOUNT_TYPE_ASSETS && !assets_selected && (!current_account || include_subs) && budget->budgetMonthAggregatesAreExact()) {
+		aggregates_first = budget->firstBudgetDay(first_date);
+		if(aggregates_first < first_date) budget->addBudgetMonthsSetFirst(aggregates_first, 1);
+		aggregates_last = budget->lastBudgetDay(to_date);
+		if(aggregates_last > to_date) budget->addBudgetMonthsSetLast(aggregates_last, -1);
+		b_aggregates = (aggregates_first < aggregates_last);
+	}
+	if(b_aggregates) {
+		//complete budget months are read from the monthly aggregates, remaining days are scanned below
+		QMap<QDate, QHash<Account*, BudgetMonthAggregate> > aggregates;
+		budget->getBudgetMonthAggregates(aggregates_first, budget->firstBudgetDay(aggregates_last), aggregates);
+		for(QMap<QDate, QHash<Account*, BudgetMonthAggregate> >::const_iterator it_month = aggregates.constBegin(); it_month != aggregates.constEnd(); ++it_month) {
+			for(QHash<Account*, BudgetMonthAggregate>::const_iterator it_cat = it_month->constBegin(); it_cat != it_month->constEnd(); ++it_cat) {
+				Account *account = it_cat.key();
+				if(account->type() != type || (current_account && account->topAccount() != current_account)) continue;
+				if(!include_subs) account = account->topAccount();
+				if(type == ACCOUNT_TYPE_EXPENSES) values[account] += it_cat->value_to - it_cat->value_from;
+				else values[account] += it_cat->value_from - it_cat->value_to;
+				counts[account] += it_cat->quantity;
+			}
+		}
+	}
+
 	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
 		Transaction *trans = *it;
 		if(!first_date_reached && trans->date() >= first_date) first_date_reached = true;
 		else if(first_date_reached && trans->date() > to_date) break;
+		if(b_aggregates && trans->date() >= aggregates_first && trans->date() <= aggregates_last) {
+			it = std::upper_bound(it, budget->transactions.constEnd(), aggregates_last, date_transaction_less_than);
+			if(it == budget->transactions.constEnd()) break;
+			--it;
+			continue;
+		}
 		if(first_date_reached && (!assets_selected || accountCombo->testTransactionRelation(trans))) {
 			if(current_account && !include_subs) {
 				if(trans->fromAccount() == current_account) {
@@ -1374,6 +1405,11 @@ void CategoriesComparisonChart::resizeEvent(QResizeEvent *e) {
 }
 #endif
 
+void CategoriesComparisonChart::transactionsChanged(const TransactionChanges &changes) {
+	if(!changes.affectsPeriod(QDate(), to_date)) return;
+	if(current_account && !changes.affectsAccount(current_account)) return;
+	updateTransactions();
+}
 void CategoriesComparisonChart::updateTransactions() {
 	updateDisplay();
 }
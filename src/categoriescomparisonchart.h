@@ -50,6 +50,7 @@ class AccountsCombo;
 class CategoryAccount;
 class AssetsAccount;
 class Budget;
+class TransactionChanges;
 
 class CategoriesComparisonChart : public QWidget {
 
@@ -94,6 +95,7 @@ class CategoriesComparisonChart : public QWidget {
 
 		void resetOptions();
 		void updateTransactions();
+		void transactionsChanged(const TransactionChanges&);
 		void updateAccounts();
 		void updateDisplay();
 		void onFilterSelected(QString);
@@ -996,6 +996,60 @@ void CategoriesComparisonReport::updateDisplay() {
 	int month_index = 0;
 	if(i_months <= 0) month_index = -1;
 
+	bool b_aggregates = false;
+	QDate aggregates_first, aggregates_last;
+	if(i_source == 0 && !assets_selected && !b_tags && budget->budgetMonthAggregatesAreExact()) {
+		aggregates_first = budget->firstBudgetDay(first_date);
+		if(aggregates_first < first_date) budget->addBudgetMonthsSetFirst(aggregates_first, 1);
+		aggregates_last = budget->lastBudgetDay(last_date);
+		if(aggregates_last > last_date) budget->addBudgetMonthsSetLast(aggregates_last, -1);
+		b_aggregates = (aggregates_first < aggregates_last);
+	}
+	if(b_aggregates) {
+		//complete budget months are read from the monthly aggregates, remaining days are scanned below
+		QMap<QDate, QHash<Account*, BudgetMonthAggregate> > aggregates;
+		budget->getBudgetMonthAggregates(aggregates_first, budget->firstBudgetDay(aggregates_last), aggregates);
+		QDate aggregates_curmonth;
+		int aggregates_month_index = -1;
+		if(i_months > 0) {
+			aggregates_curmonth = (b_years ? budget->lastBudgetDayOfYear(first_date) : budget->lastBudgetDay(first_date));
+			aggregates_month_index = 0;
+		}
+		for(QMap<QDate, QHash<Account*, BudgetMonthAggregate> >::const_iterator it_month = aggregates.constBegin(); it_month != aggregates.constEnd(); ++it_month) {
+			if(i_months > 0) {
+				while(aggregates_curmonth < it_month.key()) {
+					budget->addBudgetMonthsSetLast(aggregates_curmonth, b_years ? 12 : 1);
+					aggregates_month_index++;
+				}
+			}
+			for(QHash<Account*, BudgetMonthAggregate>::const_iterator it_cat = it_month->constBegin(); it_cat != it_month->constEnd(); ++it_cat) {
+				Account *account = it_cat.key();
+				double v = 0.0;
+				if(account->type() == ACCOUNT_TYPE_EXPENSES) v = it_cat->value_to - it_cat->value_from;
+				else v = it_cat->value_from - it_cat->value_to;
+				if(!include_subs) account = account->topAccount();
+				while(true) {
+					values[account] += v;
+					if(aggregates_month_index >= 0) month_values[account][aggregates_month_index] += v;
+					counts[account] += it_cat->quantity;
+					if(!include_subs || account == account->topAccount()) {
+						if(account->type() == ACCOUNT_TYPE_EXPENSES) {
+							costs += v;
+							if(aggregates_month_index >= 0) month_costs[aggregates_month_index] += v;
+							costs_count += it_cat->quantity;
+						} else {
+							incomes += v;
+							if(aggregates_month_index >= 0) month_incomes[aggregates_month_index] += v;
+							incomes_count += it_cat->quantity;
+						}
+						break;
+					}
+					account = account->topAccount();
+				}
+			}
+		}
+	}
+
 	bool first_date_reached = false;
 	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
 		Transaction *trans = *it;
@@ -1017,6 +1071,12 @@ void CategoriesComparisonReport::updateDisplay() {
 				month_index++;
 			}
 		}
+		if(b_aggregates && trans->date() >= aggregates_first && trans->date() <= aggregates_last) {
+			it = std::upper_bound(it, budget->transactions.constEnd(), aggregates_last, date_transaction_less_than);
+			if(it == budget->transactions.constEnd()) break;
+			--it;
+			continue;
+		}
 		if(first_date_reached && (!assets_selected || accountCombo->testTransactionRelation(trans))) {
 			if((current_account && !include_subs) || !current_tag.isEmpty()) {
 				int sign = 1;
@@ -1982,6 +2042,17 @@ void CategoriesComparisonReport::updateDisplay() {
 	if(htmlview->document()->size().width() < htmlview->width()) htmlview->setLineWrapMode(QTextEdit::WidgetWidth);
 }
 
+void CategoriesComparisonReport::transactionsChanged(const TransactionChanges &changes) {
+	//description and payee lists include transactions outside of the selected period
+	if(current_account) {
+		if(!changes.affectsAccount(current_account)) return;
+	} else if(!current_tag.isEmpty()) {
+		if(!changes.affectsTag(current_tag)) return;
+	} else if(!changes.affectsPeriod(QDate(), to_date)) {
+		return;
+	}
+	updateTransactions();
+}
 void CategoriesComparisonReport::updateTransactions() {
 	if(b_extra && (current_account || !current_tag.isEmpty())) {
 		payeeCombo->blockSignals(true);
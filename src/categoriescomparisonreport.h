@@ -36,6 +36,7 @@ class DescriptionsCombo;
 class CategoryAccount;
 class AssetsAccount;
 class Budget;
+class TransactionChanges;
 
 class CategoriesComparisonReport : public QWidget {
 
@@ -73,6 +74,7 @@ class CategoriesComparisonReport : public QWidget {
 
 		void resetOptions();
 		void updateTransactions();
+		void transactionsChanged(const TransactionChanges&);
 		void updateAccounts();
 		void updateTags();
 		void updateDisplay();
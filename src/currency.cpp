@@ -28,6 +28,7 @@
 #include <QLocale>
 #include <QDebug>
 #include <math.h>
+#include <algorithm>
 
 #include "budget.h"
 #include "currency.h"
@@ -38,6 +39,7 @@ Currency::Currency(Budget *parent_budget) {
 	b_precedes = -1;
 	r_source = EXCHANGE_RATE_SOURCE_NONE;
 	b_local_rate = true; b_local_name = true; b_local_symbol = true; b_local_format = true;
+	i_rates_revision = 0;
 }
 Currency::Currency() {
 	o_budget = NULL;
@@ -45,6 +47,7 @@ Currency::Currency() {
 	b_precedes = -1;
 	r_source = EXCHANGE_RATE_SOURCE_NONE;
 	b_local_rate = true; b_local_name = true; b_local_symbol = true; b_local_format = true;
+	i_rates_revision = 0;
 }
 Currency::Currency(Budget *parent_budget, QString initial_code, QString initial_symbol, QString initial_name, double initial_rate, QDate date, int initial_decimals, int initial_precedes) {
 	o_budget = parent_budget;
@@ -52,7 +55,8 @@ Currency::Currency(Budget *parent_budget, QString initial_code, QString initial_
 	s_symbol = initial_symbol;
 	s_name = initial_name;
 	if(!date.isValid() && initial_rate != 1.0) date = QDate::currentDate();
-	if(date.isValid()) rates[date] = initial_rate;
+	i_rates_revision = 0;
+	if(date.isValid()) insertExchangeRate(date.toJulianDay(), initial_rate);
 	i_decimals = initial_decimals;
 	b_precedes = initial_precedes;
 	if(i_decimals < 0) i_decimals = -1;
@@ -64,6 +68,7 @@ Currency::Currency(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) {
 	i_decimals = -1;
 	b_precedes = -1;
 	b_local_rate = false; b_local_name = false; b_local_symbol = false; b_local_format = false;
+	i_rates_revision = 0;
 	QXmlStreamAttributes attr = xml->attributes();
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
@@ -71,7 +76,8 @@ Currency::Currency(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) {
 Currency::~Currency() {}
 Currency *Currency::copy() const {
 	Currency *this_copy = new Currency(o_budget, s_code, s_symbol, s_name, 1.0, QDate(), b_precedes, i_decimals);
-	this_copy->rates = rates;
+	this_copy->rate_days = rate_days;
+	this_copy->rate_values = rate_values;
 	this_copy->setExchangeRateIsUpdated(b_local_rate);
 	this_copy->setNameHasChanged(b_local_name);
 	this_copy->setSymbolHasChanged(b_local_symbol);
@@ -92,11 +98,9 @@ bool Currency::merge(Currency *currency, bool keep_rates) {
 		s_symbol = currency->symbol();
 	}
 	if(this != o_budget->currency_euro) {
-		if(!keep_rates) rates.clear();
-		QMap<QDate, double>::const_iterator it = currency->rates.constBegin();
-		while (it != currency->rates.constEnd()) {
-			rates[it.key()] = it.value();
-			++it;
+		if(!keep_rates) clearExchangeRates();
+		for(int i = 0; i < currency->rate_days.count(); i++) {
+			insertExchangeRate(currency->rate_days.at(i), currency->rate_values.at(i));
 		}
 	}
 	b_local_rate = true;
@@ -133,7 +137,7 @@ bool Currency::readElement(QXmlStreamReader *xml, bool*) {
 	if(xml->name() == XML_COMPARE_CONST_CHAR("rate")) {
 		QXmlStreamAttributes attr = xml->attributes();
 		QDate date = QDate::fromString(attr.value("date").toString(), Qt::ISODate);
-		if(date.isValid()) rates[date] = attr.value("value").toDouble();
+		if(date.isValid()) insertExchangeRate(date.toJulianDay(), attr.value("value").toDouble());
 		return false;
 	}
 	return false;
@@ -163,48 +167,71 @@ void Currency::writeAttributes(QXmlStreamAttributes *attr, bool local_save) {
 }
 void Currency::writeElements(QXmlStreamWriter *xml, bool local_save) {
 	if(local_save) {
-		QMap<QDate, double>::const_iterator it = rates.constBegin();
-		while(it != rates.constEnd()) {
+		for(int i = 0; i < rate_days.count(); i++) {
 			xml->writeStartElement("rate");
-			xml->writeAttribute("value", QString::number(it.value(), 'g', SAVE_MONETARY_PRECISION));
-			xml->writeAttribute("date", it.key().toString(Qt::ISODate));
+			xml->writeAttribute("value", QString::number(rate_values.at(i), 'g', SAVE_MONETARY_PRECISION));
+			xml->writeAttribute("date", QDate::fromJulianDay(rate_days.at(i)).toString(Qt::ISODate));
 			xml->writeEndElement();
-			++it;
 		}
-	} else if(!rates.isEmpty()) {
+	} else if(!rate_days.isEmpty()) {
 		xml->writeStartElement("rate");
-		xml->writeAttribute("value", QString::number(rates.last(), 'g', SAVE_MONETARY_PRECISION));
-		xml->writeAttribute("date", rates.lastKey().toString(Qt::ISODate));
+		xml->writeAttribute("value", QString::number(rate_values.last(), 'g', SAVE_MONETARY_PRECISION));
+		xml->writeAttribute("date", QDate::fromJulianDay(rate_days.last()).toString(Qt::ISODate));
 		xml->writeEndElement();
 	}
 }
 
+void Currency::insertExchangeRate(qint64 day, double rate) {
+	i_rates_revision++;
+	if(rate_days.isEmpty() || day > rate_days.last()) {
+		rate_days << day;
+		rate_values << rate;
+		return;
+	}
+	QVector<qint64>::iterator it = std::lower_bound(rate_days.begin(), rate_days.end(), day);
+	int i = it - rate_days.begin();
+	if(*it == day) {
+		rate_values[i] = rate;
+	} else {
+		rate_days.insert(i, day);
+		rate_values.insert(i, rate);
+	}
+}
 double Currency::exchangeRate(QDate date, bool exact_match) const {
 	if(exact_match) {
-		QMap<QDate, double>::const_iterator it = rates.find(date);
-		if(it == rates.constEnd()) return -1.0;
-		return it.value();
+		QVector<qint64>::const_iterator it = std::lower_bound(rate_days.constBegin(), rate_days.constEnd(), date.toJulianDay());
+		if(it == rate_days.constEnd() || *it != date.toJulianDay()) return -1.0;
+		return rate_values.at(it - rate_days.constBegin());
 	}
-	if(rates.isEmpty()) return 1.0;
-	if(!date.isValid()) return rates.last();
-	QMap<QDate, double>::const_iterator it = rates.lowerBound(date);
-	if(it == rates.constEnd()) return rates.last();
-	if(it.key() != date && it != rates.constBegin()) {
-		QMap<QDate, double>::const_iterator it2 = it;
-		--it2;
-		if(date.daysTo(it.key()) >= it2.key().daysTo(date)) it = it2;
-	}
-	return it.value();
+	if(rate_days.isEmpty()) return 1.0;
+	if(!date.isValid()) return rate_values.last();
+	qint64 day = date.toJulianDay();
+	QVector<qint64>::const_iterator it = std::lower_bound(rate_days.constBegin(), rate_days.constEnd(), day);
+	if(it == rate_days.constEnd()) return rate_values.last();
+	//use the closest rate (the earlier one if equally close)
+	if(*it != day && it != rate_days.constBegin() && *it - day >= day - *(it - 1)) --it;
+	return rate_values.at(it - rate_days.constBegin());
 }
 QDate Currency::lastExchangeRateDate() const {
-	if(rates.isEmpty()) return QDate();
-	return rates.lastKey();
+	if(rate_days.isEmpty()) return QDate();
+	return QDate::fromJulianDay(rate_days.last());
 }
 void Currency::setExchangeRate(double new_rate, QDate date) {
 	if(!date.isValid()) date = QDate::currentDate();
-	rates[date] = new_rate;
+	insertExchangeRate(date.toJulianDay(), new_rate);
 	b_local_rate = true;
 }
+int Currency::exchangeRateCount() const {
+	return rate_days.count();
+}
+void Currency::clearExchangeRates() {
+	rate_days.clear();
+	rate_values.clear();
+	i_rates_revision++;
+}
+int Currency::exchangeRatesRevision() const {
+	return i_rates_revision;
+}
 
 ExchangeRateSource Currency::exchangeRateSource() const {
 	return r_source;
@@ -215,8 +242,8 @@ void Currency::setExchangeRateSource(ExchangeRateSource source) {
 
 double Currency::convertTo(double value, const Currency *to_currency) const {
 	if(to_currency == this) return value;
-	if(rates.isEmpty()) return value * to_currency->exchangeRate();
-	return value / rates.last() * to_currency->exchangeRate();
+	if(rate_values.isEmpty()) return value * to_currency->exchangeRate();
+	return value / rate_values.last() * to_currency->exchangeRate();
 }
 double Currency::convertFrom(double value, const Currency *from_currency) const {
 	if(from_currency == this) return value;
@@ -224,22 +251,42 @@ double Currency::convertFrom(double value, const Currency *from_currency) const
 }
 double Currency::convertTo(double value, const Currency *to_currency, const QDate &date) const {
 	if(to_currency == this) return value;
-	if(rates.isEmpty()) return value * to_currency->exchangeRate(date);
-	if(!date.isValid()) return value / rates.last() * to_currency->exchangeRate(date);
-	QMap<QDate, double>::const_iterator it = rates.lowerBound(date);
-	if(it == rates.constEnd()) return value / rates.last() * to_currency->exchangeRate(date);
-	if(it.key() != date && it != rates.constBegin()) {
-		QMap<QDate, double>::const_iterator it2 = it;
-		--it2;
-		if(date.daysTo(it.key()) >= it2.key().daysTo(date)) it = it2;
-	}
-	return value / it.value() * to_currency->exchangeRate(date);
+	return value / exchangeRate(date) * to_currency->exchangeRate(date);
 }
 double Currency::convertFrom(double value, const Currency *from_currency, const QDate &date) const {
 	if(from_currency == this) return value;
 	return from_currency->convertTo(value, this, date);
 }
 
+CurrencyConverter::CurrencyConverter(const Currency *from, const Currency *to) : from_currency(from), to_currency(to), i_from_revision(from ? from->exchangeRatesRevision() : 0), i_to_revision(to ? to->exchangeRatesRevision() : 0) {}
+const Currency *CurrencyConverter::fromCurrency() const {return from_currency;}
+const Currency *CurrencyConverter::toCurrency() const {return to_currency;}
+double CurrencyConverter::crossRate(const QDate &date) {
+	if(from_currency == to_currency || !from_currency || !to_currency) return 1.0;
+	if(i_from_revision != from_currency->exchangeRatesRevision() || i_to_revision != to_currency->exchangeRatesRevision()) {
+		cross_rates.clear();
+		i_from_revision = from_currency->exchangeRatesRevision();
+		i_to_revision = to_currency->exchangeRatesRevision();
+	}
+	//invalid dates (latest rate) share the null julian day as key
+	qint64 day = date.toJulianDay();
+	QHash<qint64, double>::const_iterator it = cross_rates.constFind(day);
+	if(it != cross_rates.constEnd()) return it.value();
+	double rate = to_currency->exchangeRate(date) / from_currency->exchangeRate(date);
+	cross_rates.insert(day, rate);
+	return rate;
+}
+double CurrencyConverter::convert(double value, const QDate &date) {
+	if(from_currency == to_currency) return value;
+	return value * crossRate(date);
+}
+void CurrencyConverter::convert(QVector<double> &values, const QVector<QDate> &dates) {
+	if(from_currency == to_currency) return;
+	for(int i = 0; i < values.count() && i < dates.count(); i++) {
+		values[i] *= crossRate(dates.at(i));
+	}
+}
+
 QString Currency::formatValue(double value, int nr_of_decimals, bool show_currency, bool always_show_sign, bool conventional_sign_placement) const {
 	if(nr_of_decimals < 0) {
 		if(i_decimals < 0) nr_of_decimals = MONETARY_DECIMAL_PLACES;
@@ -362,7 +409,9 @@ const QString &Currency::name(bool return_code_if_empty) const {
 	return s_name;
 }
 void Currency::setCode(QString new_code) {
+	if(new_code == s_code) return;
 	s_code = new_code;
+	if(o_budget) o_budget->currencyCodeModified(this);
 }
 void Currency::setSymbol(QString new_symbol) {
 	s_symbol = new_symbol;
@@ -23,7 +23,8 @@
 
 #include <QString>
 #include <QDate>
-#include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QCoreApplication>
 
 #include "eqonomizelist.h"
@@ -55,9 +56,13 @@ class Currency {
 		Budget *o_budget;
 		bool b_local_rate, b_local_name, b_local_symbol, b_local_format;
 
-	public:
+		QVector<qint64> rate_days;
+		QVector<double> rate_values;
+		int i_rates_revision;
+
+		void insertExchangeRate(qint64 day, double rate);
 
-		QMap<QDate, double> rates;
+	public:
 
 		Currency();
 		Currency(Budget *parent_budget);
@@ -78,6 +83,9 @@ class Currency {
 		double exchangeRate(QDate date = QDate(), bool exact_match = false) const;
 		QDate lastExchangeRateDate() const;
 		void setExchangeRate(double new_rate, QDate date = QDate());
+		int exchangeRateCount() const;
+		void clearExchangeRates();
+		int exchangeRatesRevision() const;
 
 		ExchangeRateSource exchangeRateSource() const;
 		void setExchangeRateSource(ExchangeRateSource source);
@@ -123,6 +131,27 @@ class Currency {
 
 };
 
+class CurrencyConverter {
+
+	protected:
+
+		const Currency *from_currency, *to_currency;
+		int i_from_revision, i_to_revision;
+		QHash<qint64, double> cross_rates;
+
+	public:
+
+		CurrencyConverter(const Currency *from = NULL, const Currency *to = NULL);
+
+		const Currency *fromCurrency() const;
+		const Currency *toCurrency() const;
+
+		double crossRate(const QDate &date = QDate());
+		double convert(double value, const QDate &date = QDate());
+		void convert(QVector<double> &values, const QVector<QDate> &dates);
+
+};
+
 bool currency_list_less_than(Currency *c1, Currency *c2);
 template<class type> class CurrencyList : public EqonomizeList<type> {
 	public:
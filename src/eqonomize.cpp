@@ -86,6 +86,8 @@
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QProgressDialog>
+#include <QProgressBar>
+#include <QStatusBar>
 #include <QFontDialog>
 #include <QInputDialog>
 #include <QScrollArea>
@@ -1156,9 +1158,9 @@ void EditQuotationsDialog::setSecurity(Security *sec) {
 	quotationsView->clear();
 	i_quotation_decimals = security->quotationDecimals();
 	QList<QTreeWidgetItem *> items;
-	QMap<QDate, double>::const_iterator it_end = security->quotations.end();
-	for(QMap<QDate, double>::const_iterator it = security->quotations.constBegin(); it != it_end; ++it) {
-		items.append(new QuotationListViewItem(it.key(), it.value(), i_quotation_decimals, security->currency()));
+	items.reserve(security->quotations.count());
+	for(QuotationList::const_iterator it = security->quotations.constBegin(); it != security->quotations.constEnd(); ++it) {
+		items.append(new QuotationListViewItem(it->date(), it->value, i_quotation_decimals, security->currency()));
 	}
 	quotationsView->addTopLevelItems(items);
 	quotationsView->setSortingEnabled(true);
@@ -1169,14 +1171,15 @@ void EditQuotationsDialog::setSecurity(Security *sec) {
 }
 void EditQuotationsDialog::modifyQuotations() {
 	security->quotations.clear();
+	security->quotations.reserve(quotationsView->topLevelItemCount());
 	QTreeWidgetItemIterator it(quotationsView);
 	QuotationListViewItem *i = (QuotationListViewItem*) *it;
 	while(i) {
-		security->quotations[i->date] = i->value;
-		security->quotations_auto[i->date] = false;
+		security->quotations.append(i->date, i->value, false);
 		++it;
 		i = (QuotationListViewItem*) *it;
 	}
+	security->quotations.sort();
 }
 
 QString htmlize_string(QString str) {
@@ -1286,6 +1289,18 @@ bool EditQuotationsDialog::import(QString url, bool test, q_csv_info *ci) {
 	int row = 0;
 	QString line = fstream.readLine();
 
+	QHash<QDate, QuotationListViewItem*> date_items;
+	QList<QTreeWidgetItem*> new_items;
+	if(!test) {
+		QTreeWidgetItemIterator it(quotationsView);
+		QuotationListViewItem *i = (QuotationListViewItem*) *it;
+		while(i) {
+			date_items[i->date] = i;
+			++it;
+			i = (QuotationListViewItem*) *it;
+		}
+	}
+
 	int successes = 0;
 	int failed = 0;
 	bool missing_columns = false, value_error = false, date_error = false;
@@ -1401,20 +1416,15 @@ bool EditQuotationsDialog::import(QString url, bool test, q_csv_info *ci) {
 				if(test && ci->p1 + ci->p2 + ci->p3 + ci->p4 < 2 && ci->lz >= 0 && ci->value_format > 0) break;
 				if(test) success = false;
 				if(success) {
-					QTreeWidgetItemIterator it(quotationsView);
-					QuotationListViewItem *i = (QuotationListViewItem*) *it;
-					bool found = false;
-					while(i) {
-						if(i->date == date) {
-							i->value = value;
-							i->setText(1, security->currency()->formatValue(i->value, i->decimals));
-							found = true;
-							break;
-						}
-						++it;
-						i = (QuotationListViewItem*) *it;
+					QuotationListViewItem *i = date_items.value(date, NULL);
+					if(i) {
+						i->value = value;
+						i->setText(1, security->currency()->formatValue(i->value, i->decimals));
+					} else {
+						i = new QuotationListViewItem(date, value, i_quotation_decimals, security->currency());
+						date_items[date] = i;
+						new_items << i;
 					}
-					if(!found) quotationsView->insertTopLevelItem(0, new QuotationListViewItem(date, value, i_quotation_decimals, security->currency()));
 					successes++;
 				} else {
 					failed++;
@@ -1430,6 +1440,8 @@ bool EditQuotationsDialog::import(QString url, bool test, q_csv_info *ci) {
 		return true;
 	}
 
+	if(!new_items.isEmpty()) quotationsView->addTopLevelItems(new_items);
+
 	QString info = "", details = "";
 	if(successes > 0) {
 		info = tr("Successfully imported %n quote(s).", "", successes);
@@ -1981,20 +1993,19 @@ void ConfirmScheduleDialog::updateTransactions() {
 	settings.beginGroup("GeneralOptions");
 	QTime confirm_time = settings.value("scheduleConfirmationTime", QTime(18, 0)).toTime();
 	settings.endGroup();
-	for(ScheduledTransactionList<ScheduledTransaction*>::iterator it = budget->scheduledTransactions.begin(); it != budget->scheduledTransactions.end();) {
-		ScheduledTransaction *strans = *it;
-		if(strans->firstOccurrence() < QDate::currentDate() || (QTime::currentTime() >= confirm_time && strans->firstOccurrence() == QDate::currentDate())) {
-			bool b = strans->isOneTimeTransaction();
-			Transactions *trans = strans->realize(strans->firstOccurrence());
-			if(trans) {
-				new ConfirmScheduleListViewItem(transactionsView, trans);
-			}
-			if(b) budget->removeScheduledTransaction(strans);
-			else strans->setModified();
-			it = budget->scheduledTransactions.begin();
-		} else {
-			++it;
+	QDate last_date = QDate::currentDate();
+	if(QTime::currentTime() < confirm_time) last_date = last_date.addDays(-1);
+	//realizing an occurrence modifies the schedule, so work on a copy of the due occurrences
+	QVector<ScheduleOccurrence> occurrences = budget->getScheduleOccurrences(QDate(), last_date);
+	for(QVector<ScheduleOccurrence>::const_iterator it = occurrences.constBegin(); it != occurrences.constEnd(); ++it) {
+		ScheduledTransaction *strans = it->strans;
+		bool b = strans->isOneTimeTransaction();
+		Transactions *trans = strans->realize(it->date);
+		if(trans) {
+			new ConfirmScheduleListViewItem(transactionsView, trans);
 		}
+		if(b) budget->removeScheduledTransaction(strans);
+		else strans->setModified();
 	}
 	transactionsView->setSortingEnabled(true);
 	QTreeWidgetItemIterator qit(transactionsView);
@@ -2472,6 +2483,7 @@ Eqonomize::Eqonomize() : QMainWindow() {
 
 	modified = false;
 	modified_auto_save = false;
+	modified_while_saving = false;
 
 	budget = new Budget();
 
@@ -2986,13 +2998,33 @@ Eqonomize::Eqonomize() : QMainWindow() {
 	connect(dateTimer, SIGNAL(timeout()), this, SLOT(checkDate()));
 	dateTimer->start(1000 * 60);
 
+	loadTimer = new QTimer(this);
+	loadTimer->setInterval(100);
+	connect(loadTimer, SIGNAL(timeout()), this, SLOT(loadPendingTransactions()));
+	saveTimer = new QTimer(this);
+	saveTimer->setInterval(100);
+	connect(saveTimer, SIGNAL(timeout()), this, SLOT(savePendingFile()));
+	transaction_changes = new TransactionChanges();
+	changesTimer = new QTimer(this);
+	changesTimer->setSingleShot(true);
+	changesTimer->setInterval(0);
+	connect(changesTimer, SIGNAL(timeout()), this, SLOT(emitTransactionsChanged()));
+	connect(this, SIGNAL(fileSaved(const QString&, const QString&)), this, SLOT(onFileSaved(const QString&, const QString&)));
+	loadProgressBar = new QProgressBar(this);
+	loadProgressBar->setRange(0, 100);
+	loadProgressBar->setFormat(tr("Loading transactions… %p%"));
+	statusBar()->addPermanentWidget(loadProgressBar, 1);
+	statusBar()->hide();
+
 	QLocalServer::removeServer("eqonomize");
 	server = new QLocalServer(this);
 	server->listen("eqonomize");
 	connect(server, SIGNAL(newConnection()), this, SLOT(serverNewConnection()));
 
 }
-Eqonomize::~Eqonomize() {}
+Eqonomize::~Eqonomize() {
+	delete transaction_changes;
+}
 
 void Eqonomize::serverNewConnection() {
 	socket = server->nextPendingConnection();
@@ -3082,7 +3114,7 @@ void Eqonomize::useExchangeRateForTransactionDate(bool b) {
 		filterAccounts();
 		updateScheduledTransactions();
 		updateSecurities();
-		emit transactionsModified();
+		notifyTransactionsReset();
 
 		QSettings settings;
 		settings.beginGroup("GeneralOptions");
@@ -3277,7 +3309,7 @@ void Eqonomize::updateColors() {
 	filterAccounts();
 	updateScheduledTransactions();
 	updateSecurities();
-	emit transactionsModified();
+	notifyTransactionsReset();
 }
 void Eqonomize::changeEvent(QEvent *e) {
 	if(e->type() == QEvent::PaletteChange || e->type() == QEvent::ApplicationPaletteChange) {
@@ -3294,7 +3326,7 @@ void Eqonomize::setDarkMode(bool b) {
 	filterAccounts();
 	updateScheduledTransactions();
 	updateSecurities();
-	emit transactionsModified();
+	notifyTransactionsReset();
 	QSettings settings;
 	settings.beginGroup("GeneralOptions");
 	settings.setValue("darkMode", b);
@@ -3597,6 +3629,7 @@ void Eqonomize::updateSecuritiesStatistics() {
 	securitiesStatLabel->setText(QString("<div align=\"right\"><b>%1</b> %4 &nbsp; <b>%2</b> %5 &nbsp; <b>%3</b> %6</div>").arg(tr("Total value:")).arg(tr("Cost:")).arg(tr("Profit:")).arg(budget->formatMoney(total_value), budget->formatMoney(total_cost)).arg(budget->formatMoney(total_profit)));
 }
 void Eqonomize::deleteSecurity() {
+	finishLoading();
 	SecurityListViewItem *i = (SecurityListViewItem*) selectedItem(securitiesView);
 	if(i == NULL) return;
 	Security *security = i->security();
@@ -3620,7 +3653,7 @@ void Eqonomize::deleteSecurity() {
 			expensesWidget->filterTransactions();
 			incomesWidget->filterTransactions();
 			transfersWidget->filterTransactions();
-			emit transactionsModified();
+			notifyTransactionsReset();
 		} else {
 			updateSecurityAccount(security->account());
 		}
@@ -4468,6 +4501,7 @@ bool Eqonomize::splitUpTransaction(SplitTransaction *split) {
 		Transactions *ltrans = split->getLink(i2);
 		if(ltrans) {
 			ltrans->removeLink(split);
+			budget->transactionModified(ltrans);
 			expensesWidget->onTransactionModified(ltrans, ltrans);
 			incomesWidget->onTransactionModified(ltrans, ltrans);
 			transfersWidget->onTransactionModified(ltrans, ltrans);
@@ -5118,6 +5152,7 @@ bool Eqonomize::newRefundRepayment(Transactions *trans) {
 			} else {
 				new_trans->addLink(trans);
 				trans->addLink(new_trans);
+				budget->transactionModified(trans);
 				if(new_trans->date() > QDate::currentDate()) {
 					ScheduledTransaction *strans = new ScheduledTransaction(budget, new_trans, NULL);
 					budget->addScheduledTransaction(strans);
@@ -5405,6 +5440,7 @@ void Eqonomize::createLink(QList<Transactions*> transactions, bool link_to) {
 					((SplitTransaction*) trans)->joinLinks();
 				}
 			}
+			budget->transactionModified(trans);
 			linksUpdated(trans);
 		}
 		if(link_trans->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE && ((Transaction*) link_trans)->parentSplit()) {
@@ -5412,6 +5448,7 @@ void Eqonomize::createLink(QList<Transactions*> transactions, bool link_to) {
 		} else if(link_trans->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
 			((SplitTransaction*) link_trans)->joinLinks();
 		}
+		budget->transactionModified(link_trans);
 		linksUpdated(link_trans);
 		setLinkTransaction(NULL);
 		updateTransactionActions();
@@ -5430,6 +5467,7 @@ void Eqonomize::createLink(QList<Transactions*> transactions, bool link_to) {
 					}
 				}
 			}
+			budget->transactionModified(trans);
 			linksUpdated(trans);
 		}
 		for(int i = 0; i < transactions.count(); i++) {
@@ -5503,6 +5541,7 @@ void Eqonomize::removeOldLinks(Transactions *trans, Transactions *oldtrans) {
 		Transactions *ltrans = oldtrans->getLink(i, false);
 		if(ltrans) {
 			if(ltrans->removeLink(trans)) {
+				budget->transactionModified(ltrans);
 				linksUpdated(ltrans);
 				b = true;
 			}
@@ -5516,6 +5555,7 @@ void Eqonomize::addTransactionLinks(Transactions *trans, bool update_display) {
 		Transactions *ltrans = trans->getLink(i, false);
 		if(ltrans) {
 			ltrans->addLink(trans);
+			budget->transactionModified(ltrans);
 			if(update_display) linksUpdated(ltrans);
 		}
 	}
@@ -5619,10 +5659,12 @@ void Eqonomize::removeLink() {
 				trans->removeLink(index < 0 ? 0 : index);
 				tlink->removeLink(trans);
 			}
+			budget->transactionModified(tlink);
 			linksUpdated(tlink);
 		}
 		if(index >= 0) break;
 	}
+	budget->transactionModified(trans);
 	linksUpdated(trans);
 	updateTransactionActions();
 	setModified();
@@ -5726,6 +5768,7 @@ void Eqonomize::popupAccountsMenu(const QPoint &p) {
 }
 
 void Eqonomize::openLedger(AssetsAccount *account, bool reconcile) {
+	finishLoading();
 	LedgerDialog *dialog = new LedgerDialog(account, budget, this, tr("Ledger"), b_extra, reconcile);
 	dialog->show();
 	ledgers << dialog;
@@ -6087,7 +6130,10 @@ void Eqonomize::securitiesCurrentYear() {
 
 void Eqonomize::setModified(bool has_been_modified) {
 	modified_auto_save = has_been_modified;
-	if(has_been_modified) autoSave();
+	if(has_been_modified) {
+		modified_while_saving = true;
+		autoSave();
+	}
 	if(modified == has_been_modified) return;
 	modified = has_been_modified;
 	ActionFileSave->setEnabled(modified || !current_url.isValid());
@@ -6115,6 +6161,7 @@ void Eqonomize::createDefaultBudget() {
 	if(!cr_tmp_file.isEmpty()) {
 		QFile autosaveFile(cr_tmp_file);
 		autosaveFile.remove();
+		QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
 		cr_tmp_file = "";
 	}
 	settings.endGroup();
@@ -6140,7 +6187,7 @@ void Eqonomize::createDefaultBudget() {
 	setModified(false);
 	ActionFileSave->setEnabled(true);
 	emit accountsModified();
-	emit transactionsModified();
+	notifyTransactionsReset();
 	emit budgetUpdated();
 
 }
@@ -6267,7 +6314,7 @@ bool Eqonomize::openURL(const QUrl& url, bool merge) {
 
 	QString errors;
 	bool new_currency = false;
-	QString error = budget->loadFile(url.toLocalFile(), errors, &new_currency, merge, rename_duplicate_accounts, rename_duplicate_categories, rename_duplicate_securities, ignore_duplicate_transactions);
+	QString error = budget->loadFile(url.toLocalFile(), errors, &new_currency, merge, rename_duplicate_accounts, rename_duplicate_categories, rename_duplicate_securities, ignore_duplicate_transactions, !merge);
 	if(!error.isNull()) {
 		QMessageBox::critical(this, tr("Couldn't open file"), tr("Error loading %1: %2.").arg(url.toString()).arg(error));
 		return false;
@@ -6286,6 +6333,7 @@ bool Eqonomize::openURL(const QUrl& url, bool merge) {
 		if(!cr_tmp_file.isEmpty()) {
 			QFile autosaveFile(cr_tmp_file);
 			autosaveFile.remove();
+			QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
 			cr_tmp_file = "";
 		}
 		settings.endGroup();
@@ -6310,7 +6358,7 @@ bool Eqonomize::openURL(const QUrl& url, bool merge) {
 	}
 
 	emit accountsModified();
-	emit transactionsModified();
+	notifyTransactionsReset();
 	emit budgetUpdated();
 
 	setModified(false);
@@ -6318,9 +6366,104 @@ bool Eqonomize::openURL(const QUrl& url, bool merge) {
 
 	checkSchedule(true, this);
 
+	//older transactions are added in the background
+	if(budget->isLoading() && !loadTimer->isActive()) {
+		loadProgressBar->setValue(budget->loadingProgress());
+		statusBar()->show();
+		loadTimer->start();
+	}
+
 	return true;
 
 }
+void Eqonomize::loadPendingTransactions() {
+	if(!loadTimer->isActive()) return;
+	int prev_progress = budget->loadingProgress();
+	QString errors;
+	if(!budget->loadPendingTransactions(errors)) {
+		if(budget->loadingProgress() == prev_progress) return;
+		loadProgressBar->setValue(budget->loadingProgress());
+		filterAccounts();
+		expensesWidget->transactionsReset();
+		incomesWidget->transactionsReset();
+		transfersWidget->transactionsReset();
+		updateSecurities();
+		return;
+	}
+	loadTimer->stop();
+	statusBar()->hide();
+	reloadBudget();
+	notifyTransactionsReset();
+	emit budgetUpdated();
+	emit loadingFinished();
+	disconnect(this, SIGNAL(loadingFinished()), this, NULL);
+	if(!errors.isEmpty()) {
+		QMessageBox::critical(this, tr("Error"), errors);
+	}
+}
+void Eqonomize::finishLoading() {
+	if(!budget->isLoading()) return;
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	budget->finishLoading();
+	QApplication::restoreOverrideCursor();
+	loadPendingTransactions();
+}
+bool Eqonomize::savePendingFile(bool wait) {
+	//returns true if the file has been saved
+	if(!saveTimer->isActive()) return false;
+	QString error;
+	if(!budget->savingFinished(error, wait)) return false;
+	saveTimer->stop();
+	QString filename = pending_save_file;
+	pending_save_file = QString();
+	emit fileSaved(filename, error);
+	return error.isNull();
+}
+bool Eqonomize::finishSaving() {
+	if(!saveTimer->isActive()) return true;
+	QApplication::setOverrideCursor(Qt::WaitCursor);
+	bool b = savePendingFile(true);
+	QApplication::restoreOverrideCursor();
+	return b;
+}
+void Eqonomize::onFileSaved(const QString &filename, const QString &error) {
+	if(filename == cr_tmp_file) {
+		if(error.isNull()) {
+			QSettings settings;
+			settings.beginGroup("GeneralOptions");
+			settings.setValue("lastURL", current_url.url());
+			settings.endGroup();
+			settings.sync();
+		}
+		return;
+	}
+	if(!error.isNull()) {
+		QMessageBox::critical(this, tr("Couldn't save file"), tr("Error saving %1: %2.").arg(QUrl::fromLocalFile(filename).toString()).arg(error));
+		setModified(true);
+		return;
+	}
+	if(filename != current_url.toLocalFile()) return;
+	QSettings settings;
+	settings.beginGroup("GeneralOptions");
+	settings.setValue("lastURL", current_url.url());
+	settings.endGroup();
+	//changes made while the file was written in the background are only found in the crash recovery file
+	if(!modified_while_saving && !cr_tmp_file.isEmpty()) {
+		QFile autosaveFile(cr_tmp_file);
+		autosaveFile.remove();
+		QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
+		cr_tmp_file = "";
+	}
+	settings.sync();
+	updateRecentFiles(filename);
+	if(!modified_while_saving) setModified(false);
+}
+bool Eqonomize::waitForLoading(const char *member) {
+	//views that need all transactions are opened when loading has finished
+	if(!budget->isLoading()) return false;
+	connect(this, SIGNAL(loadingFinished()), this, member, Qt::UniqueConnection);
+	return true;
+}
 
 void Eqonomize::openSynchronizationSettings() {
 	syncDialog = new QDialog(this);
@@ -6463,8 +6606,9 @@ void Eqonomize::sync(bool do_save, bool on_load, QWidget *parent) {
 	}
 }
 
-bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync, QWidget *parent) {
+bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync, QWidget *parent, bool background) {
 	if(!parent) parent = this;
+	finishSaving();
 	bool exists = QFile::exists(url.toLocalFile());
 	if(exists) {
 		if(do_local_sync && url == current_url) {
@@ -6495,9 +6639,6 @@ bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync,
 				return false;
 			}
 		}
-		if(!QFile::exists(url.toLocalFile() + "~") || QFile::remove(url.toLocalFile() + "~")) {
-			QFile::copy(url.toLocalFile(), url.toLocalFile() + "~");
-		}
 		QFileInfo urlinfo(url.toLocalFile());
 		QDir urldir(urlinfo.absolutePath());
 		int i_backup_frequency = BACKUP_WEEKLY;
@@ -6525,8 +6666,10 @@ bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync,
 				save_backup = (last_backup_date <= QDate::currentDate());
 			}
 			if(save_backup) {
-				if(urlinfo.suffix().isEmpty()) QFile::copy(url.toLocalFile(), backupdir.absolutePath() + QString("/") + urlinfo.baseName() + QString("_") + QDate::currentDate().toString("yyyy-MM-dd"));
-				else QFile::copy(url.toLocalFile(), backupdir.absolutePath() + QString("/") + urlinfo.baseName() + QString("_") + QDate::currentDate().toString("yyyy-MM-dd") + QString(".") + urlinfo.suffix());
+				QString backup_file = backupdir.absolutePath() + QString("/") + urlinfo.baseName() + QString("_") + QDate::currentDate().toString("yyyy-MM-dd");
+				if(!urlinfo.suffix().isEmpty()) backup_file += QString(".") + urlinfo.suffix();
+				QFile::copy(url.toLocalFile(), backup_file);
+				if(QFile::exists(url.toLocalFile() + JOURNAL_FILE_SUFFIX)) QFile::copy(url.toLocalFile() + JOURNAL_FILE_SUFFIX, backup_file + JOURNAL_FILE_SUFFIX);
 			}
 		}
 	}
@@ -6535,7 +6678,18 @@ bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync,
 		sync(false);
 	}
 
-	QString error = budget->saveFile(url.toLocalFile(), QFile::ReadUser | QFile::WriteUser);
+	//an incremental save only appends to the journal, and leaves the file itself unchanged; decided after synchronization, which might require a full save
+	bool incremental = (exists && url == current_url && budget->canSaveIncrementally(url.toLocalFile()));
+	if(exists && !incremental && (!QFile::exists(url.toLocalFile() + "~") || QFile::remove(url.toLocalFile() + "~"))) {
+		QFile::copy(url.toLocalFile(), url.toLocalFile() + "~");
+		QFile::remove(url.toLocalFile() + "~" + JOURNAL_FILE_SUFFIX);
+		if(QFile::exists(url.toLocalFile() + JOURNAL_FILE_SUFFIX)) QFile::copy(url.toLocalFile() + JOURNAL_FILE_SUFFIX, url.toLocalFile() + "~" + JOURNAL_FILE_SUFFIX);
+	}
+
+	//in the background, the file is written from a snapshot of the transactions, and errors are reported by fileSaved()
+	QString error;
+	if(background) error = budget->startSaveFile(url.toLocalFile(), QFile::ReadUser | QFile::WriteUser, false, incremental);
+	else error = budget->saveFile(url.toLocalFile(), QFile::ReadUser | QFile::WriteUser, false, incremental);
 	if(!error.isNull()) {
 		QMessageBox::critical(parent, tr("Couldn't save file"), tr("Error saving %1: %2.").arg(url.toString()).arg(error));
 		return false;
@@ -6543,38 +6697,36 @@ bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync,
 	setWindowTitle(url.fileName() + "[*]");
 	current_url = url;
 	ActionFileReload->setEnabled(true);
-	QSettings settings;
-	settings.beginGroup("GeneralOptions");
-	settings.setValue("lastURL", current_url.url());
-	settings.endGroup();
-	if(!cr_tmp_file.isEmpty()) {
-		QFile autosaveFile(cr_tmp_file);
-		autosaveFile.remove();
-		cr_tmp_file = "";
+	modified_while_saving = false;
+	if(budget->isSaving()) {
+		//the crash recovery file is kept, and the file is marked as saved, when writing has finished
+		pending_save_file = url.toLocalFile();
+		saveTimer->start();
+	} else {
+		onFileSaved(url.toLocalFile(), QString());
 	}
-	settings.sync();
-	updateRecentFiles(url.toLocalFile());
-	setModified(false);
 
 	return true;
 }
 
 void Eqonomize::importCSV() {
+	finishLoading();
 	ImportCSVDialog *dialog = new ImportCSVDialog(b_extra, budget, this);
 	if(dialog->exec() == QDialog::Accepted) {
 		reloadBudget();
 		emit accountsModified();
-		emit transactionsModified();
+		notifyTransactionsReset();
 		setModified(true);
 	}
 	dialog->deleteLater();
 }
 
 void Eqonomize::importQIF() {
+	finishLoading();
 	if(importQIFFile(budget, this, b_extra)) {
 		reloadBudget();
 		emit accountsModified();
-		emit transactionsModified();
+		notifyTransactionsReset();
 		setModified(true);
 	}
 }
@@ -6598,6 +6750,7 @@ void Eqonomize::importEQZ() {
 }
 
 void Eqonomize::exportQIF() {
+	if(waitForLoading(SLOT(exportQIF()))) return;
 	exportQIFFile(budget, this, b_extra);
 }
 
@@ -6834,7 +6987,7 @@ void Eqonomize::currenciesModified() {
 		setModified(true);
 		budget->resetDefaultCurrencyChanged();
 	}
-	emit transactionsModified();
+	notifyTransactionsReset();
 	updateUsesMultipleCurrencies();
 	if(currencyConversionWindow) {
 		currencyConversionWindow->updateCurrencies();
@@ -6977,6 +7130,7 @@ void Eqonomize::openCurrencyConversion() {
 }
 
 void Eqonomize::showOverTimeReport() {
+	if(waitForLoading(SLOT(showOverTimeReport()))) return;
 	if(!otrDialog) {
 		otrDialog = new OverTimeReportDialog(budget, NULL);
 		QSettings settings;
@@ -6998,7 +7152,7 @@ void Eqonomize::showOverTimeReport() {
 		otrDialog->resize(dialog_size);
 		connect(this, SIGNAL(tagsModified()), ((OverTimeReportDialog*) otrDialog)->report, SLOT(updateTags()));
 		connect(this, SIGNAL(accountsModified()), ((OverTimeReportDialog*) otrDialog)->report, SLOT(updateAccounts()));
-		connect(this, SIGNAL(transactionsModified()), ((OverTimeReportDialog*) otrDialog)->report, SLOT(updateTransactions()));
+		connect(this, SIGNAL(transactionsChanged(const TransactionChanges&)), ((OverTimeReportDialog*) otrDialog)->report, SLOT(updateTransactions()));
 		connect(this, SIGNAL(timeToSaveConfig()), ((OverTimeReportDialog*) otrDialog)->report, SLOT(saveConfig()));
 	} else if(!otrDialog->isVisible()) {
 		((OverTimeReportDialog*) otrDialog)->report->resetOptions();
@@ -7010,6 +7164,7 @@ void Eqonomize::showOverTimeReport() {
 	otrDialog->activateWindow();
 }
 void Eqonomize::showCategoriesComparisonReport() {
+	if(waitForLoading(SLOT(showCategoriesComparisonReport()))) return;
 	if(!ccrDialog) {
 		ccrDialog = new CategoriesComparisonReportDialog(b_extra, budget, NULL);
 		QSettings settings;
@@ -7031,7 +7186,7 @@ void Eqonomize::showCategoriesComparisonReport() {
 		ccrDialog->resize(dialog_size);
 		connect(this, SIGNAL(tagsModified()), ((CategoriesComparisonReportDialog*) ccrDialog)->report, SLOT(updateTags()));
 		connect(this, SIGNAL(accountsModified()), ((CategoriesComparisonReportDialog*) ccrDialog)->report, SLOT(updateAccounts()));
-		connect(this, SIGNAL(transactionsModified()), ((CategoriesComparisonReportDialog*) ccrDialog)->report, SLOT(updateTransactions()));
+		connect(this, SIGNAL(transactionsChanged(const TransactionChanges&)), ((CategoriesComparisonReportDialog*) ccrDialog)->report, SLOT(transactionsChanged(const TransactionChanges&)));
 		connect(this, SIGNAL(timeToSaveConfig()), ((CategoriesComparisonReportDialog*) ccrDialog)->report, SLOT(saveConfig()));
 	} else if(!ccrDialog->isVisible()) {
 		((CategoriesComparisonReportDialog*) ccrDialog)->report->resetOptions();
@@ -7043,6 +7198,7 @@ void Eqonomize::showCategoriesComparisonReport() {
 	ccrDialog->activateWindow();
 }
 void Eqonomize::showOverTimeChart() {
+	if(waitForLoading(SLOT(showOverTimeChart()))) return;
 	if(!otcDialog) {
 		otcDialog = new OverTimeChartDialog(b_extra, budget, NULL);
 		QSettings settings;
@@ -7064,7 +7220,7 @@ void Eqonomize::showOverTimeChart() {
 		otcDialog->resize(dialog_size);
 		connect(this, SIGNAL(tagsModified()), ((OverTimeChartDialog*) otcDialog)->chart, SLOT(updateTags()));
 		connect(this, SIGNAL(accountsModified()), ((OverTimeChartDialog*) otcDialog)->chart, SLOT(updateAccounts()));
-		connect(this, SIGNAL(transactionsModified()), ((OverTimeChartDialog*) otcDialog)->chart, SLOT(updateTransactions()));
+		connect(this, SIGNAL(transactionsChanged(const TransactionChanges&)), ((OverTimeChartDialog*) otcDialog)->chart, SLOT(transactionsChanged(const TransactionChanges&)));
 		connect(this, SIGNAL(timeToSaveConfig()), ((OverTimeChartDialog*) otcDialog)->chart, SLOT(saveConfig()));
 	} else if(!otcDialog->isVisible()) {
 		((OverTimeChartDialog*) otcDialog)->chart->resetOptions();
@@ -7077,6 +7233,7 @@ void Eqonomize::showOverTimeChart() {
 }
 
 void Eqonomize::showCategoriesComparisonChart() {
+	if(waitForLoading(SLOT(showCategoriesComparisonChart()))) return;
 	if(!cccDialog) {
 		cccDialog = new CategoriesComparisonChartDialog(budget, NULL);
 		QSettings settings;
@@ -7097,7 +7254,7 @@ void Eqonomize::showCategoriesComparisonChart() {
 		}
 		cccDialog->resize(dialog_size);
 		connect(this, SIGNAL(accountsModified()), ((CategoriesComparisonChartDialog*) cccDialog)->chart, SLOT(updateAccounts()));
-		connect(this, SIGNAL(transactionsModified()), ((CategoriesComparisonChartDialog*) cccDialog)->chart, SLOT(updateTransactions()));
+		connect(this, SIGNAL(transactionsChanged(const TransactionChanges&)), ((CategoriesComparisonChartDialog*) cccDialog)->chart, SLOT(transactionsChanged(const TransactionChanges&)));
 		connect(this, SIGNAL(timeToSaveConfig()), ((CategoriesComparisonChartDialog*) cccDialog)->chart, SLOT(saveConfig()));
 	} else if(!cccDialog->isVisible()) {
 		((CategoriesComparisonChartDialog*) cccDialog)->chart->resetOptions();
@@ -8332,15 +8489,25 @@ bool Eqonomize::crashRecovery(QUrl url) {
 	if(url.isEmpty()) autosaveFileName += "UNSAVED EQZ";
 	else autosaveFileName += url.fileName();
 	QFileInfo fileinfo(autosaveFileName);
-	if(fileinfo.exists() && fileinfo.isWritable()) {
+	QFileInfo journalinfo(autosaveFileName + JOURNAL_FILE_SUFFIX);
+	//for a saved file, only the changes since the last save might have been auto-saved
+	bool changes_only = !fileinfo.exists() && !url.isEmpty() && journalinfo.exists() && journalinfo.isWritable();
+	if((fileinfo.exists() && fileinfo.isWritable()) || changes_only) {
 		if(QMessageBox::question(this, tr("Crash Recovery"), tr("%1 exited unexpectedly before the file was saved and data was lost.\nDo you want to load the last auto-saved version of the file?").arg(qApp->applicationDisplayName()), QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
 			QString errors;
 			bool new_currency = false;
-			QString error = budget->loadFile(autosaveFileName, errors, &new_currency);
+			QString error;
+			if(changes_only) {
+				error = budget->loadFile(url.toLocalFile(), errors, &new_currency);
+				if(error.isNull()) error = budget->loadRecoveryJournal(autosaveFileName, errors);
+			} else {
+				error = budget->loadFile(autosaveFileName, errors, &new_currency);
+			}
 			if(!error.isNull()) {
 				QMessageBox::critical(this, tr("Couldn't open file"), tr("Error loading %1: %2.").arg(autosaveFileName).arg(error));
 				QFile autosaveFile(autosaveFileName);
 				autosaveFile.remove();
+				QFile::remove(autosaveFileName + JOURNAL_FILE_SUFFIX);
 				return false;
 			}
 			if(!errors.isEmpty()) {
@@ -8351,9 +8518,11 @@ bool Eqonomize::crashRecovery(QUrl url) {
 			setWindowTitle(current_url.fileName() + "[*]");
 			QFile autosaveFile(autosaveFileName);
 			autosaveFile.remove();
+			QFile::remove(autosaveFileName + JOURNAL_FILE_SUFFIX);
 			if(!cr_tmp_file.isEmpty()) {
 				QFile autosaveFile2(cr_tmp_file);
 				autosaveFile2.remove();
+				QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
 				cr_tmp_file = "";
 			}
 
@@ -8363,7 +8532,7 @@ bool Eqonomize::crashRecovery(QUrl url) {
 
 			emit tagsModified();
 			emit accountsModified();
-			emit transactionsModified();
+			notifyTransactionsReset();
 			emit budgetUpdated();
 
 			setModified(true);
@@ -8374,6 +8543,7 @@ bool Eqonomize::crashRecovery(QUrl url) {
 		}
 		QFile autosaveFile(autosaveFileName);
 		autosaveFile.remove();
+		QFile::remove(autosaveFileName + JOURNAL_FILE_SUFFIX);
 	}
 	return false;
 
@@ -8385,7 +8555,8 @@ void Eqonomize::onAutoSaveTimeout() {
 	}
 }
 void Eqonomize::autoSave() {
-	if(auto_save_timeout) {
+	//retried at the next timeout if a file is being saved
+	if(auto_save_timeout && !budget->isSaving()) {
 		saveCrashRecovery();
 		modified_auto_save = false;
 		auto_save_timeout = false;
@@ -8410,12 +8581,22 @@ void Eqonomize::saveCrashRecovery() {
 		if(current_url.isEmpty()) cr_tmp_file += "UNSAVED EQZ";
 		else cr_tmp_file += current_url.fileName();
 	}
-	if(budget->saveFile(cr_tmp_file, QFile::ReadUser | QFile::WriteUser, true).isNull()) {
-		QSettings settings;
-		settings.beginGroup("GeneralOptions");
-		settings.setValue("lastURL", current_url.url());
-		settings.endGroup();
-		settings.sync();
+	if(current_url.isValid() && budget->canSaveRecoveryJournal(current_url.toLocalFile())) {
+		//only changes to transactions since the file was saved, which are replayed on the saved file
+		if(budget->saveRecoveryJournal(cr_tmp_file, QFile::ReadUser | QFile::WriteUser).isNull()) {
+			QFile::remove(cr_tmp_file);
+			QSettings settings;
+			settings.beginGroup("GeneralOptions");
+			settings.setValue("lastURL", current_url.url());
+			settings.endGroup();
+			settings.sync();
+		}
+		return;
+	}
+	QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
+	if(budget->startSaveFile(cr_tmp_file, QFile::ReadUser | QFile::WriteUser, true).isNull()) {
+		pending_save_file = cr_tmp_file;
+		saveTimer->start();
 	}
 }
 
@@ -8589,6 +8770,7 @@ void Eqonomize::fileNew() {
 	if(!cr_tmp_file.isEmpty()) {
 		QFile autosaveFile(cr_tmp_file);
 		autosaveFile.remove();
+		QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
 		cr_tmp_file = "";
 	}
 	settings.endGroup();
@@ -8601,7 +8783,7 @@ void Eqonomize::fileNew() {
 	ActionFileSave->setEnabled(true);
 	emit tagsModified();
 	emit accountsModified();
-	emit transactionsModified();
+	notifyTransactionsReset();
 	emit budgetUpdated();
 
 }
@@ -8628,7 +8810,7 @@ bool Eqonomize::fileSave() {
 	if(!current_url.isValid()) {
 		return fileSaveAs();
 	} else {
-		return saveURL(current_url);
+		return saveURL(current_url, true, true, NULL, true);
 	}
 	return false;
 }
@@ -8674,15 +8856,17 @@ bool Eqonomize::saveAs(bool do_local_sync, bool do_cloud_sync, QWidget *parent)
 }
 
 bool Eqonomize::askSave(bool) {
+	finishSaving();
 	if(!modified) return true;
 	int b_save = QMessageBox::warning(this, tr("Save file?"), tr("The current file has been modified. Do you want to save it?"), QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
 	if(b_save == QMessageBox::Yes) {
-		return fileSave();
+		return fileSave() && finishSaving();
 	}
 	if(b_save == QMessageBox::No) {
 		if(!cr_tmp_file.isEmpty()) {
 			QFile autosaveFile(cr_tmp_file);
 			autosaveFile.remove();
+			QFile::remove(cr_tmp_file + JOURNAL_FILE_SUFFIX);
 			cr_tmp_file = "";
 		}
 		return true;
@@ -8732,12 +8916,16 @@ bool Eqonomize::checkSchedule(bool update_display, QWidget *parent, bool allow_a
 			foreach(QString str, budget->newTags) tagAdded(str);
 			budget->newTags.clear();
 		}
+		QList<Transactions*> confirmed_transactions;
 		Transactions *trans = dialog->firstTransaction();
 		while(trans) {
-			addTransactionLinks(trans, false);
-			budget->addTransactions(trans);
+			confirmed_transactions << trans;
 			trans = dialog->nextTransaction();
 		}
+		budget->addTransactions(confirmed_transactions);
+		for(QList<Transactions*>::const_iterator it = confirmed_transactions.constBegin(); it != confirmed_transactions.constEnd(); ++it) {
+			addTransactionLinks(*it, false);
+		}
 		dialog->deleteLater();
 	}
 	if(b && update_display) {
@@ -8747,7 +8935,7 @@ bool Eqonomize::checkSchedule(bool update_display, QWidget *parent, bool allow_a
 		filterAccounts();
 		updateScheduledTransactions();
 		updateSecurities();
-		emit transactionsModified();
+		notifyTransactionsReset();
 		setModified(true);
 	}
 	return b;
@@ -8761,9 +8949,21 @@ void Eqonomize::endBatchEdit() {
 	if(in_batch_edit) {
 		in_batch_edit = false;
 		emit budgetUpdated();
-		emit transactionsModified();
+		notifyTransactionsReset();
 	}
 }
+void Eqonomize::notifyTransactionsReset() {
+	transaction_changes->setReset();
+	emitTransactionsChanged();
+}
+void Eqonomize::emitTransactionsChanged() {
+	//changes made during the same event loop iteration are sent together
+	changesTimer->stop();
+	if(transaction_changes->isEmpty()) return;
+	TransactionChanges changes = *transaction_changes;
+	transaction_changes->clear();
+	emit transactionsChanged(changes);
+}
 
 void Eqonomize::updateScheduledTransactions() {
 	scheduleView->clear();
@@ -9017,6 +9217,7 @@ void Eqonomize::balanceAccount() {
 }
 void Eqonomize::balanceAccount(Account *i_account) {
 	if(!i_account) return;
+	finishLoading();
 	if(i_account->type() != ACCOUNT_TYPE_ASSETS || ((AssetsAccount*) i_account)->isSecurities()) return;
 	AssetsAccount *account = (AssetsAccount*) i_account;
 	double book_value = account->initialBalance();
@@ -9469,6 +9670,7 @@ void Eqonomize::accountMoved(QTreeWidgetItem *i, QTreeWidgetItem *target) {
 	}
 }
 void Eqonomize::deleteAccount() {
+	finishLoading();
 	QTreeWidgetItem *i = selectedItem(accountsView);
 	if(!account_items.contains(i)) return;
 	Account *account = account_items[i];
@@ -9629,7 +9831,7 @@ void Eqonomize::deleteAccount() {
 			transfersWidget->updateAccounts();
 			incomesWidget->updateAccounts();
 			emit accountsModified();
-			emit transactionsModified();
+			notifyTransactionsReset();
 			setModified(true);
 			updateUsesMultipleCurrencies();
 		}
@@ -9720,6 +9922,7 @@ void Eqonomize::newTag() {
 	}
 }
 void Eqonomize::deleteTag() {
+	finishLoading();
 	QTreeWidgetItem *i = selectedItem(accountsView);
 	if(!tag_items.contains(i)) return;
 	QString tag = tag_items[i];
@@ -9760,6 +9963,7 @@ void Eqonomize::deleteTag() {
 	emit tagsModified();
 }
 void Eqonomize::renameTag() {
+	finishLoading();
 	QTreeWidgetItem *i = selectedItem(accountsView);
 	if(!tag_items.contains(i)) return;
 	QString tag = tag_items[i];
@@ -9851,12 +10055,16 @@ void Eqonomize::transactionAdded(Transactions *transs) {
 			break;
 		}
 	}
-	if(!in_batch_edit) emit transactionsModified();
+	if(!in_batch_edit) {
+		transaction_changes->transactionAdded(transs);
+		changesTimer->start();
+	}
 	expensesWidget->onTransactionAdded(transs);
 	incomesWidget->onTransactionAdded(transs);
 	transfersWidget->onTransactionAdded(transs);
 }
 void Eqonomize::transactionModified(Transactions *transs, Transactions *oldtranss) {
+	budget->transactionModified(transs);
 	setModified(true);
 	if(transs == link_trans || oldtranss == link_trans) setLinkTransaction(transs);
 	switch(transs->generaltype()) {
@@ -9932,7 +10140,10 @@ void Eqonomize::transactionModified(Transactions *transs, Transactions *oldtrans
 			break;
 		}
 	}
-	if(!in_batch_edit) emit transactionsModified();
+	if(!in_batch_edit) {
+		transaction_changes->transactionModified(transs, oldtranss);
+		changesTimer->start();
+	}
 	expensesWidget->onTransactionModified(transs, oldtranss);
 	incomesWidget->onTransactionModified(transs, oldtranss);
 	transfersWidget->onTransactionModified(transs, oldtranss);
@@ -9944,6 +10155,7 @@ bool Eqonomize::removeTransactionLinks(Transactions *trans) {
 		Transactions *ltrans = trans->getLink(i, false);
 		if(ltrans) {
 			ltrans->removeLink(trans);
+			budget->transactionModified(ltrans);
 			linksUpdated(ltrans);
 			b = true;
 		}
@@ -10024,7 +10236,10 @@ void Eqonomize::transactionRemoved(Transactions *transs, Transactions *oldvalue,
 			break;
 		}
 	}
-	if(!in_batch_edit) emit transactionsModified();
+	if(!in_batch_edit) {
+		transaction_changes->transactionRemoved(oldvalue);
+		changesTimer->start();
+	}
 	expensesWidget->onTransactionRemoved(transs);
 	incomesWidget->onTransactionRemoved(transs);
 	transfersWidget->onTransactionRemoved(transs);
@@ -10313,28 +10528,27 @@ void Eqonomize::addScheduledTransactionValue(ScheduledTransaction *strans, bool
 		}
 		return addTransactionValue((Transaction*) strans->transaction(), strans->transaction()->date(), update_value_display, subtract, -1, -1, NULL);
 	}
-	Recurrence *rec = strans->recurrence();
-	QDate curdate = rec->firstOccurrence();
+	QVector<QDate> dates;
+	budget->getScheduleOccurrences(strans, QDate(), to_date, dates);
 	int b_future = 1;
 	if(to_date <= QDate::currentDate()) b_future = 0;
 	else if(strans->transaction()->date() <= QDate::currentDate()) b_future = -1;
-	while(!curdate.isNull() && curdate <= to_date) {
+	for(QVector<QDate>::const_iterator it = dates.constBegin(); it != dates.constEnd(); ++it) {
 		if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
 			SplitTransaction *split = (SplitTransaction*) strans->transaction();
 			int c = split->count();
 			for(int i = 0; i < c; i++) {
-				addTransactionValue(split->at(i), curdate, update_value_display, subtract, 1, b_future, NULL);
+				addTransactionValue(split->at(i), *it, update_value_display, subtract, 1, b_future, NULL);
 			}
 		} else {
-			addTransactionValue((Transaction*) strans->transaction(), curdate, update_value_display, subtract, 1, b_future, NULL);
+			addTransactionValue((Transaction*) strans->transaction(), *it, update_value_display, subtract, 1, b_future, NULL);
 		}
-		curdate = rec->nextOccurrence(curdate);
 	}
 }
 void Eqonomize::subtractTransactionValue(Transaction *trans, bool update_value_display) {
 	addTransactionValue(trans, trans->date(), update_value_display, true);
 }
-void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate, bool update_value_display, bool subtract, int n, int b_future, const QDate *monthdate) {
+void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate, bool update_value_display, bool subtract, int n, int b_future, const QDate *monthdate, bool include_assets) {
 	if(n == 0) return;
 	bool b_filter_to = n < 0 && transdate > to_date;
 	bool b_from = accountsPeriodFromButton->isChecked();
@@ -10489,7 +10703,7 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			break;
 		}
 		case ACCOUNT_TYPE_ASSETS: {
-			if(b_lastmonth) break;
+			if(b_lastmonth || !include_assets) break;
 			if(((AssetsAccount*) trans->fromAccount())->accountType() == ASSETS_TYPE_SECURITIES) {
 				if(update_value_display) {
 					updateSecurityAccount((AssetsAccount*) trans->fromAccount(), false);
@@ -10684,7 +10898,7 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			break;
 		}
 		case ACCOUNT_TYPE_ASSETS: {
-			if(b_lastmonth) break;
+			if(b_lastmonth || !include_assets) break;
 			if(((AssetsAccount*) trans->toAccount())->accountType() == ASSETS_TYPE_SECURITIES) {
 				if(update_value_display) {
 					updateSecurityAccount((AssetsAccount*) trans->toAccount(), false);
@@ -11429,12 +11643,23 @@ void Eqonomize::filterAccounts() {
 			account_change[aaccount] = 0.0;
 			updateSecurityAccount(aaccount, false);
 		} else {
-			account_value[aaccount] = aaccount->initialBalance();
-			account_change[aaccount] = 0.0;
+			//balances of recorded transactions are read from the budget's balance timeline instead of summed in the transaction scan below
+			if(aaccount == budget->balancingAccount) {
+				account_value[aaccount] = aaccount->initialBalance();
+				account_change[aaccount] = 0.0;
+			} else {
+				account_value[aaccount] = budget->accountBalance(aaccount, to_date);
+				if(accountsPeriodFromButton->isChecked()) account_change[aaccount] = budget->accountBalanceChange(aaccount, from_date, to_date);
+				else account_change[aaccount] = budget->accountBalance(aaccount, to_date, false);
+			}
 			if(is_debt) liabilities_accounts_value += aaccount->currency()->convertTo(account_value[aaccount], budget->defaultCurrency(), to_date);
 			else assets_accounts_value += aaccount->currency()->convertTo(account_value[aaccount], budget->defaultCurrency(), to_date);
 			if(is_debt) liabilities_group_value[s_group] += aaccount->currency()->convertTo(account_value[aaccount], budget->defaultCurrency(), to_date);
 			else assets_group_value[s_group] += aaccount->currency()->convertTo(account_value[aaccount], budget->defaultCurrency(), to_date);
+			if(is_debt) liabilities_accounts_change += aaccount->currency()->convertTo(account_change[aaccount], budget->defaultCurrency(), to_date);
+			else assets_accounts_change += aaccount->currency()->convertTo(account_change[aaccount], budget->defaultCurrency(), to_date);
+			if(is_debt) liabilities_group_change[s_group] += aaccount->currency()->convertTo(account_change[aaccount], budget->defaultCurrency(), to_date);
+			else assets_group_change[s_group] += aaccount->currency()->convertTo(account_change[aaccount], budget->defaultCurrency(), to_date);
 		}
 	}
 	QDate monthdate, monthdate_begin;
@@ -11498,7 +11723,55 @@ void Eqonomize::filterAccounts() {
 	bool b_future = false;
 	bool b_past = (curdate >= to_date);
 	updateBudgetAccountTitle();
-	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
+	TransactionList<Transaction*>::const_iterator it_begin = budget->transactions.constBegin();
+	QDate aggregates_last = monthdate_begin;
+	if(b_from && budget->firstBudgetDay(from_date) < aggregates_last) aggregates_last = budget->firstBudgetDay(from_date);
+	aggregates_last = aggregates_last.addDays(-1);
+	if(it_begin != budget->transactions.constEnd() && (*it_begin)->date() <= aggregates_last && !budget->usesMultipleCurrencies() && budget->budgetMonthAggregatesAreExact()) {
+		//complete budget months before the monthly budget period (and before the from date) are read from the monthly aggregates, with the same sums as addTransactionValue()
+		QDate aggregates_first = budget->firstBudgetDay((*it_begin)->date());
+		QMap<QDate, QHash<Account*, BudgetMonthAggregate> > aggregates;
+		budget->getBudgetMonthAggregates(aggregates_first, budget->firstBudgetDay(aggregates_last), aggregates);
+		for(QMap<QDate, QHash<Account*, BudgetMonthAggregate> >::const_iterator it_month = aggregates.constBegin(); it_month != aggregates.constEnd(); ++it_month) {
+			for(QHash<Account*, BudgetMonthAggregate>::const_iterator it_cat = it_month->constBegin(); it_cat != it_month->constEnd(); ++it_cat) {
+				Account *account = it_cat.key();
+				Account *top = (account != account->topAccount() ? account->topAccount() : NULL);
+				double value_from = it_cat->value_from, value_to = it_cat->value_to;
+				if(account->type() == ACCOUNT_TYPE_EXPENSES) {
+					account_value[account] += value_to - value_from;
+					if(top) account_value[top] += value_to - value_from;
+					expenses_accounts_value += value_to - value_from;
+					if(!b_from) {
+						account_change[account] += value_to - value_from;
+						if(top) {
+							account_value[top] -= value_from;
+							account_change[top] += value_to;
+						}
+						expenses_accounts_change += value_to - value_from;
+					}
+				} else if(account->type() == ACCOUNT_TYPE_INCOMES) {
+					account_value[account] += value_from - value_to;
+					if(top) account_value[top] += value_from;
+					incomes_accounts_value += value_from - value_to;
+					if(!b_from) {
+						account_change[account] += value_from - value_to;
+						if(top) account_change[top] += value_from - value_to;
+						incomes_accounts_change += value_from - value_to;
+					}
+				}
+			}
+		}
+		QMap<QDate, QHash<QString, BudgetMonthAggregate> > tag_aggregates;
+		budget->getBudgetMonthTagAggregates(aggregates_first, budget->firstBudgetDay(aggregates_last), tag_aggregates);
+		for(QMap<QDate, QHash<QString, BudgetMonthAggregate> >::const_iterator it_month = tag_aggregates.constBegin(); it_month != tag_aggregates.constEnd(); ++it_month) {
+			for(QHash<QString, BudgetMonthAggregate>::const_iterator it_tag = it_month->constBegin(); it_tag != it_month->constEnd(); ++it_tag) {
+				tag_value[it_tag.key()] += it_tag->value_from - it_tag->value_to;
+				if(!b_from) tag_change[it_tag.key()] += it_tag->value_from - it_tag->value_to;
+			}
+		}
+		it_begin = std::upper_bound(it_begin, budget->transactions.constEnd(), aggregates_last, date_transaction_less_than);
+	}
+	for(TransactionList<Transaction*>::const_iterator it = it_begin; it != budget->transactions.constEnd(); ++it) {
 		Transaction *trans = *it;
 		if(trans->date() > lastmonth) break;
 		if(!b_past && !b_future && trans->date() >= curmonth_begin) b_future = true;
@@ -11515,9 +11788,9 @@ void Eqonomize::filterAccounts() {
 					account_month[eaccount][monthdate] = 0.0;
 				}
 			}
-			addTransactionValue(trans, trans->date(), false, false, -1, b_future, &monthdate);
+			addTransactionValue(trans, trans->date(), false, false, -1, b_future, &monthdate, false);
 		} else {
-			addTransactionValue(trans, trans->date(), false, false, -1, b_future, NULL);
+			addTransactionValue(trans, trans->date(), false, false, -1, b_future, NULL, false);
 		}
 	}
 	while(lastmonth >= monthdate) {
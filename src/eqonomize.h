@@ -92,6 +92,8 @@ class QLocalServer;
 class QPrinter;
 class QDialog;
 class QNetworkReply;
+class QProgressBar;
+class QTimer;
 class TagMenu;
 
 class CategoriesComparisonChart;
@@ -105,6 +107,7 @@ class CategoryAccount;
 class ExpensesAccount;
 class LoanAccount;
 class Budget;
+class TransactionChanges;
 class Currency;
 class ConfirmScheduleListViewItem;
 class EqonomizeMonthSelector;
@@ -135,12 +138,14 @@ class Eqonomize : public QMainWindow {
 		virtual ~Eqonomize();
 
 		void sync(bool do_save = true, bool on_load = false, QWidget *parent = NULL);
-		bool saveURL(const QUrl& url, bool do_local_sync = true, bool do_cloud_sync = true, QWidget *parent = NULL);
+		bool saveURL(const QUrl& url, bool do_local_sync = true, bool do_cloud_sync = true, QWidget *parent = NULL, bool background = false);
 		bool saveAs(bool do_local_sync = true, bool do_cloud_sync = true, QWidget *parent = NULL);
 		bool askSave(bool before_exit = false);
 		void createDefaultBudget();
 		void readFileDependentOptions();
 		void openLedger(AssetsAccount *account, bool reconcile = false);
+		void finishLoading();
+		bool finishSaving();
 
 		Budget *budget;
 
@@ -150,6 +155,9 @@ class Eqonomize : public QMainWindow {
 		void startBatchEdit();
 		void endBatchEdit();
 
+		TransactionChanges *transaction_changes;
+		void notifyTransactionsReset();
+
 		void appendFilterExpense(Expense *expense, bool update_total_cost, bool update_accounts);
 		void appendFilterIncome(Income *income, bool update_total_income, bool update_accounts);
 		void appendFilterTransfer(Transfer *transfer, bool update_total_amount, bool update_accounts);
@@ -157,7 +165,7 @@ class Eqonomize : public QMainWindow {
 		void subtractScheduledTransactionValue(ScheduledTransaction *strans, bool update_value_display);
 		void addScheduledTransactionValue(ScheduledTransaction *strans, bool update_value_display, bool subtract = false);
 		void subtractTransactionValue(Transaction *trans, bool update_value_display);
-		void addTransactionValue(Transaction *trans, const QDate &transdate, bool update_value_display, bool subtract = false, int n = -1, int b_future = -1, const QDate *monthdate = NULL);
+		void addTransactionValue(Transaction *trans, const QDate &transdate, bool update_value_display, bool subtract = false, int n = -1, int b_future = -1, const QDate *monthdate = NULL, bool include_assets = true);
 		void appendIncomesAccount(IncomesAccount *account, QTreeWidgetItem *parent_item);
 		void appendExpensesAccount(ExpensesAccount *account, QTreeWidgetItem *parent_item);
 		void assetsAccountItemHiddenOrRemoved(AssetsAccount *account);
@@ -279,7 +287,7 @@ class Eqonomize : public QMainWindow {
 
 		QUrl current_url;
 		double period_months, from_to_months;
-		bool modified, modified_auto_save, auto_save_timeout;
+		bool modified, modified_auto_save, modified_while_saving, auto_save_timeout;
 		QDate from_date, to_date, frommonth_begin, prevmonth_begin;
 		QDate securities_from_date, securities_to_date;
 		QDate prev_cur_date;
@@ -356,6 +364,12 @@ class Eqonomize : public QMainWindow {
 		QCheckBox *syncAutoBox;
 		QTreeWidgetItem *clicked_item;
 
+		QTimer *loadTimer, *saveTimer, *changesTimer;
+		QString pending_save_file;
+		QProgressBar *loadProgressBar;
+
+		bool waitForLoading(const char *member);
+
 	protected slots:
 
 		void checkAvailableVersion_readdata();
@@ -371,6 +385,10 @@ class Eqonomize : public QMainWindow {
 		void saveCrashRecovery();
 		void autoSave();
 		void onAutoSaveTimeout();
+		void loadPendingTransactions();
+		bool savePendingFile(bool wait = false);
+		void emitTransactionsChanged();
+		void onFileSaved(const QString&, const QString&);
 
 		void updateColumnWidths();
 		void updateAccountColumnWidths();
@@ -588,10 +606,12 @@ class Eqonomize : public QMainWindow {
 	signals:
 
 		void accountsModified();
-		void transactionsModified();
+		void transactionsChanged(const TransactionChanges&);
 		void budgetUpdated();
 		void timeToSaveConfig();
 		void tagsModified();
+		void loadingFinished();
+		void fileSaved(const QString&, const QString&);
 
 };
 
@@ -1333,6 +1333,8 @@ bool ImportCSVDialog::import(bool test, csv_info *ci) {
 	QString new_ac1 = "", new_ac2 = "";
 	QDate curdate = QDate::currentDate();
 	QMap<QDate, qint64> datestamps;
+	QList<Transactions*> new_transactions;
+	QMultiHash<uint, Transaction*> new_transactions_by_key;
 	while(!line.isNull()) {
 		row++;
 		if((first_row == 0 && !line.isEmpty() && line[0] != '#') || (first_row > 0 && row >= first_row && !line.isEmpty())) {
@@ -1763,18 +1765,19 @@ bool ImportCSVDialog::import(bool test, csv_info *ci) {
 					if(trans) {
 						trans->readTags(tags);
 						trans->setQuantity(quantity);
-						if(ignore_duplicates && budget->findDuplicateTransaction(trans)) {
+						if(ignore_duplicates && budget->findDuplicateTransaction(trans, new_transactions_by_key)) {
 							duplicates++;
 							successes--;
 							delete trans;
 						} else if(trans->date() > curdate) {
 							trans->setTimestamp(datestamps.contains(QDate::currentDate()) ? datestamps[QDate::currentDate()] + 1 : DATE_TO_MSECS(QDate::currentDate()) / 1000);
 							datestamps[QDate::currentDate()] = trans->timestamp();
-							budget->addScheduledTransaction(new ScheduledTransaction(budget, trans, NULL));
+							new_transactions << new ScheduledTransaction(budget, trans, NULL);
 						} else {
 							trans->setTimestamp(datestamps.contains(trans->date()) ? datestamps[trans->date()] + 1 : DATE_TO_MSECS(trans->date()) / 1000);
 							datestamps[trans->date()] = trans->timestamp();
-							budget->addTransaction(trans);
+							new_transactions << trans;
+							new_transactions_by_key.insert(transaction_duplicate_key(trans), trans);
 						}
 					}
 				} else {
@@ -1791,6 +1794,8 @@ bool ImportCSVDialog::import(bool test, csv_info *ci) {
 		return true;
 	}
 
+	budget->addTransactions(new_transactions);
+
 	QString info = "", details = "";
 	if(successes > 0) {
 		info = tr("Successfully imported %n transaction(s).", "", successes);
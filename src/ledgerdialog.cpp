@@ -384,7 +384,7 @@ LedgerDialog::LedgerDialog(AssetsAccount *acc, Budget *budg, Eqonomize *parent,
 	connect(printButton, SIGNAL(clicked()), this, SLOT(printView()));
 	connect(editAccountButton, SIGNAL(clicked()), this, SLOT(editAccount()));
 	connect(accountCombo, SIGNAL(activated(int)), this, SLOT(accountActivated(int)));
-	connect(mainWin, SIGNAL(transactionsModified()), this, SLOT(updateTransactions()));
+	connect(mainWin, SIGNAL(transactionsChanged(const TransactionChanges&)), this, SLOT(transactionsChanged(const TransactionChanges&)));
 	connect(mainWin, SIGNAL(accountsModified()), this, SLOT(updateAccounts()));
 	connect(reconcileButton, SIGNAL(toggled(bool)), this, SLOT(toggleReconciliation(bool)));
 	connect(markReconciledButton, SIGNAL(clicked()), this, SLOT(markAsReconciled()));
@@ -654,6 +654,7 @@ void LedgerDialog::transactionActivated(QTreeWidgetItem *i, int c) {
 			bool b = !trans->isReconciled(account);
 			trans->setReconciled(account, b);
 			trans->setModified();
+			budget->transactionModified(trans);
 			if(trans->isReconciled(account) == b) {
 				if(trans->date() <= reconcileEndEdit->date()) {
 					if(b) {
@@ -683,6 +684,7 @@ void LedgerDialog::reconcileTransactions() {
 			if(trans) {
 				trans->setReconciled(account, true);
 				trans->setModified();
+				budget->transactionModified(trans);
 				if(trans->isReconciled(account)) {
 					if(trans->date() <= reconcileEndEdit->date()) {
 						if(trans->date() < reconcileStartEdit->date()) d_rec_op += trans->accountChange(account);
@@ -717,6 +719,7 @@ void LedgerDialog::markAsReconciled() {
 				b_started = true;
 				trans->setReconciled(account, true);
 				trans->setModified();
+				budget->transactionModified(trans);
 				if(trans->isReconciled(account)) {
 					if(trans->date() <= reconcileEndEdit->date()) {
 						if(trans->date() < reconcileStartEdit->date()) d_rec_op += trans->accountChange(account);
@@ -1484,6 +1487,10 @@ void LedgerDialog::edit(QTreeWidgetItem *qwi, int c) {
 		else if(i->transaction()) mainWin->editTransaction(i->transaction(), this);
 	}
 }
+void LedgerDialog::transactionsChanged(const TransactionChanges &changes) {
+	if(!changes.affectsAccount(account)) return;
+	updateTransactions();
+}
 void LedgerDialog::updateTransactions(bool update_reconciliation_date) {
 	expenseColor = QColor();
 	incomeColor = QColor();
@@ -1499,6 +1506,7 @@ void LedgerDialog::updateTransactions(bool update_reconciliation_date) {
 	}
 	int scrollpos = transactionsView->verticalScrollBar()->value();
 	transactionsView->clear();
+	//the running balance is summed here, rather than looked up in the balance timeline of the budget, since a row is created for every transaction anyway and the timeline only has the balance at the end of each day
 	double balance = account->initialBalance();
 	double total_balance = 0.0;
 	double previous_balance = 0.0;
@@ -42,6 +42,7 @@ class EqonomizeValueEdit;
 class Eqonomize;
 class AssetsAccount;
 class Budget;
+class TransactionChanges;
 
 class LedgerDialog : public QDialog {
 
@@ -97,6 +98,7 @@ class LedgerDialog : public QDialog {
 
 		void saveConfig();
 		void updateColumnWidths();
+		void transactionsChanged(const TransactionChanges&);
 
 	protected slots:
 
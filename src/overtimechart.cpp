@@ -103,6 +103,38 @@ struct chart_month_info {
 };
 extern QString last_picture_directory;
 
+void add_chart_month_value(Budget *budget, QVector<chart_month_info> *monthly_values, chart_month_info **mi, bool *isfirst, const QDate &date, const QDate &first_date, double value, double count) {
+	if(!(*mi) || date > (*mi)->date) {
+		QDate newdate, olddate;
+		newdate = budget->lastBudgetDay(date);
+		if(*mi) {
+			olddate = (*mi)->date;
+			budget->addBudgetMonthsSetLast(olddate, 1);
+			(*isfirst) = false;
+		} else {
+			olddate = budget->lastBudgetDay(first_date);
+			(*isfirst) = true;
+		}
+		while(olddate < newdate) {
+			monthly_values->append(chart_month_info());
+			(*mi) = &monthly_values->back();
+			(*mi)->value = 0.0;
+			(*mi)->count = 0.0;
+			(*mi)->date = olddate;
+			budget->addBudgetMonthsSetLast(olddate, 1);
+			(*isfirst) = false;
+		}
+		monthly_values->append(chart_month_info());
+		(*mi) = &monthly_values->back();
+		(*mi)->value = value;
+		(*mi)->count = count;
+		(*mi)->date = newdate;
+	} else {
+		(*mi)->value += value;
+		(*mi)->count += count;
+	}
+}
+
 void calculate_minmax_lines(double &maxvalue, double &minvalue, int &y_lines, int &y_minor, bool minmaxequal = false, bool use_deciminor = true) {
 	if(minvalue > -0.01) minvalue = 0.0;
 	if(-minvalue > maxvalue) maxvalue = -minvalue;
@@ -1275,7 +1307,31 @@ void OverTimeChart::updateDisplay() {
 	double maxcount = 1.0;
 	bool started = false;
 	int tag_index = 0;
-	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd();) {
+	TransactionList<Transaction*>::const_iterator it_begin = budget->transactions.constBegin();
+	if(!current_assets && current_source2 >= -1 && current_source2 <= 4 && current_source <= 50 && budget->budgetMonthAggregatesAreExact()) {
+		//only complete budget months are displayed, all values are read from the monthly aggregates
+		it_begin = std::upper_bound(it_begin, budget->transactions.constEnd(), first_date.addDays(-1), date_transaction_less_than);
+		if(it_begin != budget->transactions.constEnd() && (*it_begin)->date() <= last_date) {
+			started = true;
+			if(type == 4) first_date = budget->firstBudgetDayOfYear((*it_begin)->date());
+			else first_date = budget->firstBudgetDay((*it_begin)->date());
+			QMap<QDate, QHash<Account*, BudgetMonthAggregate> > aggregates;
+			budget->getBudgetMonthAggregates(first_date, budget->firstBudgetDay(last_date), aggregates);
+			for(QMap<QDate, QHash<Account*, BudgetMonthAggregate> >::const_iterator it_month = aggregates.constBegin(); it_month != aggregates.constEnd(); ++it_month) {
+				for(QHash<Account*, BudgetMonthAggregate>::const_iterator it_cat = it_month->constBegin(); it_cat != it_month->constEnd(); ++it_cat) {
+					Account *account = it_cat.key();
+					if(it_cat->count <= 0) continue;
+					if(account->type() == ACCOUNT_TYPE_INCOMES && current_source2 != 2 && current_source2 != 4) {
+						add_chart_month_value(budget, &monthly_cats[account], &mi_c[account], &isfirst_c[account], it_month.key(), first_date, it_cat->value_from - it_cat->value_to, it_cat->quantity);
+					} else if(account->type() == ACCOUNT_TYPE_EXPENSES && current_source2 != 1 && current_source2 != 3) {
+						add_chart_month_value(budget, &monthly_cats[account], &mi_c[account], &isfirst_c[account], it_month.key(), first_date, it_cat->value_to - it_cat->value_from, it_cat->quantity);
+					}
+				}
+			}
+		}
+		it_begin = budget->transactions.constEnd();
+	}
+	for(TransactionList<Transaction*>::const_iterator it = it_begin; it != budget->transactions.constEnd();) {
 		Transaction *trans = *it;
 		if(trans->date() > last_date) break;
 		bool include = false;
@@ -1706,37 +1762,7 @@ void OverTimeChart::updateDisplay() {
 			}
 		}
 		if(include) {
-			if(!(*mi) || trans->date() > (*mi)->date) {
-				QDate newdate, olddate;
-				newdate = budget->lastBudgetDay(trans->date());
-				if(*mi) {
-					olddate = (*mi)->date;
-					budget->addBudgetMonthsSetLast(olddate, 1);
-					(*isfirst) = false;
-				} else {
-					olddate = budget->lastBudgetDay(first_date);
-					(*isfirst) = true;
-				}
-				while(olddate < newdate) {
-					monthly_values->append(chart_month_info());
-					(*mi) = &monthly_values->back();
-					(*mi)->value = 0.0;
-					(*mi)->count = 0.0;
-					(*mi)->date = olddate;
-					budget->addBudgetMonthsSetLast(olddate, 1);
-					(*isfirst) = false;
-				}
-				monthly_values->append(chart_month_info());
-				(*mi) = &monthly_values->back();
-				if(use_to_value) (*mi)->value = trans->toValue(do_convert) * sign;
-				else (*mi)->value = trans->value(do_convert) * sign;
-				(*mi)->count = trans->quantity();
-				(*mi)->date = newdate;
-			} else {
-				if(use_to_value) (*mi)->value += trans->toValue(do_convert) * sign;
-				else (*mi)->value += trans->value(do_convert) * sign;
-				(*mi)->count += trans->quantity();
-			}
+			add_chart_month_value(budget, monthly_values, mi, isfirst, trans->date(), first_date, (use_to_value ? trans->toValue(do_convert) : trans->value(do_convert)) * sign, trans->quantity());
 			if(monthly_values2) {
 				if(!(*mi2) || trans->date() > (*mi2)->date) {
 					QDate newdate, olddate;
@@ -2358,43 +2384,29 @@ void OverTimeChart::updateDisplay() {
 			}
 		}
 		if(include) {
-			QDate transdate = strans->firstOccurrence();
+			QVector<QDate> transdates;
+			budget->getScheduleOccurrences(strans, first_date, last_date, transdates);
 			QVector<chart_month_info>::iterator cmi_it = monthly_values->begin();
-			do {
-				if(transdate >= first_date) {
-					while(cmi_it->date < transdate) {
-						++cmi_it;
-					}
-					(*mi) = &(*cmi_it);
-					if(use_to_value) (*mi)->value += trans->toValue(do_convert) * sign;
-					else (*mi)->value += trans->value(do_convert) * sign;
-					(*mi)->count += trans->quantity();
-					includes_scheduled = true;
+			for(QVector<QDate>::const_iterator date_it = transdates.constBegin(); date_it != transdates.constEnd(); ++date_it) {
+				while(cmi_it->date < *date_it) {
+					++cmi_it;
 				}
-				if(strans->recurrence()) {
-					transdate = strans->recurrence()->nextOccurrence(transdate);
-				} else {
-					break;
-				}
-			} while(transdate <= last_date);
+				(*mi) = &(*cmi_it);
+				if(use_to_value) (*mi)->value += trans->toValue(do_convert) * sign;
+				else (*mi)->value += trans->value(do_convert) * sign;
+				(*mi)->count += trans->quantity();
+				includes_scheduled = true;
+			}
 			if(monthly_values2) {
-				transdate = strans->firstOccurrence();
 				cmi_it = monthly_values2->begin();
-				do {
-					if(transdate >= first_date) {
-						while(cmi_it->date < transdate) {
-							++cmi_it;
-						}
-						(*mi2) = &(*cmi_it);
-						(*mi2)->value += trans->value(do_convert) * sign * -1;
-						includes_scheduled = true;
-					}
-					if(strans->recurrence()) {
-						transdate = strans->recurrence()->nextOccurrence(transdate);
-					} else {
-						break;
+				for(QVector<QDate>::const_iterator date_it = transdates.constBegin(); date_it != transdates.constEnd(); ++date_it) {
+					while(cmi_it->date < *date_it) {
+						++cmi_it;
 					}
-				} while(transdate <= last_date);
+					(*mi2) = &(*cmi_it);
+					(*mi2)->value += trans->value(do_convert) * sign * -1;
+					includes_scheduled = true;
+				}
 			}
 		}
 		if(tag_index == 0) {
@@ -2656,12 +2668,13 @@ void OverTimeChart::updateDisplay() {
 				chart_month_info initial_cmi;
 				initial_cmi.date = it->date;
 				budget->addBudgetMonthsSetLast(initial_cmi.date, type == 4 ? -12 : -1);
+				CurrencyConverter &converter = budget->defaultCurrencyConverter(ass->currency());
 				if(current_assets) initial_cmi.value = acc_total;
-				else initial_cmi.value = ass->currency()->convertTo(acc_total, budget->defaultCurrency(), initial_cmi.date);
+				else initial_cmi.value = converter.convert(acc_total, initial_cmi.date);
 				while(it != it_e) {
 					acc_total += it->value;
 					if(current_assets) it->value = acc_total;
-					else it->value = ass->currency()->convertTo(acc_total, budget->defaultCurrency(), it->date);
+					else it->value = converter.convert(acc_total, it->date);
 					++it;
 				}
 				monthly_cats[ass].push_front(initial_cmi);
@@ -2679,9 +2692,14 @@ void OverTimeChart::updateDisplay() {
 			if(!current_assets || ass == current_assets) {
 				QVector<chart_month_info>::iterator it_b = monthly_cats[ass].begin();
 				QVector<chart_month_info>::iterator it_e = monthly_cats[ass].end();
-				while(it_b != it_e) {
-					if(current_assets) it_b->value += sec->value(it_b->date, -1);
-					else it_b->value += ass->currency()->convertTo(sec->value(it_b->date, -1), budget->defaultCurrency(), it_b->date);
+				QVector<QDate> dates;
+				dates.reserve(monthly_cats[ass].count());
+				for(QVector<chart_month_info>::const_iterator it_d = it_b; it_d != it_e; ++it_d) dates << it_d->date;
+				QVector<double> sec_values;
+				sec->values(dates, sec_values, -1);
+				if(!current_assets) budget->defaultCurrencyConverter(ass->currency()).convert(sec_values, dates);
+				for(int i = 0; it_b != it_e; i++) {
+					it_b->value += sec_values[i];
 					it_b++;
 				}
 			}
@@ -4151,6 +4169,11 @@ void OverTimeChart::resizeEvent(QResizeEvent *e) {
 	}
 }
 #endif
+void OverTimeChart::transactionsChanged(const TransactionChanges &changes) {
+	if(current_account && !changes.affectsAccount(current_account)) return;
+	if(!current_account && !current_tag.isEmpty() && !changes.affectsTag(current_tag)) return;
+	updateTransactions();
+}
 void OverTimeChart::updateTransactions() {
 	if(descriptionCombo->isEnabled() && (current_account || !current_tag.isEmpty())) {
 		bool b_tags = !current_account;
@@ -47,6 +47,7 @@ class QRadioButton;
 class CategoryAccount;
 class AssetsAccount;
 class Budget;
+class TransactionChanges;
 class EqonomizeMonthSelector;
 
 class OverTimeChart : public QWidget {
@@ -101,6 +102,7 @@ class OverTimeChart : public QWidget {
 		void descriptionChanged(int);
 		void payeeChanged(int);
 		void updateTransactions();
+		void transactionsChanged(const TransactionChanges&);
 		void updateAccounts();
 		void updateTags();
 		void updateDisplay();
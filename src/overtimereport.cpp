@@ -1116,7 +1116,51 @@ void OverTimeReport::updateDisplay() {
 		}
 	}
 
-	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
+	TransactionList<Transaction*>::const_iterator it_begin = budget->transactions.constBegin();
+	if(type == 0 && budget->budgetMonthAggregatesAreExact()) {
+		//complete budget months are read from the monthly aggregates, only the current month is scanned
+		QDate last_month = curdate;
+		if(!budget->isLastBudgetDay(last_month)) {
+			last_month = budget->lastBudgetDay(last_month);
+			budget->addBudgetMonthsSetLast(last_month, -1);
+		}
+		if(last_month >= first_date) {
+			QMap<QDate, QHash<Account*, BudgetMonthAggregate> > aggregates;
+			budget->getBudgetMonthAggregates(first_date, budget->firstBudgetDay(last_month), aggregates);
+			QDate last_included;
+			for(QMap<QDate, QHash<Account*, BudgetMonthAggregate> >::const_iterator it_month = aggregates.constBegin(); it_month != aggregates.constEnd(); ++it_month) {
+				for(QHash<Account*, BudgetMonthAggregate>::const_iterator it_cat = it_month->constBegin(); it_cat != it_month->constEnd(); ++it_cat) {
+					if(it_cat->count > 0) {
+						last_included = it_month.key();
+						break;
+					}
+				}
+			}
+			if(last_included.isValid()) {
+				started = true;
+				QDate month = first_date;
+				while(month <= last_included) {
+					monthly_values.append(month_info());
+					mi = &monthly_values.back();
+					mi->value = 0.0;
+					mi->expense = 0.0;
+					mi->count = 0.0;
+					mi->date = budget->lastBudgetDay(month);
+					QMap<QDate, QHash<Account*, BudgetMonthAggregate> >::const_iterator it_month = aggregates.constFind(month);
+					if(it_month != aggregates.constEnd()) {
+						for(QHash<Account*, BudgetMonthAggregate>::const_iterator it_cat = it_month->constBegin(); it_cat != it_month->constEnd(); ++it_cat) {
+							mi->value += it_cat->value_from;
+							mi->expense += it_cat->value_to;
+							mi->count += it_cat->quantity;
+						}
+					}
+					budget->addBudgetMonthsSetFirst(month, 1);
+				}
+			}
+			it_begin = std::upper_bound(it_begin, budget->transactions.constEnd(), last_month, date_transaction_less_than);
+		}
+	}
+	for(TransactionList<Transaction*>::const_iterator it = it_begin; it != budget->transactions.constEnd(); ++it) {
 		Transaction *trans = *it;
 		if(trans->date() > curdate) break;
 		bool include = false;
@@ -1451,8 +1495,8 @@ void OverTimeReport::updateDisplay() {
 			double total_value = 0.0, total_expense = 0.0;
 			for(AccountList<AssetsAccount*>::const_iterator it = budget->assetsAccounts.constBegin(); it != budget->assetsAccounts.constEnd(); ++it) {
 				AssetsAccount *account = *it;
-				if(account->accountType() == ASSETS_TYPE_LIABILITIES || account->accountType() == ASSETS_TYPE_CREDIT_CARD) total_expense += account->currency()->convertTo(account->initialBalance(false), budget->defaultCurrency(), start_date);
-				else total_value += account->currency()->convertTo(account->initialBalance(false), budget->defaultCurrency(), start_date);
+				if(account->accountType() == ASSETS_TYPE_LIABILITIES || account->accountType() == ASSETS_TYPE_CREDIT_CARD) total_expense += budget->defaultCurrencyConverter(account->currency()).convert(account->initialBalance(false), start_date);
+				else total_value += budget->defaultCurrencyConverter(account->currency()).convert(account->initialBalance(false), start_date);
 			}
 			QVector<month_info>::iterator it_b = monthly_values.begin();
 			QVector<month_info>::iterator it_e = monthly_values.end();
@@ -1463,12 +1507,18 @@ void OverTimeReport::updateDisplay() {
 				it_b->expense = total_expense;
 				it_b++;
 			}
+			QVector<QDate> dates;
+			dates.reserve(monthly_values.count());
+			for(it_b = monthly_values.begin(); it_b != monthly_values.end(); ++it_b) dates << it_b->date;
+			QVector<double> sec_values;
 			for(SecurityList<Security*>::const_iterator it = budget->securities.constBegin(); it != budget->securities.constEnd(); ++it) {
 				Security *sec = *it;
+				sec->values(dates, sec_values, -1);
+				budget->defaultCurrencyConverter(sec->currency()).convert(sec_values, dates);
 				it_b = monthly_values.begin();
 				it_e = monthly_values.end();
-				while(it_b != it_e) {
-					it_b->value += sec->currency()->convertTo(sec->value(it_b->date, -1), budget->defaultCurrency(), it_b->date);
+				for(int i = 0; it_b != it_e; i++) {
+					it_b->value += sec_values[i];
 					it_b++;
 				}
 			}
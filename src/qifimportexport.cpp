@@ -729,7 +729,7 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 	QString line = fstream.readLine().trimmed(), line_bak;
 	QString date_format = "", alt_date_format = "";
 	QList<Transfer*> transfers;
-	QList<Transfer*> previous_transfers;
+	QMultiHash<uint, Transfer*> previous_transfers;
 	QVector<qif_split> splits;
 	qif_split *current_split = NULL;
 	int type = -1;
@@ -810,6 +810,8 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 		}
 	}
 	QMap<QDate, qint64> datestamps;
+	QList<Transactions*> new_transactions;
+	QMultiHash<uint, Transaction*> new_transactions_by_key;
 	while(!line.isNull()) {
 		if(!line.isEmpty()) {
 			char field = line[0].toLatin1();
@@ -1155,8 +1157,9 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 										if(current_split->value < 0.0) tra = new Transfer(budget, -current_split->value, date, qi.current_account, acc, current_split->memo);
 										else tra = new Transfer(budget, current_split->value, date, acc, qi.current_account, current_split->memo);
 										bool duplicate = false;
-										QList<Transfer*>::iterator it_e = previous_transfers.end();
-										for(QList<Transfer*>::iterator it = previous_transfers.begin(); it != it_e; ++it) {
+										uint key = transaction_duplicate_key(tra);
+										QMultiHash<uint, Transfer*>::const_iterator it_e = previous_transfers.constEnd();
+										for(QMultiHash<uint, Transfer*>::const_iterator it = previous_transfers.constFind(key); it != it_e && it.key() == key; ++it) {
 											if(tra->equals(*it, false)) {
 												duplicate = true;
 												break;
@@ -1164,7 +1167,7 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 										}
 										if(duplicate) {
 											delete tra;
-										} else if(ignore_duplicates && budget->findDuplicateTransaction(tra)) {
+										} else if(ignore_duplicates && budget->findDuplicateTransaction(tra, new_transactions_by_key)) {
 											qi.duplicates++;
 											delete tra;
 										} else {
@@ -1214,7 +1217,7 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 											//Expense
 											Expense *exp = new Expense(budget, -current_split->value, date, (ExpensesAccount*) cat, qi.current_account, current_split->memo);
 											if(value > 0.0) exp->setQuantity(-1.0);
-											if(ignore_duplicates && budget->findDuplicateTransaction(exp)) {
+											if(ignore_duplicates && budget->findDuplicateTransaction(exp, new_transactions_by_key)) {
 												qi.duplicates++;
 												delete exp;
 											} else {
@@ -1224,7 +1227,7 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 											//Income
 											Income *inc = new Income(budget, current_split->value, date, (IncomesAccount*) cat, qi.current_account, current_split->memo);
 											if(value < 0.0) inc->setQuantity(-1.0);
-											if(ignore_duplicates && budget->findDuplicateTransaction(inc)) {
+											if(ignore_duplicates && budget->findDuplicateTransaction(inc, new_transactions_by_key)) {
 												qi.duplicates++;
 												delete inc;
 											} else {
@@ -1237,10 +1240,12 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 								split->setTimestamp(datestamps.contains(split->date()) ? datestamps[split->date()] + 1 : DATE_TO_MSECS(split->date()) / 1000);
 								datestamps[split->date()] = split->timestamp();
 								if(split->count() >= 2) {
-									budget->addSplitTransaction(split);
+									new_transactions << split;
+									for(int i = 0; i < split->count(); i++) new_transactions_by_key.insert(transaction_duplicate_key(split->at(i)), split->at(i));
 									qi.transactions++;
 								} else if(split->count() == 1) {
-									budget->addTransaction(split->at(0));
+									new_transactions << split->at(0);
+									new_transactions_by_key.insert(transaction_duplicate_key(split->at(0)), split->at(0));
 									qi.transactions++;
 									split->clear();
 									delete split;
@@ -1267,11 +1272,15 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 									budget->addAccount(acc);
 									qi.accounts++;
 								}
+								//transactions for the previous account must be added before checking for existing transactions
+								budget->addTransactions(new_transactions);
+								new_transactions.clear();
+								new_transactions_by_key.clear();
 								if(!budget->accountHasTransactions(acc) && acc->accountType() != ASSETS_TYPE_SECURITIES && acc->initialBalance() == 0.0) {
 									acc->setInitialBalance(value);
 								}
 								qi.current_account = acc;
-								previous_transfers << transfers;
+								for(QList<Transfer*>::const_iterator it = transfers.constBegin(); it != transfers.constEnd(); ++it) previous_transfers.insert(transaction_duplicate_key(*it), *it);
 								transfers.clear();
 							} else {
 								if(!acc) {
@@ -1286,8 +1295,9 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 									if(value < 0.0) tra = new Transfer(budget, -value, date, qi.current_account, acc, memo);
 									else tra = new Transfer(budget, value, date, acc, qi.current_account, memo);
 									bool duplicate = false;
-									QList<Transfer*>::iterator it_e = previous_transfers.end();
-									for(QList<Transfer*>::iterator it = previous_transfers.begin(); it != it_e; ++it) {
+									uint key = transaction_duplicate_key(tra);
+									QMultiHash<uint, Transfer*>::const_iterator it_e = previous_transfers.constEnd();
+									for(QMultiHash<uint, Transfer*>::const_iterator it = previous_transfers.constFind(key); it != it_e && it.key() == key; ++it) {
 										if(tra->equals(*it, false)) {
 											duplicate = true;
 											break;
@@ -1295,13 +1305,14 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 									}
 									if(duplicate) {
 										delete tra;
-									} else if(ignore_duplicates && budget->findDuplicateTransaction(tra)) {
+									} else if(ignore_duplicates && budget->findDuplicateTransaction(tra, new_transactions_by_key)) {
 										qi.duplicates++;
 										delete tra;
 									} else {
 										tra->setTimestamp(datestamps.contains(tra->date()) ? datestamps[tra->date()] + 1 : DATE_TO_MSECS(tra->date()) / 1000);
 										datestamps[tra->date()] = tra->timestamp();
-										budget->addTransaction(tra);
+										new_transactions << tra;
+										new_transactions_by_key.insert(transaction_duplicate_key(tra), tra);
 										transfers.append(tra);
 										qi.transactions++;
 									}
@@ -1354,13 +1365,14 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 									Expense *exp = new Expense(budget, -value, date, (ExpensesAccount*) cat, qi.current_account, memo);
 									if(value > 0.0) exp->setQuantity(-1.0);
 									exp->setPayee(payee);
-									if(ignore_duplicates && budget->findDuplicateTransaction(exp)) {
+									if(ignore_duplicates && budget->findDuplicateTransaction(exp, new_transactions_by_key)) {
 										qi.duplicates++;
 										delete exp;
 									} else {
 										exp->setTimestamp(datestamps.contains(exp->date()) ? datestamps[exp->date()] + 1 : DATE_TO_MSECS(exp->date()) / 1000);
 										datestamps[exp->date()] = exp->timestamp();
-										budget->addTransaction(exp);
+										new_transactions << exp;
+										new_transactions_by_key.insert(transaction_duplicate_key(exp), exp);
 										qInfo() << exp->description();
 										qi.transactions++;
 									}
@@ -1373,13 +1385,14 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 									Income *inc = new Income(budget, value, date, (IncomesAccount*) cat, qi.current_account, memo);
 									if(value < 0.0) inc->setQuantity(-1.0);
 									inc->setPayer(payee);
-									if(ignore_duplicates && budget->findDuplicateTransaction(inc)) {
+									if(ignore_duplicates && budget->findDuplicateTransaction(inc, new_transactions_by_key)) {
 										qi.duplicates++;
 										delete inc;
 									} else {
 										inc->setTimestamp(datestamps.contains(inc->date()) ? datestamps[inc->date()] + 1 : DATE_TO_MSECS(inc->date()) / 1000);
 										datestamps[inc->date()] = inc->timestamp();
-										budget->addTransaction(inc);
+										new_transactions << inc;
+										new_transactions_by_key.insert(transaction_duplicate_key(inc), inc);
 										qInfo() << inc->description();
 										qi.transactions++;
 									}
@@ -1422,7 +1435,7 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 								qi.accounts++;
 							}
 						}
-						previous_transfers << transfers;
+						for(QList<Transfer*>::const_iterator it = transfers.constBegin(); it != transfers.constEnd(); ++it) previous_transfers.insert(transaction_duplicate_key(*it), *it);
 						transfers.clear();
 					} else if(type == 2 && !test) {
 						//category
@@ -1512,6 +1525,7 @@ void importQIF(QTextStream &fstream, bool test, qif_info &qi, Budget *budget, bo
 		}
 		line = fstream.readLine().trimmed();
 	}
+	budget->addTransactions(new_transactions);
 	if(qi.value_format == 0) qi.value_format = 1;
 	if(qi.shares_format == 0) qi.shares_format = 1;
 	if(qi.price_format == 0) qi.price_format = 1;
@@ -1677,14 +1691,14 @@ void exportQIFOpeningBalance(QTextStream &fstream, qif_info &qi, AssetsAccount *
 		for(SecurityList<Security*>::const_iterator it = budget->securities.constBegin(); it != budget->securities.constEnd(); ++it) {
 			Security *sec = *it;
 			if(sec->account() == account && sec->initialShares() > 0.0) {
-				QMap<QDate, double>::const_iterator it = sec->quotations.begin();
-				if(it == sec->quotations.end()) fstream << "D" << writeQIFDate(date, qi.date_format) << "\n";
-				else fstream << "D" << writeQIFDate(it.key(), qi.date_format) << "\n";
+				QuotationList::const_iterator it = sec->quotations.constBegin();
+				if(it == sec->quotations.constEnd()) fstream << "D" << writeQIFDate(date, qi.date_format) << "\n";
+				else fstream << "D" << writeQIFDate(it->date(), qi.date_format) << "\n";
 				fstream << "N" << "ShrsIn" << "\n";
 				fstream << "Y" << sec->name() << "\n";
-				if(it != sec->quotations.end()) fstream << "I" << writeQIFValue(it.value(), qi.value_format, account->currency()->fractionalDigits()) << "\n";
+				if(it != sec->quotations.constEnd()) fstream << "I" << writeQIFValue(it->value, qi.value_format, account->currency()->fractionalDigits()) << "\n";
 				fstream << "Q" << writeQIFValue(sec->initialShares(), qi.value_format, sec->decimals()) << "\n";
-				if(it != sec->quotations.end()) fstream << "T" << writeQIFValue(sec->initialBalance(), qi.value_format, account->currency()->fractionalDigits()) << "\n";
+				if(it != sec->quotations.constEnd()) fstream << "T" << writeQIFValue(sec->initialBalance(), qi.value_format, account->currency()->fractionalDigits()) << "\n";
 				fstream << "C" << "X" << "\n";
 				fstream << "P" << "Opening Balance" << "\n";
 				fstream << "M" << "Opening" << "\n";
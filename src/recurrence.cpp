@@ -187,22 +187,42 @@ const QDate &Recurrence::firstOccurrence() const {
 const QDate &Recurrence::lastOccurrence() const {
 	return d_enddate;
 }
+bool Recurrence::occurrenceRange(const QDate &startdate, const QDate &enddate, QDate &first, QDate &last) const {
+	if(d_startdate.isNull() || enddate < d_startdate) return false;
+	if(!d_enddate.isNull() && startdate > d_enddate) return false;
+	first = startdate < d_startdate ? d_startdate : startdate;
+	last = (!d_enddate.isNull() && enddate > d_enddate) ? d_enddate : enddate;
+	return first <= last;
+}
 int Recurrence::countOccurrences(const QDate &startdate, const QDate &enddate) const {
-	if(enddate < d_startdate) return 0;
-	if(!d_enddate.isNull() && startdate > d_enddate) return 0;
-	if(i_count > 0 && startdate <= d_startdate && enddate <= d_enddate) return i_count;
-	QDate date1 = nextOccurrence(startdate, true);
-	if(date1.isNull() || date1 > enddate) return 0;
+	QDate first, last;
+	if(!occurrenceRange(startdate, enddate, first, last)) return 0;
+	//exceptions added after the count was set are not compensated for
+	if(i_count > 0 && exceptions.isEmpty() && startdate <= d_startdate && enddate >= d_enddate) return i_count;
+	return countOccurrencesInRange(first, last);
+}
+int Recurrence::countOccurrencesInRange(const QDate &first, const QDate &last) const {
+	QDate date1 = nextOccurrence(first, true);
+	if(date1.isNull() || date1 > last) return 0;
 	int n = 0;
 	do {
 		n++;
 		date1 = nextOccurrence(date1);
-	} while(!date1.isNull() && date1 <= enddate);
+	} while(!date1.isNull() && date1 <= last);
 	return n;
 }
 int Recurrence::countOccurrences(const QDate &enddate) const {
 	return countOccurrences(d_startdate, enddate);
 }
+void Recurrence::expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const {
+	QDate first, last;
+	if(!occurrenceRange(startdate, enddate, first, last)) return;
+	QDate date1 = nextOccurrence(first, true);
+	while(!date1.isNull() && date1 <= last) {
+		dates.append(date1);
+		date1 = nextOccurrence(date1);
+	}
+}
 bool Recurrence::removeOccurrence(const QDate &date) {
 	addException(date);
 	return true;
@@ -292,30 +312,21 @@ void Recurrence::addException(const QDate &date) {
 		if(d_enddate.isNull()) d_startdate = QDate();
 		return;
 	}
-	exceptions.append(date);
-	std::sort(exceptions.begin(), exceptions.end());
+	exceptions.insert(std::upper_bound(exceptions.begin(), exceptions.end(), date), date);
 }
 int Recurrence::findException(const QDate &date) const {
-	for(QVector<QDate>::size_type i = 0; i < exceptions.count(); i++) {
-		if(exceptions[i] == date) {
-			return (int) i;
-		}
-		if(exceptions[i] > date) break;
-	}
-	return -1;
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), date);
+	if(it == exceptions.constEnd() || *it != date) return -1;
+	return (int) (it - exceptions.constBegin());
 }
 bool Recurrence::hasException(const QDate &date) const {
 	return findException(date) >= 0;
 }
 bool Recurrence::removeException(const QDate &date) {
-	for(QVector<QDate>::iterator it = exceptions.begin(); it != exceptions.end(); ++it) {
-		if(*it == date) {
-			exceptions.erase(it);
-			return true;
-		}
-		if(*it > date) break;
-	}
-	return false;
+	int i = findException(date);
+	if(i < 0) return false;
+	exceptions.remove(i);
+	return true;
 }
 void Recurrence::clearExceptions() {
 	exceptions.clear();
@@ -385,6 +396,29 @@ QDate DailyRecurrence::prevOccurrence(const QDate &date, bool include_equals) co
 	if(hasException(prevdate)) return prevOccurrence(prevdate);
 	return prevdate;
 }
+int DailyRecurrence::countOccurrencesInRange(const QDate &first, const QDate &last) const {
+	qint64 k_first = (startDate().daysTo(first) + i_frequency - 1) / i_frequency;
+	qint64 k_last = startDate().daysTo(last) / i_frequency;
+	if(k_last < k_first) return 0;
+	int n = (int) (k_last - k_first + 1);
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), first);
+	for(; it != exceptions.constEnd() && *it <= last; ++it) {
+		if(startDate().daysTo(*it) % i_frequency == 0) n--;
+	}
+	return n;
+}
+void DailyRecurrence::expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const {
+	QDate first, last;
+	if(!occurrenceRange(startdate, enddate, first, last)) return;
+	qint64 k_first = (startDate().daysTo(first) + i_frequency - 1) / i_frequency;
+	QDate date = startDate().addDays(k_first * i_frequency);
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), date);
+	while(date <= last) {
+		while(it != exceptions.constEnd() && *it < date) ++it;
+		if(it == exceptions.constEnd() || *it != date) dates.append(date);
+		date = date.addDays(i_frequency);
+	}
+}
 RecurrenceType DailyRecurrence::type() const {
 	return RECURRENCE_TYPE_DAILY;
 }
@@ -479,7 +513,7 @@ QDate WeeklyRecurrence::nextOccurrence(const QDate &date, bool include_equals) c
 	QDate nextdate = date;
 	if(!include_equals) nextdate = nextdate.addDays(1);
 	if(!endDate().isNull() && nextdate > endDate()) return QDate();
-	if(i_frequency != 1 && (nextdate.year() != startDate().year() || nextdate.weekNumber() != startDate().weekNumber())) {
+	if(i_frequency != 1) {
 		int i = weeks_between_dates(startDate(), nextdate) % i_frequency;
 		if(i != 0) {
 			nextdate = nextdate.addDays((i_frequency - i) * 7 - (nextdate.dayOfWeek() - 1));
@@ -518,14 +552,14 @@ QDate WeeklyRecurrence::prevOccurrence(const QDate &date, bool include_equals) c
 	if(!include_equals) prevdate = prevdate.addDays(-1);
 	if(prevdate < startDate()) return QDate();
 	if(prevdate == startDate()) return startDate();
-	if(i_frequency != 1 && (prevdate.year() != startDate().year() || prevdate.weekNumber() != startDate().weekNumber())) {
+	if(i_frequency != 1) {
 		int i = weeks_between_dates(startDate(), prevdate) % i_frequency;
 		if(i != 0) {
 			prevdate = prevdate.addDays(-(i * 7) + 7 - prevdate.dayOfWeek());
 		}
 	}
 	int dow_s = startDate().dayOfWeek();
-	bool s_week = prevdate.year() == startDate().year() && prevdate.weekNumber() == startDate().weekNumber();
+	bool s_week = weeks_between_dates(startDate(), prevdate) == 0;
 	int dow = prevdate.dayOfWeek();
 	int i = dow;
 	for(; i <= 7; i++) {
@@ -550,6 +584,66 @@ QDate WeeklyRecurrence::prevOccurrence(const QDate &date, bool include_equals) c
 	if(hasException(prevdate)) return prevOccurrence(prevdate);
 	return prevdate;
 }
+int WeeklyRecurrence::countWeekdayOccurrences(const QDate &date) const {
+	QDate first_monday = startDate().addDays(1 - startDate().dayOfWeek());
+	qint64 days = first_monday.daysTo(date);
+	if(days < 0) return 0;
+	qint64 weeks = days / 7;
+	int days_per_week = 0;
+	for(int i = 0; i < 7; i++) {
+		if(b_daysofweek[i]) days_per_week++;
+	}
+	int n = (int) ((weeks + i_frequency - 1) / i_frequency) * days_per_week;
+	if(weeks % i_frequency == 0) {
+		for(int i = 0; i <= days % 7; i++) {
+			if(b_daysofweek[i]) n++;
+		}
+	}
+	return n;
+}
+bool WeeklyRecurrence::isWeekdayOccurrence(const QDate &date) const {
+	if(date <= startDate() || !b_daysofweek[date.dayOfWeek() - 1]) return false;
+	return weeks_between_dates(startDate(), date) % i_frequency == 0;
+}
+int WeeklyRecurrence::countOccurrencesInRange(const QDate &first, const QDate &last) const {
+	int n = 0;
+	QDate date = first;
+	if(date == startDate()) {
+		n++;
+		date = date.addDays(1);
+	}
+	if(date <= last) n += countWeekdayOccurrences(last) - countWeekdayOccurrences(date.addDays(-1));
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), date);
+	for(; it != exceptions.constEnd() && *it <= last; ++it) {
+		if(isWeekdayOccurrence(*it)) n--;
+	}
+	return n;
+}
+void WeeklyRecurrence::expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const {
+	QDate first, last;
+	if(!occurrenceRange(startdate, enddate, first, last)) return;
+	QDate date = first;
+	if(date == startDate()) {
+		dates.append(date);
+		date = date.addDays(1);
+	}
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), date);
+	while(date <= last) {
+		int dow = date.dayOfWeek();
+		if(i_frequency != 1) {
+			int i = weeks_between_dates(startDate(), date) % i_frequency;
+			if(i != 0) {
+				date = date.addDays((i_frequency - i) * 7 - (dow - 1));
+				continue;
+			}
+		}
+		if(b_daysofweek[dow - 1]) {
+			while(it != exceptions.constEnd() && *it < date) ++it;
+			if(it == exceptions.constEnd() || *it != date) dates.append(date);
+		}
+		date = date.addDays(1);
+	}
+}
 RecurrenceType WeeklyRecurrence::type() const {
 	return RECURRENCE_TYPE_WEEKLY;
 }
@@ -694,7 +788,8 @@ QDate MonthlyRecurrence::nextOccurrence(const QDate &date, bool include_equals)
 			if(i_frequency > 1) prevday = 1;
 			else prevday = nextdate.day();
 			nextdate = nextdate.addMonths(i_frequency);
-			if(!endDate().isNull() && (nextdate.year() > endDate().year() || (nextdate.year() == endDate().year() && nextdate.month() > endDate().month()))) return QDate();
+			//weekend handling can move the occurrence into the previous month
+			if(!endDate().isNull() && months_between_dates(endDate(), nextdate) > 1) return QDate();
 			day = i_day;
 			if(i_dayofweek > 0) day = get_day_in_month(nextdate, i_week, i_dayofweek);
 			else if(i_day < 1) day = nextdate.daysInMonth() + i_day;
@@ -876,6 +971,69 @@ QDate MonthlyRecurrence::prevOccurrence(const QDate &date, bool include_equals)
 	if(hasException(prevdate)) return prevOccurrence(prevdate);
 	return prevdate;
 }
+QDate MonthlyRecurrence::occurrenceInMonth(int year, int month) const {
+	QDate date(year, month, 1);
+	int days = date.daysInMonth();
+	int day = i_day;
+	if(i_dayofweek > 0) day = get_day_in_month(date, i_week, i_dayofweek);
+	else if(i_day < 1) day = days + i_day;
+	if(day <= 0) return QDate();
+	int wday = 0;
+	if(day <= days) wday = date.addDays(day - 1).dayOfWeek();
+	if(wh_weekendhandling == WEEKEND_HANDLING_BEFORE) {
+		if(wday == 6) day -= 1;
+		else if(wday == 7) day -= 2;
+	} else if(wh_weekendhandling == WEEKEND_HANDLING_AFTER) {
+		if(wday == 6) day += 2;
+		else if(wday == 7) day += 1;
+		//also a day which does not exist in the month
+		if(day > days) return date.addDays(day - 1);
+	} else if(wh_weekendhandling == WEEKEND_HANDLING_NEAREST) {
+		if(wday == 6) day -= 1;
+		else if(wday == 7) day += 1;
+		if(wday == 7 && day > days) return date.addDays(day - 1);
+	}
+	if(day > days) return QDate();
+	return date.addDays(day - 1);
+}
+int MonthlyRecurrence::stepOccurrences(const QDate &first, const QDate &last, QVector<QDate> *dates) const {
+	int n = 0;
+	if(first == startDate()) {
+		n++;
+		if(dates) dates->append(first);
+	}
+	//start with the month before first, since weekend handling can move an occurrence into the next month
+	int k = (months_between_dates(startDate(), first) + i_frequency - 2) / i_frequency;
+	if(k < 1) k = 1;
+	QDate month_start(startDate().year(), startDate().month(), 1);
+	QDate month = month_start.addMonths(k * i_frequency);
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), first);
+	//an occurrence is at most two days before the start of its month
+	while(month <= last.addDays(2)) {
+		QDate date = occurrenceInMonth(month.year(), month.month());
+		if(!date.isNull()) {
+			if(date > last) break;
+			if(date >= first && date > startDate()) {
+				while(it != exceptions.constEnd() && *it < date) ++it;
+				if(it == exceptions.constEnd() || *it != date) {
+					n++;
+					if(dates) dates->append(date);
+				}
+			}
+		}
+		k++;
+		month = month_start.addMonths(k * i_frequency);
+	}
+	return n;
+}
+int MonthlyRecurrence::countOccurrencesInRange(const QDate &first, const QDate &last) const {
+	return stepOccurrences(first, last, NULL);
+}
+void MonthlyRecurrence::expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const {
+	QDate first, last;
+	if(!occurrenceRange(startdate, enddate, first, last)) return;
+	stepOccurrences(first, last, &dates);
+}
 RecurrenceType MonthlyRecurrence::type() const {
 	return RECURRENCE_TYPE_MONTHLY;
 }
@@ -1082,6 +1240,47 @@ QDate YearlyRecurrence::prevOccurrence(const QDate &date, bool include_equals) c
 	if(hasException(prevdate)) return prevOccurrence(prevdate);
 	return prevdate;
 }
+QDate YearlyRecurrence::occurrenceInYear(int year) const {
+	if(i_dayofyear > 0) {
+		QDate date(year, 1, 1);
+		if(i_dayofyear > date.daysInYear()) return QDate();
+		return date.addDays(i_dayofyear - 1);
+	}
+	QDate date(year, i_month, 1);
+	int day = i_dayofmonth;
+	if(i_dayofweek > 0) day = get_day_in_month(date, i_week, i_dayofweek);
+	if(day <= 0 || day > date.daysInMonth()) return QDate();
+	return date.addDays(day - 1);
+}
+int YearlyRecurrence::stepOccurrences(const QDate &first, const QDate &last, QVector<QDate> *dates) const {
+	int n = 0;
+	if(first == startDate()) {
+		n++;
+		if(dates) dates->append(first);
+	}
+	int k = (first.year() - startDate().year() + i_frequency - 1) / i_frequency;
+	if(k < 1) k = 1;
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), first);
+	for(int year = startDate().year() + k * i_frequency; year <= last.year(); year += i_frequency) {
+		QDate date = occurrenceInYear(year);
+		if(date.isNull() || date < first) continue;
+		if(date > last) break;
+		while(it != exceptions.constEnd() && *it < date) ++it;
+		if(it == exceptions.constEnd() || *it != date) {
+			n++;
+			if(dates) dates->append(date);
+		}
+	}
+	return n;
+}
+int YearlyRecurrence::countOccurrencesInRange(const QDate &first, const QDate &last) const {
+	return stepOccurrences(first, last, NULL);
+}
+void YearlyRecurrence::expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const {
+	QDate first, last;
+	if(!occurrenceRange(startdate, enddate, first, last)) return;
+	stepOccurrences(first, last, &dates);
+}
 RecurrenceType YearlyRecurrence::type() const {
 	return RECURRENCE_TYPE_YEARLY;
 }
@@ -46,6 +46,9 @@ class Recurrence {
 		QDate d_startdate, d_enddate;
 		int i_count;
 
+		bool occurrenceRange(const QDate &startdate, const QDate &enddate, QDate &first, QDate &last) const;
+		virtual int countOccurrencesInRange(const QDate &first, const QDate &last) const;
+
 	public:
 
 		Recurrence(Budget *parent_budget);
@@ -69,6 +72,7 @@ class Recurrence {
 		const QDate &lastOccurrence() const;
 		int countOccurrences(const QDate &startdate, const QDate &enddate) const;
 		int countOccurrences(const QDate &enddate) const;
+		virtual void expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const;
 		bool removeOccurrence(const QDate &date);
 		const QDate &endDate() const;
 		const QDate &startDate() const;
@@ -94,6 +98,8 @@ class DailyRecurrence : public Recurrence {
 
 		int i_frequency;
 
+		int countOccurrencesInRange(const QDate &first, const QDate &last) const;
+
 	public:
 
 		DailyRecurrence(Budget *parent_budget);
@@ -107,6 +113,7 @@ class DailyRecurrence : public Recurrence {
 
 		QDate nextOccurrence(const QDate &date, bool include_equals = false) const;
 		QDate prevOccurrence(const QDate &date, bool include_equals = false) const;
+		void expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const;
 		RecurrenceType type() const;
 		int frequency() const;
 		void set(const QDate &new_start_date, const QDate &new_end_date, int new_frequency, int occurrences = -1);
@@ -120,6 +127,10 @@ class WeeklyRecurrence : public Recurrence {
 		int i_frequency;
 		bool b_daysofweek[7];
 
+		int countOccurrencesInRange(const QDate &first, const QDate &last) const;
+		int countWeekdayOccurrences(const QDate &date) const;
+		bool isWeekdayOccurrence(const QDate &date) const;
+
 	public:
 
 		WeeklyRecurrence(Budget *parent_budget);
@@ -133,6 +144,7 @@ class WeeklyRecurrence : public Recurrence {
 
 		QDate nextOccurrence(const QDate &date, bool include_equals = false) const;
 		QDate prevOccurrence(const QDate &date, bool include_equals = false) const;
+		void expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const;
 		RecurrenceType type() const;
 		int frequency() const;
 		bool dayOfWeek(int i) const;
@@ -157,6 +169,10 @@ class MonthlyRecurrence : public Recurrence {
 		int i_dayofweek;
 		WeekendHandling wh_weekendhandling;
 
+		int countOccurrencesInRange(const QDate &first, const QDate &last) const;
+		int stepOccurrences(const QDate &first, const QDate &last, QVector<QDate> *dates) const;
+		QDate occurrenceInMonth(int year, int month) const;
+
 	public:
 
 		MonthlyRecurrence(Budget *parent_budget);
@@ -170,6 +186,7 @@ class MonthlyRecurrence : public Recurrence {
 
 		QDate nextOccurrence(const QDate &date, bool include_equals = false) const;
 		QDate prevOccurrence(const QDate &date, bool include_equals = false) const;
+		void expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const;
 		RecurrenceType type() const;
 		int frequency() const;
 		int day() const;
@@ -193,6 +210,10 @@ class YearlyRecurrence : public Recurrence {
 		int i_dayofyear;
 		WeekendHandling wh_weekendhandling;
 
+		int countOccurrencesInRange(const QDate &first, const QDate &last) const;
+		int stepOccurrences(const QDate &first, const QDate &last, QVector<QDate> *dates) const;
+		QDate occurrenceInYear(int year) const;
+
 	public:
 
 		YearlyRecurrence(Budget *parent_budget);
@@ -206,6 +227,7 @@ class YearlyRecurrence : public Recurrence {
 
 		QDate nextOccurrence(const QDate &date, bool include_equals = false) const;
 		QDate prevOccurrence(const QDate &date, bool include_equals = false) const;
+		void expandOccurrences(const QDate &startdate, const QDate &enddate, QVector<QDate> &dates) const;
 		RecurrenceType type() const;
 		int frequency() const;
 		int month() const;
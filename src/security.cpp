@@ -31,8 +31,88 @@
 #include "recurrence.h"
 #include "security.h"
 
+#include <algorithm>
 #include <cmath>
 
+bool quotation_less_than(const Quotation &q1, const Quotation &q2) {
+	return q1.day < q2.day;
+}
+bool quotation_day_less_than(const Quotation &q, qint64 day) {
+	return q.day < day;
+}
+bool day_quotation_less_than(qint64 day, const Quotation &q) {
+	return day < q.day;
+}
+
+QuotationList::const_iterator QuotationList::find(const QDate &date) const {
+	qint64 day = date.toJulianDay();
+	const_iterator it = std::lower_bound(v_quotations.constBegin(), v_quotations.constEnd(), day, quotation_day_less_than);
+	if(it != v_quotations.constEnd() && it->day == day) return it;
+	return v_quotations.constEnd();
+}
+QuotationList::const_iterator QuotationList::upperBound(const QDate &date) const {
+	return std::upper_bound(v_quotations.constBegin(), v_quotations.constEnd(), date.toJulianDay(), day_quotation_less_than);
+}
+bool QuotationList::contains(const QDate &date) const {
+	return find(date) != v_quotations.constEnd();
+}
+void QuotationList::insert(const QDate &date, double value, bool auto_added) {
+	Quotation q;
+	q.day = date.toJulianDay();
+	q.value = value;
+	q.b_auto = auto_added;
+	if(v_quotations.isEmpty() || v_quotations.last().day < q.day) {
+		v_quotations.append(q);
+		return;
+	}
+	QVector<Quotation>::iterator it = std::lower_bound(v_quotations.begin(), v_quotations.end(), q.day, quotation_day_less_than);
+	if(it != v_quotations.end() && it->day == q.day) *it = q;
+	else v_quotations.insert(it, q);
+}
+bool QuotationList::remove(const QDate &date) {
+	qint64 day = date.toJulianDay();
+	QVector<Quotation>::iterator it = std::lower_bound(v_quotations.begin(), v_quotations.end(), day, quotation_day_less_than);
+	if(it == v_quotations.end() || it->day != day) return false;
+	v_quotations.erase(it);
+	return true;
+}
+void QuotationList::merge(const QuotationList &quotations, bool keep) {
+	QVector<Quotation> merged;
+	merged.reserve(v_quotations.count() + quotations.count());
+	const_iterator it1 = v_quotations.constBegin(), it2 = quotations.constBegin();
+	while(it1 != v_quotations.constEnd() || it2 != quotations.constEnd()) {
+		if(it2 == quotations.constEnd() || (it1 != v_quotations.constEnd() && it1->day < it2->day)) {
+			merged << *it1;
+			++it1;
+		} else if(it1 == v_quotations.constEnd() || it2->day < it1->day) {
+			merged << *it2;
+			++it2;
+		} else {
+			merged << (keep ? *it1 : *it2);
+			++it1;
+			++it2;
+		}
+	}
+	v_quotations = merged;
+}
+void QuotationList::append(const QDate &date, double value, bool auto_added) {
+	Quotation q;
+	q.day = date.toJulianDay();
+	q.value = value;
+	q.b_auto = auto_added;
+	v_quotations.append(q);
+}
+void QuotationList::sort() {
+	std::stable_sort(v_quotations.begin(), v_quotations.end(), quotation_less_than);
+	//the last added quotation for a date is kept
+	int n = 0;
+	for(int i = 0; i < v_quotations.count(); i++) {
+		if(n > 0 && v_quotations[n - 1].day == v_quotations[i].day) v_quotations[n - 1] = v_quotations[i];
+		else v_quotations[n++] = v_quotations[i];
+	}
+	v_quotations.resize(n);
+}
+
 void Security::init() {
 	transactions.setAutoDelete(false);
 	dividends.setAutoDelete(false);
@@ -41,6 +121,7 @@ void Security::init() {
 	tradedShares.setAutoDelete(false);
 	reinvestedDividends.setAutoDelete(false);
 	scheduledReinvestedDividends.setAutoDelete(false);
+	b_shares_timeline_valid = false;
 }
 Security::Security(Budget *parent_budget, AssetsAccount *parent_account, SecurityType initial_type, double initial_shares, int initial_decimals, int initial_quotation_decimals, QString initial_name, QString initial_description) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()), o_account(parent_account), st_type(initial_type), d_initial_shares(initial_shares), i_decimals(initial_decimals), i_quotation_decimals(initial_quotation_decimals), s_name(initial_name.trimmed()), s_description(initial_description), b_closed(false) {
 	init();
@@ -51,7 +132,7 @@ Security::Security(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) :
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-Security::Security(Budget *parent_budget) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()) {}
+Security::Security(Budget *parent_budget) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()), b_shares_timeline_valid(false) {}
 Security::Security() : o_budget(NULL), i_id(0), i_first_revision(1), i_last_revision(1), o_account(NULL), st_type(SECURITY_TYPE_STOCK), d_initial_shares(0.0), i_decimals(-1), i_quotation_decimals(-1), b_closed(false) {init();}
 Security::Security(const Security *security) : o_budget(security->budget()), i_id(security->id()), i_first_revision(security->firstRevision()), i_last_revision(security->lastRevision()), o_account(security->account()), st_type(security->type()), d_initial_shares(security->initialShares()), i_decimals(security->decimals()), i_quotation_decimals(security->quotationDecimals()), s_name(security->name()), s_description(security->description()), b_closed(security->isClosed()) {init();}
 Security::~Security() {}
@@ -66,7 +147,6 @@ void Security::set(const Security *security) {
 	d_initial_shares = security->initialShares();
 	i_decimals = security->decimals();
 	quotations = security->quotations;
-	quotations_auto = security->quotations_auto;
 	b_closed = security->isClosed();
 }
 void Security::setMergeQuotes(const Security *security) {
@@ -82,12 +162,7 @@ void Security::setMergeQuotes(const Security *security) {
 	mergeQuotes(security, false);
 }
 void Security::mergeQuotes(const Security *security, bool keep) {
-	for(QMap<QDate, double>::const_iterator it = security->quotations.begin(); it != security->quotations.end(); ++it) {
-		if(!keep || !quotations.contains(it.key())) quotations[it.key()] = it.value();
-	}
-	for(QMap<QDate, bool>::const_iterator it = security->quotations_auto.begin(); it != security->quotations_auto.end(); ++it) {
-		if(!keep || !quotations_auto.contains(it.key())) quotations_auto[it.key()] = it.value();
-	}
+	quotations.merge(security->quotations, keep);
 }
 
 void Security::readAttributes(QXmlStreamAttributes *attr, bool *valid) {
@@ -128,10 +203,7 @@ bool Security::readElement(QXmlStreamReader *xml, bool*) {
 	if(xml->name() == XML_COMPARE_CONST_CHAR("quotation")) {
 		QXmlStreamAttributes attr = xml->attributes();
 		QDate date = QDate::fromString(attr.value("date").toString(), Qt::ISODate);
-		if(date.isValid()) {
-			quotations[date] = attr.value("value").toDouble();
-			quotations_auto[date] = attr.value("auto").toInt();
-		}
+		if(date.isValid()) quotations.insert(date, attr.value("value").toDouble(), attr.value("auto").toInt());
 	}
 	return false;
 }
@@ -164,14 +236,11 @@ void Security::writeAttributes(QXmlStreamAttributes *attr) {
 	attr->append("account", QString::number(o_account->id()));
 }
 void Security::writeElements(QXmlStreamWriter *xml) {
-	QMap<QDate, double>::const_iterator it_end = quotations.end();
-	QMap<QDate, double>::const_iterator it = quotations.begin();
-	QMap<QDate, bool>::const_iterator it_auto = quotations_auto.begin();
-	for(; it != it_end; ++it, ++it_auto) {
+	for(QuotationList::const_iterator it = quotations.constBegin(); it != quotations.constEnd(); ++it) {
 		xml->writeStartElement("quotation");
-		xml->writeAttribute("value", QString::number(it.value(), 'g', SAVE_MONETARY_PRECISION));
-		xml->writeAttribute("date", it.key().toString(Qt::ISODate));
-		if(it_auto.value()) xml->writeAttribute("auto", QString::number(it_auto.value()));
+		xml->writeAttribute("value", QString::number(it->value, 'g', SAVE_MONETARY_PRECISION));
+		xml->writeAttribute("date", it->date().toString(Qt::ISODate));
+		if(it->b_auto) xml->writeAttribute("auto", QString::number(it->b_auto));
 		xml->writeEndElement();
 	}
 }
@@ -181,9 +250,8 @@ const QString &Security::description() const {return s_description;}
 void Security::setDescription(QString new_description) {s_description = new_description;}
 Budget *Security::budget() const {return o_budget;}
 double Security::initialBalance() const {
-	QMap<QDate, double>::const_iterator it = quotations.begin();
-	if(it == quotations.end()) return 0.0;
-	return it.value() * d_initial_shares;
+	if(quotations.isEmpty()) return 0.0;
+	return quotations.first().value * d_initial_shares;
 }
 double Security::initialShares() const {return d_initial_shares;}
 void Security::setInitialShares(double initial_shares) {d_initial_shares = initial_shares;}
@@ -194,7 +262,11 @@ Currency *Security::currency() const {
 	if(o_account) return o_account->currency();
 	return budget()->defaultCurrency();
 }
-void Security::setAccount(AssetsAccount *new_account) {o_account = new_account;}
+void Security::setAccount(AssetsAccount *new_account) {
+	if(new_account == o_account) return;
+	o_account = new_account;
+	if(o_budget) o_budget->securityAccountModified(this);
+}
 bool Security::isClosed() const {return b_closed;}
 void Security::setClosed(bool close_account) {b_closed = close_account;}
 qlonglong Security::id() const {return i_id;}
@@ -206,42 +278,59 @@ void Security::setLastRevision(int new_rev) {i_last_revision = new_rev;}
 void Security::setQuotation(const QDate &date, double value, bool auto_added) {
 	if(!date.isValid()) return;
 	if(!auto_added) {
-		quotations[date] = value;
-		quotations_auto[date] = false;
-	} else if(!quotations.count(date) || quotations_auto[date]) {
-		quotations[date] = value;
-		quotations_auto[date] = true;
+		quotations.insert(date, value, false);
+	} else {
+		QuotationList::const_iterator it = quotations.find(date);
+		if(it == quotations.constEnd() || it->b_auto) quotations.insert(date, value, true);
 	}
 }
 void Security::removeQuotation(const QDate &date, bool auto_added) {
-	if(quotations.count(date) && (!auto_added || quotations_auto[date])) {
+	QuotationList::const_iterator it = quotations.find(date);
+	if(it != quotations.constEnd() && (!auto_added || it->b_auto)) {
 		quotations.remove(date);
-		quotations_auto.remove(date);
 	}
 }
 void Security::clearQuotations() {
 	quotations.clear();
-	quotations_auto.clear();
 }
 double Security::getQuotation(const QDate &date, QDate *actual_date) const {
-	if(quotations.contains(date)) {
-		if(actual_date) *actual_date = date;
-		return quotations[date];
-	}
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	QMap<QDate, double>::const_iterator it = quotations.end();
-	if(it != it_begin) {
-		--it;
-		while(true) {
-			if(it.key() <= date || it == it_begin) {
-				if(actual_date) *actual_date = it.key();
-				return it.value();
-			}
-			--it;
+	if(quotations.isEmpty()) {
+		if(actual_date) *actual_date = QDate();
+		return 0.0;
+	}
+	//last quotation on or before date, or the first quotation
+	QuotationList::const_iterator it = quotations.upperBound(date);
+	if(it != quotations.constBegin()) --it;
+	if(actual_date) *actual_date = it->date();
+	return it->value;
+}
+void Security::getQuotations(const QVector<QDate> &dates, QVector<double> &values, bool interpolate) const {
+	values.resize(dates.count());
+	if(quotations.isEmpty()) {
+		values.fill(0.0);
+		return;
+	}
+	QuotationList::const_iterator it_begin = quotations.constBegin(), it_end = quotations.constEnd();
+	//first quotation after the current date
+	QuotationList::const_iterator it = it_begin;
+	qint64 prev_day = 0;
+	for(int i = 0; i < dates.count(); i++) {
+		qint64 day = dates.at(i).toJulianDay();
+		if(i == 0 || day < prev_day) it = quotations.upperBound(dates.at(i));
+		else while(it != it_end && it->day <= day) ++it;
+		prev_day = day;
+		if(it == it_begin) {
+			values[i] = it_begin->value;
+			continue;
+		}
+		QuotationList::const_iterator it_prev = it - 1;
+		if(!interpolate || it == it_end || it_prev->day == day || it->value == it_prev->value) {
+			values[i] = it_prev->value;
+		} else {
+			double rate = it->value / it_prev->value;
+			values[i] = it_prev->value * pow(rate, (double) (day - it_prev->day) / (it->day - it_prev->day));
 		}
 	}
-	if(actual_date) *actual_date = QDate();
-	return 0.0;
 }
 bool Security::hasQuotation(const QDate &date) const {
 	return quotations.contains(date);
@@ -257,38 +346,50 @@ int Security::quotationDecimals() const {
 void Security::setDecimals(int new_decimals) {i_decimals = new_decimals;}
 void Security::setQuotationDecimals(int new_decimals) {i_quotation_decimals = new_decimals;}
 
-double Security::shares() {
-	double n = d_initial_shares;
+void Security::sharesModified() {
+	b_shares_timeline_valid = false;
+	shares_timeline_days.clear();
+	shares_timeline.clear();
+}
+void Security::rebuildSharesTimeline() {
+	//cumulative change in shares (excluding initial shares) from transactions, trades and reinvested dividends, per day
+	QMap<qint64, double> changes;
 	for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
 		SecurityTransaction *trans = *it;
-		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY) n += trans->shares();
-		else n -= trans->shares();
+		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY) changes[trans->date().toJulianDay()] += trans->shares();
+		else changes[trans->date().toJulianDay()] -= trans->shares();
 	}
 	for(TradedSharesList<SecurityTrade*>::const_iterator it = tradedShares.constBegin(); it != tradedShares.constEnd(); ++it) {
 		SecurityTrade *ts = *it;
-		if(ts->from_security == this) n -= ts->from_shares;
-		else n += ts->to_shares;
+		if(ts->from_security == this) changes[ts->date.toJulianDay()] -= ts->from_shares;
+		else changes[ts->date.toJulianDay()] += ts->to_shares;
 	}
 	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = reinvestedDividends.constBegin(); it != reinvestedDividends.constEnd(); ++it) {
 		ReinvestedDividend *rediv = *it;
-		n += rediv->shares();
+		changes[rediv->date().toJulianDay()] += rediv->shares();
 	}
-	return n;
+	shares_timeline_days.clear();
+	shares_timeline.clear();
+	shares_timeline_days.reserve(changes.count());
+	shares_timeline.reserve(changes.count());
+	double n = 0.0;
+	for(QMap<qint64, double>::const_iterator it = changes.constBegin(); it != changes.constEnd(); ++it) {
+		n += it.value();
+		shares_timeline_days << it.key();
+		shares_timeline << n;
+	}
+	b_shares_timeline_valid = true;
+}
+double Security::shares() {
+	if(!b_shares_timeline_valid) rebuildSharesTimeline();
+	if(shares_timeline.isEmpty()) return d_initial_shares;
+	return d_initial_shares + shares_timeline.last();
 }
 double Security::shares(const QDate &date, bool estimate, bool no_scheduled_shares) {
 	double n = d_initial_shares;
-	for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
-		SecurityTransaction *trans = *it;
-		if(trans->date() > date) break;
-		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY) n += trans->shares();
-		else n -= trans->shares();
-	}
-	for(TradedSharesList<SecurityTrade*>::const_iterator it = tradedShares.constBegin(); it != tradedShares.constEnd(); ++it) {
-		SecurityTrade *ts = *it;
-		if(ts->date > date) break;
-		if(ts->from_security == this) n -= ts->from_shares;
-		else n += ts->to_shares;
-	}
+	if(!b_shares_timeline_valid) rebuildSharesTimeline();
+	QVector<qint64>::const_iterator it_day = std::upper_bound(shares_timeline_days.constBegin(), shares_timeline_days.constEnd(), date.toJulianDay());
+	if(it_day != shares_timeline_days.constBegin()) n += shares_timeline.at(it_day - shares_timeline_days.constBegin() - 1);
 	if(!no_scheduled_shares) {
 		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
 			ScheduledTransaction *strans = *it;
@@ -300,11 +401,6 @@ double Security::shares(const QDate &date, bool estimate, bool no_scheduled_shar
 			}
 		}
 	}
-	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = reinvestedDividends.constBegin(); it != reinvestedDividends.constEnd(); ++it) {
-		ReinvestedDividend *rediv = *it;
-		if(rediv->date() > date) break;
-		n += rediv->shares();
-	}
 	bool b;
 	if(!no_scheduled_shares) {
 		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = scheduledReinvestedDividends.constBegin(); it != scheduledReinvestedDividends.constEnd(); ++it) {
@@ -321,7 +417,7 @@ double Security::shares(const QDate &date, bool estimate, bool no_scheduled_shar
 		QDate date1 = QDate::currentDate();
 		int days = date1.daysTo(date);
 		int days2 = 0;
-		if(quotations.begin() != quotations.end()) days2 = quotations.begin().key().daysTo(date1);
+		if(!quotations.isEmpty()) days2 = quotations.first().date().daysTo(date1);
 		if(days2 > days) {
 			days2 = days;
 		}
@@ -346,20 +442,27 @@ double Security::value() {
 }
 double Security::value(const QDate &date, int estimate, bool no_scheduled_shares) {
 	if(estimate > 0 && date > QDate::currentDate()) return shares(date, true, no_scheduled_shares) * expectedQuotation(date);
-	else if(estimate < 0 && quotations.count() >= 2 && quotations.firstKey() < date && quotations.lastKey() > date) return shares(date, false, no_scheduled_shares) * expectedQuotation(date);
+	else if(estimate < 0 && quotations.count() >= 2 && quotations.first().date() < date && quotations.last().date() > date) return shares(date, false, no_scheduled_shares) * expectedQuotation(date);
 	return shares(date, false, no_scheduled_shares) * getQuotation(date);
 }
+void Security::values(const QVector<QDate> &dates, QVector<double> &values, int estimate, bool no_scheduled_shares) {
+	getQuotations(dates, values, estimate < 0);
+	QDate curdate = QDate::currentDate();
+	for(int i = 0; i < dates.count(); i++) {
+		if(estimate > 0 && dates.at(i) > curdate) values[i] = shares(dates.at(i), true, no_scheduled_shares) * expectedQuotation(dates.at(i));
+		else values[i] *= shares(dates.at(i), false, no_scheduled_shares);
+	}
+}
 double Security::cost(const QDate &date, bool no_scheduled_shares, Currency *cur) {
 	if(!cur) cur = currency();
 	double c = d_initial_shares;
-	QMap<QDate, double>::const_iterator it_q = quotations.begin();
-	if(it_q == quotations.end()) {
+	if(quotations.isEmpty()) {
 		c = 0.0;
 	} else {
-		c *= it_q.value();
+		c *= quotations.first().value;
 		if(cur != currency()) {
 			if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) {
-				c = currency()->convertTo(c, cur, it_q.key());
+				c = currency()->convertTo(c, cur, quotations.first().date());
 			} else {
 				c = currency()->convertTo(c, cur, date);
 			}
@@ -413,14 +516,13 @@ double Security::cost(const QDate &date, bool no_scheduled_shares, Currency *cur
 double Security::cost(Currency *cur) {
 	if(!cur) cur = currency();
 	double c = d_initial_shares;
-	QMap<QDate, double>::const_iterator it_q = quotations.begin();
-	if(it_q == quotations.end()) {
+	if(quotations.isEmpty()) {
 		c = 0.0;
 	} else {
-		c *= it_q.value();
+		c *= quotations.first().value;
 		if(cur != currency()) {
 			if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) {
-				c = currency()->convertTo(c, cur, it_q.key());
+				c = currency()->convertTo(c, cur, quotations.first().date());
 			} else {
 				c = currency()->convertTo(c, cur);
 			}
@@ -499,7 +601,7 @@ double Security::profit(const QDate &date, bool estimate, bool no_scheduled_shar
 		QDate date1 = QDate::currentDate();
 		int days = date1.daysTo(date);
 		int days2 = 0;
-		if(quotations.begin() != quotations.end()) days2 = quotations.begin().key().daysTo(date1);
+		if(!quotations.isEmpty()) days2 = quotations.first().date().daysTo(date1);
 		if(days2 > days) {
 			days2 = days;
 		}
@@ -540,15 +642,13 @@ double Security::profit(const QDate &date1, const QDate &date2, bool estimate, b
 	return profit(date2, estimate, no_scheduled_shares) - profit(date1, estimate, no_scheduled_shares, cur);
 }
 double Security::yearlyRate() {
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	QMap<QDate, double>::const_iterator it_end = quotations.end();
-	if(it_end == it_begin) return 0.0;
-	it_end--;
-	QDate date1 = it_begin.key(), date2 = QDate::currentDate();
-	double q1 = it_begin.value(), q2 = it_end.value();
+	if(quotations.isEmpty()) return 0.0;
+	const Quotation &q_first = quotations.first(), &q_last = quotations.last();
+	QDate date1 = q_first.date(), date2 = QDate::currentDate();
+	double q1 = q_first.value, q2 = q_last.value;
 	int days = date1.daysTo(date2);
-	if(it_end.key() != date2 && q1 != q2) {
-		int days2 = it_end.key().daysTo(date2);
+	if(q_last.date() != date2 && q1 != q2) {
+		int days2 = q_last.date().daysTo(date2);
 		q2 *= pow(q2 / q1, days2 / (days - days2));
 	}
 	for(SecurityTransactionList<Income*>::const_iterator it = dividends.constBegin(); it != dividends.constEnd(); ++it) {
@@ -567,9 +667,8 @@ double Security::yearlyRate() {
 	return pow(change, 1 / o_budget->yearsBetweenDates(date1, date2, false)) - 1;
 }
 double Security::yearlyRate(const QDate &date) {
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	if(it_begin == quotations.end()) return 0.0;
-	QDate date1 = it_begin.key();
+	if(quotations.isEmpty()) return 0.0;
+	QDate date1 = quotations.first().date();
 	QDate date2 = date;
 	if(date1 >= date2) return 0.0;
 	QDate curdate = QDate::currentDate();
@@ -581,7 +680,7 @@ double Security::yearlyRate(const QDate &date) {
 		return ((rate1 * days1) + (rate2 * days2)) / (days1 + days2);
 	}
 	QDate date2_q;
-	double q1 = it_begin.value(), q2 = getQuotation(date2, &date2_q);
+	double q1 = quotations.first().value, q2 = getQuotation(date2, &date2_q);
 	int days = date1.daysTo(date2);
 	if(date2 != date2_q && q1 != q2) {
 		int days2 = date2_q.daysTo(date2);
@@ -606,8 +705,7 @@ double Security::yearlyRate(const QDate &date) {
 double Security::yearlyRate(const QDate &date1, const QDate &date2) {
 	if(date1 > date2) return yearlyRate(date2, date1);
 	if(date1 == date2) return 0.0;
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	if(it_begin == quotations.end()) return 0.0;
+	if(quotations.isEmpty()) return 0.0;
 	QDate curdate = QDate::currentDate();
 	if(date1 >= curdate) {
 		double dp = profit(date1, date2, true, true), dv = value(date1, true, true);
@@ -622,11 +720,11 @@ double Security::yearlyRate(const QDate &date1, const QDate &date2) {
 		int days2 = curdate.daysTo(date2);
 		return ((rate1 * days1) + (rate2 * days2)) / (days1 + days2);
 	}
-	if(date2 < it_begin.key()) {
+	if(date2 < quotations.first().date()) {
 		return 0.0;
 	}
-	if(date1 < it_begin.key()) {
-		return yearlyRate(it_begin.key(), date2);
+	if(date1 < quotations.first().date()) {
+		return yearlyRate(quotations.first().date(), date2);
 	}
 	QDate date1_q, date2_q;
 	double q1 = getQuotation(date1, &date1_q);
@@ -666,37 +764,25 @@ double Security::yearlyRate(const QDate &date1, const QDate &date2) {
 	return pow(change, 1 / o_budget->yearsBetweenDates(date1, date2, false)) - 1;
 }
 double Security::expectedQuotation(const QDate &date) {
-	if(quotations.contains(date)) {
-		return quotations[date];
-	}
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	QMap<QDate, double>::const_iterator it = quotations.end();
-	if(it == it_begin) return 0.0;
-	--it;
-	if(it == it_begin) return it_begin.value();
-	if(date < it_begin.key()) {
-		int days = date.daysTo(it_begin.key());
-		double q2 = expectedQuotation(it_begin.key().addDays(days));
-		return it_begin.value() * (it_begin.value() / q2);
-	}
-	if(it.key() < date) {
-		int days = it.key().daysTo(date);
-		double q1 = expectedQuotation(it.key().addDays(-days));
-		return it.value() * (it.value() / q1);
-	}
-	--it;
-	while(true) {
-		if(it.key() < date) {
-			it_begin = it;
-			++it;
-			double days = it_begin.key().daysTo(date), days2 = it_begin.key().daysTo(it.key());
-			if(it.value() == it_begin.value()) return it.value();
-			double rate = it.value() / it_begin.value();
-			return it_begin.value() * pow(rate, days / days2);
-		}
-		if(it == it_begin) break;
-		--it;
-	}
-	return 0.0;
+	if(quotations.isEmpty()) return 0.0;
+	const Quotation &q_first = quotations.first(), &q_last = quotations.last();
+	if(quotations.count() == 1) return q_first.value;
+	if(date < q_first.date()) {
+		int days = date.daysTo(q_first.date());
+		double q2 = expectedQuotation(q_first.date().addDays(days));
+		return q_first.value * (q_first.value / q2);
+	}
+	if(q_last.date() < date) {
+		int days = q_last.date().daysTo(date);
+		double q1 = expectedQuotation(q_last.date().addDays(-days));
+		return q_last.value * (q_last.value / q1);
+	}
+	QuotationList::const_iterator it = quotations.upperBound(date);
+	if(it == quotations.constEnd()) return q_last.value;
+	QuotationList::const_iterator it_prev = it - 1;
+	if(it_prev->day == date.toJulianDay() || it->value == it_prev->value) return it_prev->value;
+	double days = it_prev->date().daysTo(date), days2 = it_prev->date().daysTo(it->date());
+	double rate = it->value / it_prev->value;
+	return it_prev->value * pow(rate, days / days2);
 }
 
@@ -25,6 +25,7 @@
 #include <QDateTime>
 #include <QMap>
 #include <QList>
+#include <QVector>
 
 #include "transaction.h"
 #include "eqonomizelist.h"
@@ -85,6 +86,46 @@ template<class type> class TradedSharesList : public EqonomizeList<type> {
 		}
 };
 
+struct Quotation {
+	qint64 day;
+	double value;
+	bool b_auto;
+	QDate date() const {return QDate::fromJulianDay(day);}
+};
+
+class QuotationList {
+
+	protected:
+
+		QVector<Quotation> v_quotations;
+
+	public:
+
+		typedef QVector<Quotation>::const_iterator const_iterator;
+
+		const_iterator begin() const {return v_quotations.constBegin();}
+		const_iterator end() const {return v_quotations.constEnd();}
+		const_iterator constBegin() const {return v_quotations.constBegin();}
+		const_iterator constEnd() const {return v_quotations.constEnd();}
+		int count() const {return v_quotations.count();}
+		bool isEmpty() const {return v_quotations.isEmpty();}
+		const Quotation &first() const {return v_quotations.first();}
+		const Quotation &last() const {return v_quotations.last();}
+		void clear() {v_quotations.clear();}
+		void reserve(int n) {v_quotations.reserve(n);}
+
+		const_iterator find(const QDate &date) const;
+		const_iterator upperBound(const QDate &date) const;
+		bool contains(const QDate &date) const;
+		void insert(const QDate &date, double value, bool auto_added = false);
+		bool remove(const QDate &date);
+		void merge(const QuotationList &quotations, bool keep = true);
+		//unsorted append for bulk loading, sort() must be called before the list is used
+		void append(const QDate &date, double value, bool auto_added = false);
+		void sort();
+
+};
+
 class Security {
 
 	protected:
@@ -107,7 +148,12 @@ class Security {
 
 		bool b_closed;
 
+		QVector<qint64> shares_timeline_days;
+		QVector<double> shares_timeline;
+		bool b_shares_timeline_valid;
+
 		void init();
+		void rebuildSharesTimeline();
 
 	public:
 
@@ -151,6 +197,8 @@ class Security {
 		void removeQuotation(const QDate &date, bool auto_added = false);
 		void clearQuotations();
 		double getQuotation(const QDate &date, QDate *actual_date = NULL) const;
+		// quotations at each date (preferably in ascending order); with interpolate, values between the first and last quotation are interpolated as in expectedQuotation()
+		void getQuotations(const QVector<QDate> &dates, QVector<double> &values, bool interpolate = false) const;
 		AssetsAccount *account() const;
 		Currency *currency() const;
 		int decimals() const;
@@ -161,9 +209,11 @@ class Security {
 
 		double shares();
 		double shares(const QDate &date, bool estimate = false, bool no_scheduled_shares = false);
+		void sharesModified();
 		double value();
 		// estime > 0: estimate future value; estimate < 0: estimate value between quotations
 		double value(const QDate &date, int estimate = 0, bool no_scheduled_shares = false);
+		void values(const QVector<QDate> &dates, QVector<double> &values, int estimate = 0, bool no_scheduled_shares = false);
 		double cost(Currency *cur = NULL);
 		double cost(const QDate &date, bool no_scheduled_shares = false, Currency *cur = NULL);
 		double profit(Currency *cur = NULL);
@@ -174,8 +224,7 @@ class Security {
 		double yearlyRate(const QDate &date_from, const QDate &date_to);
 		double expectedQuotation(const QDate &date);
 
-		QMap<QDate, double> quotations;
-		QMap<QDate, bool> quotations_auto;
+		QuotationList quotations;
 		TradedSharesList<SecurityTrade*> tradedShares;
 		SecurityTransactionList<SecurityTransaction*> transactions;
 		SecurityTransactionList<Income*> dividends;
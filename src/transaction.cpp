@@ -38,6 +38,12 @@ static const QString emptystr;
 static const QDate emptydate;
 static qint64 zero_timestamp;
 
+//descriptions of all transactions and splits are sorted using the same collation
+static QCollator &description_collator() {
+	static QCollator collator(QLocale::system());
+	return collator;
+}
+
 Transactions::Transactions(Budget *parent_budget) : i_id(0), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()), o_budget(parent_budget) {}
 Transactions::Transactions() : i_id(0), i_first_revision(1), i_last_revision(1), o_budget(NULL) {}
 Transactions::Transactions(const Transactions *trans) : i_id(trans->id()), i_first_revision(trans->firstRevision()), i_last_revision(trans->lastRevision()), o_budget(trans->budget()) {
@@ -49,7 +55,9 @@ Transactions::Transactions(const Transactions *trans) : i_id(trans->id()), i_fir
 	}
 }
 void Transactions::set(const Transactions *trans) {
+	qlonglong old_id = i_id;
 	i_id = trans->id();
+	if(o_budget && old_id != i_id) o_budget->transactionIdModified(this, old_id);
 	i_first_revision = trans->firstRevision();
 	i_last_revision = trans->lastRevision();
 	tags.clear();
@@ -76,7 +84,10 @@ void Transactions::setTimestamp() {
 Budget *Transactions::budget() const {return o_budget;}
 qlonglong Transactions::id() const {return i_id;}
 void Transactions::setId(qlonglong new_id) {
+	if(i_id == new_id) return;
+	qlonglong old_id = i_id;
 	i_id = new_id;
+	if(o_budget) o_budget->transactionIdModified(this, old_id);
 }
 int Transactions::firstRevision() const {return i_first_revision;}
 void Transactions::setFirstRevision(int new_rev) {i_first_revision = new_rev; if(i_first_revision > i_last_revision) i_last_revision = i_first_revision;}
@@ -258,19 +269,21 @@ QString Transactions::writeLinks(bool) const {
 }
 
 
-Transaction::Transaction(Budget *parent_budget, double initial_value, QDate initial_date, Account *from, Account *to, QString initial_description, QString initial_comment, qlonglong initial_id) : Transactions(parent_budget), d_value(initial_value), d_date(initial_date), o_from(from), o_to(to), s_description(initial_description.trimmed()), s_comment(initial_comment.trimmed()), d_quantity(1.0), o_split(NULL), i_time(QDateTime::currentMSecsSinceEpoch() / 1000) {
+Transaction::Transaction(Budget *parent_budget, double initial_value, QDate initial_date, Account *from, Account *to, QString initial_description, QString initial_comment, qlonglong initial_id) : Transactions(parent_budget), d_value(initial_value), d_date(initial_date), o_from(from), o_to(to), s_description(initial_description.trimmed()), s_comment(initial_comment.trimmed()), d_quantity(1.0), o_split(NULL), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), o_sort_key(NULL) {
 	if(initial_id < 0) i_id = o_budget->getNewId();
 	else i_id = initial_id;
 }
-Transaction::Transaction(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : Transactions(parent_budget) {
+Transaction::Transaction(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : Transactions(parent_budget), o_sort_key(NULL) {
 	QXmlStreamAttributes attr = xml->attributes();
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-Transaction::Transaction(Budget *parent_budget) : Transactions(parent_budget), d_value(0.0), o_from(NULL), o_to(NULL), d_quantity(1.0), o_split(NULL), i_time(QDateTime::currentMSecsSinceEpoch() / 1000) {}
-Transaction::Transaction() : Transactions(), d_value(0.0), o_from(NULL), o_to(NULL), d_quantity(1.0), o_split(NULL), i_time(QDateTime::currentMSecsSinceEpoch() / 1000) {}
-Transaction::Transaction(const Transaction *transaction) : Transactions(transaction), d_value(transaction->value()), d_date(transaction->date()), o_from(transaction->fromAccount()), o_to(transaction->toAccount()), s_description(transaction->description()), s_comment(transaction->comment()), s_file(transaction->associatedFile()), d_quantity(transaction->quantity()), o_split(NULL), i_time(transaction->timestamp()) {}
-Transaction::~Transaction() {}
+Transaction::Transaction(Budget *parent_budget) : Transactions(parent_budget), d_value(0.0), o_from(NULL), o_to(NULL), d_quantity(1.0), o_split(NULL), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), o_sort_key(NULL) {}
+Transaction::Transaction() : Transactions(), d_value(0.0), o_from(NULL), o_to(NULL), d_quantity(1.0), o_split(NULL), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), o_sort_key(NULL) {}
+Transaction::Transaction(const Transaction *transaction) : Transactions(transaction), d_value(transaction->value()), d_date(transaction->date()), o_from(transaction->fromAccount()), o_to(transaction->toAccount()), s_description(transaction->description()), s_comment(transaction->comment()), s_file(transaction->associatedFile()), d_quantity(transaction->quantity()), o_split(NULL), i_time(transaction->timestamp()), o_sort_key(NULL) {}
+Transaction::~Transaction() {
+	if(o_sort_key) delete o_sort_key;
+}
 
 void Transaction::set(const Transactions *trans) {
 	Transactions::set(trans);
@@ -284,6 +297,7 @@ void Transaction::set(const Transactions *trans) {
 		s_file = ((Transaction*) trans)->associatedFile();
 		d_quantity = ((Transaction*) trans)->quantity();
 		i_time = ((Transaction*) trans)->timestamp();
+		if(o_budget) o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -416,14 +430,19 @@ bool Transaction::hasLinkId(qlonglong lid, bool include_parent) const {
 SplitTransaction *Transaction::parentSplit() const {return o_split;}
 void Transaction::setParentSplit(SplitTransaction *parent) {
 	if(o_split == parent) return;
+	SplitTransaction *old_split = o_split;
 	o_split = parent;
 	if(o_split) i_time = o_split->timestamp();
 	//o_budget->transactionSortModified(this);
+	if(o_budget) {
+		if(old_split) o_budget->transactionAccountsModified(old_split);
+		if(o_split) o_budget->transactionAccountsModified(o_split);
+	}
 }
 double Transaction::value(bool convert) const {
 	if(convert && currency() && currency() != budget()->defaultCurrency()) {
-		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return currency()->convertTo(d_value, budget()->defaultCurrency(), d_date);
-		else return currency()->convertTo(d_value, budget()->defaultCurrency());
+		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return budget()->defaultCurrencyConverter(currency()).convert(d_value, d_date);
+		else return budget()->defaultCurrencyConverter(currency()).convert(d_value);
 	}
 	return d_value;
 }
@@ -444,9 +463,15 @@ Currency *Transaction::toCurrency() const {
 	if(fromAccount()->type() == ACCOUNT_TYPE_ASSETS) return ((AssetsAccount*) fromAccount())->currency();
 	return NULL;
 }
-void Transaction::setValue(double new_value) {d_value = new_value;}
+void Transaction::setValue(double new_value) {
+	d_value = new_value;
+	if(o_budget) o_budget->transactionValueModified(this);
+}
 double Transaction::quantity() const {return d_quantity;}
-void Transaction::setQuantity(double new_quantity) {d_quantity = new_quantity;}
+void Transaction::setQuantity(double new_quantity) {
+	d_quantity = new_quantity;
+	if(o_budget) o_budget->transactionQuantityModified(this);
+}
 const QDate &Transaction::date() const {return d_date;}
 void Transaction::setDate(QDate new_date) {
 	if(new_date == d_date) return;
@@ -460,7 +485,21 @@ void Transaction::setTimestamp(qint64 cr_time) {
 	i_time = cr_time;
 	o_budget->transactionSortModified(this);
 }
+void Transaction::readTimestampAndQuantity(qint64 cr_time, double new_quantity) {
+	i_time = cr_time;
+	d_quantity = new_quantity;
+}
 QString Transaction::description() const {return s_description;}
+const QCollatorSortKey &Transaction::descriptionSortKey() const {
+	//the description of some transactions includes the name of a loan or security, which might have been changed
+	QString desc = description();
+	if(!o_sort_key || desc != s_sort_key_description) {
+		if(o_sort_key) delete o_sort_key;
+		o_sort_key = new QCollatorSortKey(description_collator().sortKey(desc));
+		s_sort_key_description = desc;
+	}
+	return *o_sort_key;
+}
 void Transaction::setDescription(QString new_description) {
 	if(new_description == s_description) return;
 	s_description = new_description.trimmed();
@@ -471,12 +510,28 @@ void Transaction::setComment(QString new_comment) {s_comment = new_comment.trimm
 const QString &Transaction::associatedFile() const {return s_file;}
 void Transaction::setAssociatedFile(QString new_attachment) {s_file = new_attachment.trimmed();}
 Account *Transaction::fromAccount() const {return o_from;}
-void Transaction::setFromAccount(Account *new_from) {o_from = new_from;}
+void Transaction::setFromAccount(Account *new_from) {
+	o_from = new_from;
+	if(o_budget) o_budget->transactionAccountsModified(this);
+}
 Account *Transaction::toAccount() const {return o_to;}
-void Transaction::setToAccount(Account *new_to) {o_to = new_to;}
+void Transaction::setToAccount(Account *new_to) {
+	o_to = new_to;
+	if(o_budget) o_budget->transactionAccountsModified(this);
+}
 GeneralTransactionType Transaction::generaltype() const {return GENERAL_TRANSACTION_TYPE_SINGLE;}
 TransactionSubType Transaction::subtype() const {return (TransactionSubType) type();}
 bool Transaction::relatesToAccount(Account *account, bool include_subs, bool) const {return o_from == account || o_to == account || (include_subs && (o_from->topAccount() == account || o_to->topAccount() == account));}
+void Transaction::relatedAccounts(QVector<Account*> &accounts) const {
+	if(o_from) {
+		accounts << o_from;
+		if(o_from->topAccount() != o_from) accounts << o_from->topAccount();
+	}
+	if(o_to) {
+		accounts << o_to;
+		if(o_to->topAccount() != o_to) accounts << o_to->topAccount();
+	}
+}
 void Transaction::replaceAccount(Account *old_account, Account *new_account) {
 	if(o_from == old_account) o_from = new_account;
 	if(o_to == old_account) o_to = new_account;
@@ -588,12 +643,17 @@ DebtFee::DebtFee(const DebtFee *loanfee) : Expense(loanfee) {
 	o_loan = loanfee->loan();
 }
 bool DebtFee::relatesToAccount(Account *account, bool include_subs, bool include_non_value) const {return (include_non_value && o_loan == account) || Expense::relatesToAccount(account, include_subs, include_non_value);}
+void DebtFee::relatedAccounts(QVector<Account*> &accounts) const {
+	Expense::relatedAccounts(accounts);
+	if(o_loan) accounts << o_loan;
+}
 DebtFee::~DebtFee() {}
 Transaction *DebtFee::copy() const {return new DebtFee(this);}
 void DebtFee::set(const Transactions *trans) {
 	Expense::set(trans);
 	if(trans->generaltype() == generaltype() && ((Transaction*) trans)->type() == type() && ((Transaction*) trans)->subtype() == subtype()) {
 		o_loan = ((DebtFee*) trans)->loan();
+		if(o_budget) o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -612,7 +672,10 @@ void DebtFee::writeAttributes(QXmlStreamAttributes *attr) {
 }
 
 AssetsAccount *DebtFee::loan() const {return o_loan;}
-void DebtFee::setLoan(AssetsAccount *new_loan) {o_loan = new_loan;}
+void DebtFee::setLoan(AssetsAccount *new_loan) {
+	o_loan = new_loan;
+	if(o_budget) o_budget->transactionAccountsModified(this);
+}
 const QString &DebtFee::payee() const {
 	if(o_loan) return o_loan->maintainer();
 	return s_payee;
@@ -642,6 +705,7 @@ void DebtInterest::set(const Transactions *trans) {
 	Expense::set(trans);
 	if(trans->generaltype() == generaltype() && ((Transaction*) trans)->type() == type() && ((Transaction*) trans)->subtype() == subtype()) {
 		o_loan = ((DebtInterest*) trans)->loan();
+		if(o_budget) o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -660,7 +724,10 @@ void DebtInterest::writeAttributes(QXmlStreamAttributes *attr) {
 }
 
 AssetsAccount *DebtInterest::loan() const {return o_loan;}
-void DebtInterest::setLoan(AssetsAccount *new_loan) {o_loan = new_loan;}
+void DebtInterest::setLoan(AssetsAccount *new_loan) {
+	o_loan = new_loan;
+	if(o_budget) o_budget->transactionAccountsModified(this);
+}
 const QString &DebtInterest::payee() const {
 	if(o_loan) return o_loan->maintainer();
 	return s_payee;
@@ -668,6 +735,10 @@ const QString &DebtInterest::payee() const {
 QString DebtInterest::description() const {return tr("Debt payment: %1 (interest)").arg(o_loan->name());}
 TransactionSubType DebtInterest::subtype() const {return TRANSACTION_SUBTYPE_DEBT_INTEREST;}
 bool DebtInterest::relatesToAccount(Account *account, bool include_subs, bool include_non_value) const {return (include_non_value && o_loan == account) || Expense::relatesToAccount(account, include_subs, include_non_value);}
+void DebtInterest::relatedAccounts(QVector<Account*> &accounts) const {
+	Expense::relatedAccounts(accounts);
+	if(o_loan) accounts << o_loan;
+}
 void DebtInterest::replaceAccount(Account *old_account, Account *new_account) {
 	if(o_loan == old_account && new_account->type() == ACCOUNT_TYPE_ASSETS) o_loan = (AssetsAccount*) new_account;
 	Transaction::replaceAccount(old_account, new_account);
@@ -845,13 +916,14 @@ double ReinvestedDividend::shareValue(bool convert) const {
 	double v = 0.0;
 	if(o_security) v = o_security->getQuotation(date());
 	if(convert && o_security && o_security->currency()) {
-		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return o_security->currency()->convertTo(v, budget()->defaultCurrency(), date());
-		else return o_security->currency()->convertTo(v, budget()->defaultCurrency());
+		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return budget()->defaultCurrencyConverter(o_security->currency()).convert(v, date());
+		else return budget()->defaultCurrencyConverter(o_security->currency()).convert(v);
 	}
 	return v;
 }
 void ReinvestedDividend::setShares(double new_shares) {
 	d_shares = new_shares;
+	if(o_budget) o_budget->transactionSharesModified(this);
 }
 QString ReinvestedDividend::description() const {
 	return tr("Reinvested dividend: %1").arg(o_security->name());
@@ -969,8 +1041,8 @@ double Transfer::withdrawal(bool convert) const {
 }
 double Transfer::deposit(bool convert) const {
 	if(convert && to() && to()->currency()) {
-		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return to()->currency()->convertTo(d_deposit, budget()->defaultCurrency(), date());
-		else return to()->currency()->convertTo(d_deposit, budget()->defaultCurrency());
+		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return budget()->defaultCurrencyConverter(to()->currency()).convert(d_deposit, date());
+		else return budget()->defaultCurrencyConverter(to()->currency()).convert(d_deposit);
 	} else if(convert) return withdrawal(true);
 	return d_deposit;
 }
@@ -1104,6 +1176,7 @@ void SecurityTransaction::set(const Transactions *trans) {
 		d_shares = ((SecurityTransaction*) trans)->shares();
 		o_security = ((SecurityTransaction*) trans)->security();
 		b_reconciled = (account() && account()->type() == ACCOUNT_TYPE_ASSETS ? ((SecurityTransaction*) trans)->isReconciled((AssetsAccount*) account()) : false);
+		if(o_budget) o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -1143,13 +1216,14 @@ double SecurityTransaction::shareValue(bool convert) const {
 	double v = 0.0;
 	if(o_security) v = o_security->getQuotation(date());
 	if(convert && o_security && o_security->currency()) {
-		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return o_security->currency()->convertTo(v, budget()->defaultCurrency(), date());
-		else return o_security->currency()->convertTo(v, budget()->defaultCurrency());
+		if(budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE) return budget()->defaultCurrencyConverter(o_security->currency()).convert(v, date());
+		else return budget()->defaultCurrencyConverter(o_security->currency()).convert(v);
 	}
 	return v;
 }
 void SecurityTransaction::setShares(double new_shares) {
 	d_shares = new_shares;
+	if(o_budget) o_budget->transactionSharesModified(this);
 }
 double SecurityTransaction::value(bool convert) const {
 	return Transaction::value(convert);
@@ -1168,9 +1242,14 @@ Account *SecurityTransaction::toAccount() const {return o_security->account();}
 QString SecurityTransaction::description() const {return Transaction::description();}
 void SecurityTransaction::setSecurity(Security *parent_security) {
 	o_security = parent_security;
+	if(o_budget) o_budget->transactionAccountsModified(this);
 }
 Security *SecurityTransaction::security() const {return o_security;}
 bool SecurityTransaction::relatesToAccount(Account *account, bool, bool) const {return fromAccount() == account || toAccount() == account;}
+void SecurityTransaction::relatedAccounts(QVector<Account*> &accounts) const {
+	Transaction::relatedAccounts(accounts);
+	if(o_security && o_security->account()) accounts << o_security->account();
+}
 double SecurityTransaction::accountChange(Account *account, bool, bool convert) const {
 	if(fromAccount() == account) return -fromValue(convert);
 	if(toAccount() == account) return toValue(convert);
@@ -1538,10 +1617,8 @@ void ScheduledTransaction::setRecurrence(Recurrence *rec, bool delete_old) {
 	if(o_rec && delete_old) delete o_rec;
 	o_rec = rec;
 	if(o_trans && o_rec && o_rec->startDate() != o_trans->date()) o_trans->setDate(o_rec->startDate());
-	if(o_rec) {
-		o_budget->scheduledTransactionSortModified(this);
-		o_budget->scheduledTransactionDateModified(this);
-	}
+	if(o_rec) o_budget->scheduledTransactionSortModified(this);
+	o_budget->scheduledTransactionDateModified(this);
 }
 const QDate &ScheduledTransaction::firstOccurrence() const {
 	if(o_rec) return o_rec->firstOccurrence();
@@ -1586,6 +1663,7 @@ void ScheduledTransaction::addException(QDate exceptiondate) {
 		o_budget->scheduledTransactionDateModified(this);
 	} else {
 		o_rec->addException(exceptiondate);
+		o_budget->scheduledTransactionDateModified(this);
 	}
 }
 Transactions *ScheduledTransaction::realize(QDate date) {
@@ -1620,6 +1698,7 @@ void ScheduledTransaction::setTransaction(Transactions *trans, bool delete_old)
 		o_budget->scheduledTransactionSortModified(this);
 		o_budget->scheduledTransactionDateModified(this);
 	}
+	o_budget->transactionAccountsModified(this);
 }
 double ScheduledTransaction::value(bool convert) const {
 	if(!o_trans) return 0.0;
@@ -1658,6 +1737,7 @@ int ScheduledTransaction::transactionsubtype() const {
 	return -1;
 }
 bool ScheduledTransaction::relatesToAccount(Account *account, bool include_subs, bool include_non_value) const {return o_trans && o_trans->relatesToAccount(account, include_subs, include_non_value);}
+void ScheduledTransaction::relatedAccounts(QVector<Account*> &accounts) const {if(o_trans) o_trans->relatedAccounts(accounts);}
 void ScheduledTransaction::replaceAccount(Account *old_account, Account *new_account) {if(o_trans) o_trans->replaceAccount(old_account, new_account);}
 double ScheduledTransaction::accountChange(Account *account, bool include_subs, bool convert) const {
 	if(o_trans) return o_trans->accountChange(account, include_subs, convert);
@@ -1705,26 +1785,28 @@ bool ScheduledTransaction::hasLinkId(qlonglong lid, bool include_parent) const {
 void ScheduledTransaction::readLinks(const QString &text) {if(o_trans) o_trans->readLinks(text);}
 QString ScheduledTransaction::writeLinks(bool include_parent) const {if(o_trans) {return o_trans->writeLinks(include_parent);} return QString();}
 
-SplitTransaction::SplitTransaction(Budget *parent_budget, QDate initial_date, QString initial_description) : Transactions(parent_budget), d_date(initial_date), s_description(initial_description.trimmed()), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), b_reconciled(false) {i_id = o_budget->getNewId();}
-SplitTransaction::SplitTransaction(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : Transactions(parent_budget) {
+SplitTransaction::SplitTransaction(Budget *parent_budget, QDate initial_date, QString initial_description) : Transactions(parent_budget), d_date(initial_date), s_description(initial_description.trimmed()), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), b_reconciled(false), o_sort_key(NULL) {i_id = o_budget->getNewId();}
+SplitTransaction::SplitTransaction(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : Transactions(parent_budget), o_sort_key(NULL) {
 	QXmlStreamAttributes attr = xml->attributes();
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-SplitTransaction::SplitTransaction(const SplitTransaction *split) : Transactions(split), d_date(split->date()), s_description(split->description()), s_comment(split->comment()), s_file(split->associatedFile()), i_time(split->timestamp()), b_reconciled(false) {
+SplitTransaction::SplitTransaction(const SplitTransaction *split) : Transactions(split), d_date(split->date()), s_description(split->description()), s_comment(split->comment()), s_file(split->associatedFile()), i_time(split->timestamp()), b_reconciled(false), o_sort_key(NULL) {
 	for(int i = 0; i < split->count(); i++) {
 		Transaction *trans = split->at(i)->copy();
 		trans->setParentSplit(this);
 		splits.push_back(trans);
 	}
 }
-SplitTransaction::SplitTransaction(Budget *parent_budget) : Transactions(parent_budget), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), b_reconciled(false) {}
-SplitTransaction::SplitTransaction() : Transactions(), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), b_reconciled(false) {}
+SplitTransaction::SplitTransaction(Budget *parent_budget) : Transactions(parent_budget), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), b_reconciled(false), o_sort_key(NULL) {}
+SplitTransaction::SplitTransaction() : Transactions(), i_time(QDateTime::currentMSecsSinceEpoch() / 1000), b_reconciled(false), o_sort_key(NULL) {}
 SplitTransaction::~SplitTransaction() {
 	clear();
+	if(o_sort_key) delete o_sort_key;
 }
 void SplitTransaction::set(const Transactions *trans) {
 	Transactions::set(trans);
+	resetDescriptionSortKey();
 	if(trans->generaltype() == generaltype()) {
 		SplitTransaction *split = (SplitTransaction*) trans;
 		i_time = split->timestamp();
@@ -1742,6 +1824,7 @@ void SplitTransaction::readAttributes(QXmlStreamAttributes *attr, bool*) {
 	read_id(attr, i_id, i_first_revision, i_last_revision);
 	i_time = attr->value("timestamp").toLongLong();
 	s_description = attr->value("description").trimmed().toString();
+	resetDescriptionSortKey();
 	if(attr->hasAttribute("tags")) readTags(attr->value("tags").toString());
 	if(attr->hasAttribute("links")) readLinks(attr->value("links").toString());
 	s_comment = attr->value("comment").trimmed().toString();
@@ -1855,7 +1938,20 @@ void SplitTransaction::setTimestamp(qint64 cr_time) {
 	}
 }
 QString SplitTransaction::description() const {return s_description;}
-void SplitTransaction::setDescription(QString new_description) {s_description = new_description.trimmed();}
+void SplitTransaction::setDescription(QString new_description) {
+	s_description = new_description.trimmed();
+	resetDescriptionSortKey();
+}
+const QCollatorSortKey &SplitTransaction::descriptionSortKey() const {
+	if(!o_sort_key) o_sort_key = new QCollatorSortKey(description_collator().sortKey(description()));
+	return *o_sort_key;
+}
+void SplitTransaction::resetDescriptionSortKey() {
+	if(o_sort_key) {
+		delete o_sort_key;
+		o_sort_key = NULL;
+	}
+}
 const QString &SplitTransaction::comment() const {return s_comment;}
 void SplitTransaction::setComment(QString new_comment) {s_comment = new_comment;}
 const QString &SplitTransaction::associatedFile() const {return s_file;}
@@ -1879,6 +1975,12 @@ bool SplitTransaction::relatesToAccount(Account *account, bool include_subs, boo
 	}
 	return false;
 }
+void SplitTransaction::relatedAccounts(QVector<Account*> &accounts) const {
+	int c = splits.count();
+	for(int i = 0; i < c; i++) {
+		splits[i]->relatedAccounts(accounts);
+	}
+}
 void SplitTransaction::replaceAccount(Account *old_account, Account *new_account) {
 	int c = splits.count();
 	for(int i = 0; i < c; i++) {
@@ -2036,6 +2138,7 @@ void MultiItemTransaction::set(const Transactions *trans) {
 		o_account = ((MultiItemTransaction*) trans)->account();
 		s_payee = ((MultiItemTransaction*) trans)->payee();
 		b_reconciled = ((MultiItemTransaction*) trans)->isReconciled(o_account);
+		o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -2333,6 +2436,7 @@ void MultiItemTransaction::setAccount(AssetsAccount *new_account) {
 		}
 	}
 	o_account = new_account;
+	o_budget->transactionAccountsModified(this);
 }
 const QString &MultiItemTransaction::payee() const {return s_payee;}
 void MultiItemTransaction::setPayee(QString new_payee) {
@@ -2383,6 +2487,10 @@ SplitTransactionType MultiItemTransaction::type() const {
 bool MultiItemTransaction::relatesToAccount(Account *account, bool include_subs, bool include_non_value) const {
 	return (include_non_value && o_account == account) || SplitTransaction::relatesToAccount(account, include_subs, include_non_value);
 }
+void MultiItemTransaction::relatedAccounts(QVector<Account*> &accounts) const {
+	if(o_account) accounts << o_account;
+	SplitTransaction::relatedAccounts(accounts);
+}
 void MultiItemTransaction::replaceAccount(Account *old_account, Account *new_account) {
 	if(o_account == old_account && new_account->type() == ACCOUNT_TYPE_ASSETS) o_account = (AssetsAccount*) new_account;
 	SplitTransaction::replaceAccount(old_account, new_account);
@@ -2418,6 +2526,7 @@ void MultiAccountTransaction::set(const Transactions *trans) {
 	if(trans->generaltype() == generaltype() && ((SplitTransaction*) trans)->type() == type()) {
 		o_category = ((MultiAccountTransaction*) trans)->category();
 		d_quantity = ((MultiAccountTransaction*) trans)->quantity();
+		o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -2586,6 +2695,7 @@ void MultiAccountTransaction::setCategory(CategoryAccount *new_category) {
 		}
 	}
 	o_category = new_category;
+	o_budget->transactionAccountsModified(this);
 }
 
 AssetsAccount *MultiAccountTransaction::account() const {
@@ -2632,6 +2742,7 @@ void MultiAccountTransaction::setDescription(QString new_description) {
 		splits[i]->setDescription(new_description);
 	}
 	s_description = new_description;
+	resetDescriptionSortKey();
 }
 SplitTransactionType MultiAccountTransaction::type() const {
 	return SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS;
@@ -2644,6 +2755,13 @@ bool MultiAccountTransaction::isIncomesAndExpenses() const {return true;}
 bool MultiAccountTransaction::relatesToAccount(Account *account, bool include_subs, bool include_non_value) const {
 	return (include_non_value && o_category && (o_category == account || (include_subs && o_category->topAccount() == account))) || SplitTransaction::relatesToAccount(account, include_subs, include_non_value);
 }
+void MultiAccountTransaction::relatedAccounts(QVector<Account*> &accounts) const {
+	if(o_category) {
+		accounts << o_category;
+		if(o_category->topAccount() != o_category) accounts << o_category->topAccount();
+	}
+	SplitTransaction::relatedAccounts(accounts);
+}
 void MultiAccountTransaction::replaceAccount(Account *old_account, Account *new_account) {
 	if(o_category == old_account && (new_account->type() == ACCOUNT_TYPE_INCOMES || new_account->type() == ACCOUNT_TYPE_EXPENSES)) o_category = (CategoryAccount*) new_account;
 	if(new_account->type() == ACCOUNT_TYPE_ASSETS && ((AssetsAccount*) new_account)->currency() != currency()) return;
@@ -2678,6 +2796,7 @@ void DebtPayment::set(const Transactions *trans) {
 		if(split->payment() != 0.0) setPayment(split->payment(), split->reduction());
 		setExpenseCategory(split->expenseCategory());
 		b_reconciled = split->isReconciled(split->account());
+		o_budget->transactionAccountsModified(this);
 	}
 }
 
@@ -2857,6 +2976,7 @@ void DebtPayment::setLoan(AssetsAccount *new_loan) {
 	if(o_interest) o_interest->setLoan(new_loan);
 	if(o_payment) o_payment->setLoan(new_loan);
 	o_loan = new_loan;
+	o_budget->transactionAccountsModified(this);
 }
 ExpensesAccount *DebtPayment::expenseCategory() const {
 	if(o_interest) return o_interest->category();
@@ -2873,6 +2993,7 @@ void DebtPayment::setAccount(AssetsAccount *new_account) {
 	if(o_interest) o_interest->setFrom(new_account);
 	if(o_payment) o_payment->setFrom(new_account);
 	o_account = new_account;
+	o_budget->transactionAccountsModified(this);
 }
 void DebtPayment::setDate(QDate new_date) {
 	if(new_date != d_date) {
@@ -2935,6 +3056,13 @@ void DebtPayment::removeTransaction(Transaction *trans, bool keep) {
 bool DebtPayment::relatesToAccount(Account *account, bool include_subs, bool include_non_value) const {
 	return (include_non_value && (o_account == account || o_loan == account)) || (o_fee && o_fee->relatesToAccount(account, include_subs, include_non_value)) || (o_interest && o_interest->relatesToAccount(account, include_subs, include_non_value)) || (o_payment && o_payment->relatesToAccount(account, include_subs, include_non_value));
 }
+void DebtPayment::relatedAccounts(QVector<Account*> &accounts) const {
+	if(o_account) accounts << o_account;
+	if(o_loan) accounts << o_loan;
+	if(o_fee) o_fee->relatedAccounts(accounts);
+	if(o_interest) o_interest->relatedAccounts(accounts);
+	if(o_payment) o_payment->relatedAccounts(accounts);
+}
 void DebtPayment::replaceAccount(Account *old_account, Account *new_account) {
 	if(new_account->type() == ACCOUNT_TYPE_ASSETS && ((AssetsAccount*) new_account)->currency() != currency()) return;
 	if(o_account == old_account && new_account->type() == ACCOUNT_TYPE_ASSETS) o_account = (AssetsAccount*) new_account;
@@ -26,6 +26,7 @@
 #include <QVector>
 #include <QCoreApplication>
 #include <QStringList>
+#include <QCollator>
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
@@ -43,6 +44,9 @@ class Security;
 class SplitTransaction;
 class Currency;
 
+#define SORT_KEY_TIMESTAMP_BITS 34
+#define SORT_KEY_DATE_BITS 29
+
 typedef enum {
 	TRANSACTION_TYPE_EXPENSE,
 	TRANSACTION_TYPE_INCOME,
@@ -115,6 +119,7 @@ class Transactions {
 		Budget *budget() const;
 		virtual GeneralTransactionType generaltype() const = 0;
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const = 0;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const = 0;
 		virtual void replaceAccount(Account *old_account, Account *new_account) = 0;
 		virtual double accountChange(Account *account, bool include_subs = true, bool convert = false) const = 0;
 		virtual bool isReconciled(AssetsAccount *account) const = 0;
@@ -179,6 +184,9 @@ class Transaction : public Transactions {
 
 		qint64 i_time;
 
+		mutable QCollatorSortKey *o_sort_key;
+		mutable QString s_sort_key_description;
+
 	public:
 
 		Transaction(Budget *parent_budget, double initial_value, QDate initial_date, Account *from, Account *to, QString initial_description = QString(), QString initial_comment = QString(), qlonglong initial_id = -1);
@@ -214,8 +222,23 @@ class Transaction : public Transactions {
 		void setDate(QDate new_date);
 		const qint64 &timestamp() const;
 		void setTimestamp(qint64 cr_time);
+		//sets timestamp and quantity read from a file, before the transaction is added to the budget (without notifying the budget)
+		void readTimestampAndQuantity(qint64 cr_time, double new_quantity);
+		//date and timestamp packed into one integer, for sorting with a single comparison (-1 if out of range)
+		qint64 sortKey() const {
+			qint64 jd = d_date.toJulianDay();
+			if(jd < 0 || jd >= (Q_INT64_C(1) << SORT_KEY_DATE_BITS) || i_time < 0 || i_time >= (Q_INT64_C(1) << SORT_KEY_TIMESTAMP_BITS)) return -1;
+			return (jd << SORT_KEY_TIMESTAMP_BITS) | i_time;
+		}
+		//timestamp, followed by date if timestamp is not set
+		qint64 stampSortKey() const {
+			qint64 jd = d_date.toJulianDay();
+			if(jd < 0 || jd >= (Q_INT64_C(1) << SORT_KEY_DATE_BITS) || i_time < 0 || i_time >= (Q_INT64_C(1) << SORT_KEY_TIMESTAMP_BITS)) return -1;
+			return (i_time << SORT_KEY_DATE_BITS) | (i_time == 0 ? jd : 0);
+		}
 		virtual QString description() const;
 		void setDescription(QString new_description);
+		const QCollatorSortKey &descriptionSortKey() const;
 		virtual const QString &comment() const;
 		void setComment(QString new_comment);
 		const QString &associatedFile() const;
@@ -228,6 +251,7 @@ class Transaction : public Transactions {
 		virtual TransactionType type() const = 0;
 		virtual TransactionSubType subtype() const;
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 		virtual double accountChange(Account *account, bool include_subs = true, bool convert = false) const;
 
@@ -322,6 +346,7 @@ class DebtFee : public Expense {
 		virtual QString description() const;
 		TransactionSubType subtype() const;
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 
 };
@@ -354,6 +379,7 @@ class DebtInterest : public Expense {
 		virtual QString description() const;
 		TransactionSubType subtype() const;
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 
 };
@@ -589,6 +615,7 @@ class SecurityTransaction : public Transaction {
 		Security *security() const;
 
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual double accountChange(Account *account, bool include_subs = true, bool convert = false) const;
 
 		virtual bool isReconciled(AssetsAccount *account) const;
@@ -701,6 +728,7 @@ class ScheduledTransaction : public Transactions {
 		virtual int transactionsubtype() const;
 
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 		virtual double accountChange(Account *account, bool include_subs = true, bool convert = false) const;
 
@@ -746,6 +774,7 @@ class SplitTransaction : public Transactions {
 		QVector<Transaction*> splits;
 		qint64 i_time;
 		bool b_reconciled;
+		mutable QCollatorSortKey *o_sort_key;
 
 	public:
 
@@ -783,6 +812,8 @@ class SplitTransaction : public Transactions {
 		void setTimestamp(qint64 cr_time);
 		QString description() const;
 		virtual void setDescription(QString new_description);
+		const QCollatorSortKey &descriptionSortKey() const;
+		void resetDescriptionSortKey();
 		const QString &comment() const;
 		virtual void setComment(QString new_comment);
 		const QString &associatedFile() const;
@@ -799,6 +830,7 @@ class SplitTransaction : public Transactions {
 		virtual bool isIncomesAndExpenses() const;
 
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 		virtual double accountChange(Account *account, bool include_subs = true, bool convert = false) const;
 
@@ -859,6 +891,7 @@ class MultiItemTransaction : public SplitTransaction {
 		int transactiontype() const;
 
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 
 		virtual bool isReconciled(AssetsAccount *account) const;
@@ -911,6 +944,7 @@ class MultiAccountTransaction : public SplitTransaction {
 		virtual bool isIncomesAndExpenses() const;
 
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 
 };
@@ -986,6 +1020,7 @@ class DebtPayment : public SplitTransaction {
 		virtual void removeTransaction(Transaction *trans, bool keep = false);
 
 		virtual bool relatesToAccount(Account *account, bool include_subs = true, bool include_non_value = false) const;
+		virtual void relatedAccounts(QVector<Account*> &accounts) const;
 		virtual void replaceAccount(Account *old_account, Account *new_account);
 		virtual double accountChange(Account *account, bool include_subs = true, bool convert = false) const;
 
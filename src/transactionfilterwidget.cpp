@@ -51,6 +51,11 @@
 TransactionFilterWidget::TransactionFilterWidget(bool extra_parameters, int transaction_type, Budget *budg, QWidget *parent) : QWidget(parent), transtype(transaction_type), budget(budg), b_extra(extra_parameters) {
 	tagCombo = NULL;
 	excludeSubsButton = NULL;
+	b_saved_include = false;
+	b_saved_exact = false; b_saved_exclude_subs = false; b_saved_duplicates = false;
+	b_saved_min = false; b_saved_max = false; b_saved_from = false;
+	saved_min = 0.0; saved_max = 0.0;
+	saved_from_account = NULL; saved_to_account = NULL;
 	QGridLayout *filterLayout = new QGridLayout(this);
 	dateFromButton = new QCheckBox(tr("From:"), this);
 	dateFromButton->setChecked(false);
@@ -636,6 +641,47 @@ bool TransactionFilterWidget::filterTransaction(Transactions *transs, bool check
 	}
 	return false;
 }
+void TransactionFilterWidget::saveFilterState() {
+	b_saved_include = includeButton->isChecked();
+	b_saved_exact = exactMatchButton->isChecked();
+	b_saved_exclude_subs = excludeSubsButton && excludeSubsButton->isChecked();
+	b_saved_duplicates = duplicatesButton->isChecked();
+	b_saved_min = minButton->isChecked();
+	b_saved_max = maxButton->isChecked();
+	b_saved_from = dateFromButton->isChecked();
+	saved_min = minEdit->value();
+	saved_max = maxEdit->value();
+	saved_from_date = from_date;
+	saved_to_date = to_date;
+	saved_from_account = fromCombo->currentIndex() > 0 ? fromCombo->currentData().value<void*>() : NULL;
+	saved_to_account = toCombo->currentIndex() > 0 ? toCombo->currentData().value<void*>() : NULL;
+	saved_description = descriptionEdit->text();
+	saved_tag = (tagCombo && tagCombo->currentIndex() > 0) ? tagCombo->currentText() : QString();
+}
+bool TransactionFilterWidget::isRefinedFilter() {
+	//returns true if the current filter can only exclude transactions matching the saved filter
+	if(!b_saved_include || !includeButton->isChecked()) return false;
+	if(b_saved_exact != exactMatchButton->isChecked()) return false;
+	if(b_saved_exclude_subs != (excludeSubsButton && excludeSubsButton->isChecked())) return false;
+	if(b_saved_duplicates && !duplicatesButton->isChecked()) return false;
+	if(b_saved_min && (!minButton->isChecked() || minEdit->value() < saved_min)) return false;
+	if(b_saved_max && (!maxButton->isChecked() || maxEdit->value() > saved_max)) return false;
+	if(b_saved_from && (!dateFromButton->isChecked() || from_date < saved_from_date)) return false;
+	if(to_date > saved_to_date) return false;
+	if(saved_from_account && (fromCombo->currentIndex() <= 0 || fromCombo->currentData().value<void*>() != saved_from_account)) return false;
+	if(saved_to_account && (toCombo->currentIndex() <= 0 || toCombo->currentData().value<void*>() != saved_to_account)) return false;
+	if(!saved_tag.isEmpty() && (tagCombo->currentIndex() <= 0 || tagCombo->currentText() != saved_tag)) return false;
+	if(!saved_description.isEmpty() && descriptionEdit->text().compare(saved_description, Qt::CaseInsensitive) != 0) {
+		//an empty description matches everything, a longer substring only a subset, while tags must match the whole text
+		if(b_saved_exact || !tagCombo || !descriptionEdit->text().contains(saved_description, Qt::CaseInsensitive)) return false;
+	}
+	return true;
+}
+bool TransactionFilterWidget::findTextCandidates(QSet<qlonglong> &ids) {
+	//returns false if the description filter cannot be used to exclude transactions in advance
+	if(!includeButton->isChecked()) return false;
+	return budget->findTextCandidates(descriptionEdit->text(), ids);
+}
 QDate TransactionFilterWidget::startDate() {
 	if(!dateFromButton->isChecked()) return QDate();
 	return from_date;
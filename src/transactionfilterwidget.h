@@ -24,6 +24,7 @@
 #include <QVector>
 #include <QWidget>
 #include <QDateTime>
+#include <QSet>
 
 class QButtonGroup;
 class QCheckBox;
@@ -68,6 +69,10 @@ class TransactionFilterWidget : public QWidget {
 
 		void setFilter(QDate fromdate, QDate todate, double min = -1.0, double max = -1.0, Account *from_account = NULL, Account *to_account = NULL, QString description = QString(), QString payee = QString(), bool exclude = false, bool exact_match = false, bool exclude_subs = false, bool duplicates = false);
 
+		void saveFilterState();
+		bool isRefinedFilter();
+		bool findTextCandidates(QSet<qlonglong> &ids);
+
 	protected:
 
 		QDate firstDate();
@@ -84,6 +89,11 @@ class TransactionFilterWidget : public QWidget {
 		QCheckBox *exactMatchButton, *excludeSubsButton, *duplicatesButton;
 		QPushButton *clearButton;
 		QButtonGroup *group;
+		bool b_saved_include, b_saved_exact, b_saved_exclude_subs, b_saved_duplicates, b_saved_min, b_saved_max, b_saved_from;
+		double saved_min, saved_max;
+		QDate saved_from_date, saved_to_date;
+		void *saved_from_account, *saved_to_account;
+		QString saved_description, saved_tag;
 
 	protected slots:
 
@@ -43,6 +43,9 @@
 #include <QTabWidget>
 #include <QMessageBox>
 #include <QSettings>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QSet>
 
 #include "budget.h"
 #include "editscheduledtransactiondialog.h"
@@ -64,24 +67,31 @@ void setColumnMoneyWidth(QTreeWidget *w, int i, Budget *budget, double v = 99999
 extern void setColumnStrlenWidth(QTreeWidget *w, int i, int l);
 extern void setColumnValueWidth(QTreeWidget *w, int i, double v, int d, Budget *budget);
 
-extern QColor createExpenseColor(QTreeWidgetItem *i, int = 0);
-extern QColor createIncomeColor(QTreeWidgetItem *i, int = 0);
-extern QColor createTransferColor(QTreeWidgetItem *i, int = 0);
+extern QColor createExpenseColor(QWidget *w);
+extern QColor createIncomeColor(QWidget *w);
+extern QColor createTransferColor(QWidget *w);
 
+/*
+The text, colors and icons of the item are created from the transaction when requested by the view (only for visible rows),
+and the items are sorted using the transaction properties.
+*/
 class TransactionListViewItem : public QTreeWidgetItem {
 	protected:
+		TransactionListWidget *w;
 		Transaction *o_trans;
 		ScheduledTransaction *o_strans;
 		MultiAccountTransaction *o_split;
 		QDate d_date;
 	public:
-		TransactionListViewItem(const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split, QString, QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString());
+		TransactionListViewItem(TransactionListWidget *list_widget, const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split);
+		QVariant data(int column, int role) const;
 		bool operator<(const QTreeWidgetItem &i_pre) const;
 		Transaction *transaction() const;
 		ScheduledTransaction *scheduledTransaction() const;
 		MultiAccountTransaction *splitTransaction() const;
 		const QDate &date() const;
 		void setDate(const QDate &newdate);
+		void refresh();
 };
 
 TransactionListWidget::TransactionListWidget(bool extra_parameters, int transaction_type, Budget *budg, Eqonomize *main_win, QWidget *parent) : QWidget(parent), transtype(transaction_type), budget(budg), mainWin(main_win), b_extra(extra_parameters) {
@@ -95,6 +105,11 @@ TransactionListWidget::TransactionListWidget(bool extra_parameters, int transact
 
 	selected_trans = NULL;
 
+	filter_items = NULL;
+
+	b_filter_narrow = false;
+	b_filter_valid = false;
+
 	listPopupMenu = NULL;
 	headerPopupMenu = NULL;
 
@@ -108,6 +123,7 @@ TransactionListWidget::TransactionListWidget(bool extra_parameters, int transact
 	transactionsView->setSortingEnabled(true);
 	transactionsView->sortByColumn(0, Qt::DescendingOrder);
 	transactionsView->setAllColumnsShowFocus(true);
+	transactionsView->setUniformRowHeights(true);
 	QStringList headers;
 	headers << tr("Date");
 	headers << tr("Description", "Transaction description property (transaction title/generic article name)");
@@ -204,7 +220,15 @@ TransactionListWidget::TransactionListWidget(bool extra_parameters, int transact
 	connect(editWidget, SIGNAL(addmodify()), this, SLOT(addModifyTransaction()));
 	connect(removeButton, SIGNAL(clicked()), this, SLOT(removeTransaction()));
 	connect(clearButton, SIGNAL(clicked()), this, SLOT(editClear()));
-	connect(filterWidget, SIGNAL(filter()), this, SLOT(filterTransactions()));
+	//filtering starts when the filter has not been changed for a moment and is run in small steps
+	filterDelayTimer = new QTimer(this);
+	filterDelayTimer->setSingleShot(true);
+	filterDelayTimer->setInterval(250);
+	filterTimer = new QTimer(this);
+	filterTimer->setInterval(0);
+	connect(filterDelayTimer, SIGNAL(timeout()), this, SLOT(updateFilter()));
+	connect(filterTimer, SIGNAL(timeout()), this, SLOT(filterNextTransactions()));
+	connect(filterWidget, SIGNAL(filter()), this, SLOT(onFilterChanged()));
 	connect(filterWidget, SIGNAL(toActivated(Account*)), this, SLOT(filterToActivated(Account*)));
 	connect(filterWidget, SIGNAL(fromActivated(Account*)), this, SLOT(filterFromActivated(Account*)));
 	connect(transactionsView, SIGNAL(itemSelectionChanged()), this, SLOT(transactionSelectionChanged()));
@@ -492,11 +516,14 @@ void TransactionListWidget::rightAlignValues(bool b) {
 extern QString htmlize_string(QString str);
 
 bool TransactionListWidget::isEmpty() {
+	finishFiltering();
 	return transactionsView->topLevelItemCount() == 0;
 }
 
 bool TransactionListWidget::exportList(QTextStream &outf, int fileformat) {
 
+	finishFiltering();
+
 	switch(fileformat) {
 		case 'h': {
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
@@ -646,16 +673,8 @@ void TransactionListWidget::addTransaction() {
 	}
 	if(strans) mainWin->transactionAdded(strans);
 	else mainWin->transactionAdded(trans);
-	QTreeWidgetItemIterator it(transactionsView);
-	TransactionListViewItem *i = (TransactionListViewItem*) *it;
-	while(i) {
-		if(i->transaction() == trans) {
-			transactionsView->scrollToItem(i);
-			break;
-		}
-		++it;
-		i = (TransactionListViewItem*) *it;
-	}
+	QTreeWidgetItem *i = item_index.value(trans, NULL);
+	if(i) transactionsView->scrollToItem(i);
 }
 void TransactionListWidget::editScheduledTransaction() {
 	QList<QTreeWidgetItem*> selection = transactionsView->selectedItems();
@@ -1217,16 +1236,10 @@ void TransactionListWidget::modifyTransaction() {
 			}
 			if(strans) mainWin->transactionAdded(strans);
 			else mainWin->transactionAdded(trans);
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->transaction() == trans) {
-					transactionsView->setCurrentItem(i);
-					i->setSelected(true);
-					break;
-				}
-				++it;
-				i = (TransactionListViewItem*) *it;
+			QTreeWidgetItem *i = item_index.value(trans, NULL);
+			if(i) {
+				transactionsView->setCurrentItem(i);
+				i->setSelected(true);
 			}
 			clearTransaction();
 			return;
@@ -1240,16 +1253,10 @@ void TransactionListWidget::modifyTransaction() {
 			removeTransaction();
 			budget->addTransactions(trans);
 			mainWin->transactionAdded(trans);
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->scheduledTransaction() == trans || i->transaction() == trans) {
-					transactionsView->setCurrentItem(i);
-					i->setSelected(true);
-					break;
-				}
-				++it;
-				i = (TransactionListViewItem*) *it;
+			QTreeWidgetItem *i = item_index.value(trans, NULL);
+			if(i) {
+				transactionsView->setCurrentItem(i);
+				i->setSelected(true);
 			}
 		} else {
 			delete newtrans;
@@ -1634,86 +1641,46 @@ void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool u
 	}
 	QDate date = filterWidget->startDate();
 	QDate enddate = filterWidget->endDate();
+	QVector<QDate> occurrence_dates;
+	int occurrence_index = 0;
 	if(strans) {
 		if(strans->isOneTimeTransaction()) {
 			if(date.isNull()) date = strans->firstOccurrence();
 			else if(date > strans->firstOccurrence()) date = QDate();
 			else date = strans->firstOccurrence();
 		} else {
-			if(date.isNull()) date = strans->recurrence()->firstOccurrence();
-			else date = strans->recurrence()->nextOccurrence(date, true);
+			budget->getScheduleOccurrences(strans, date, enddate, occurrence_dates);
+			if(occurrence_dates.isEmpty()) date = QDate();
+			else date = occurrence_dates.first();
 		}
 		if(date.isNull() || date > enddate) update_total_value = false;
 	} else {
 		date = transs->date();
 	}
-	QSettings settings;
-	right_align_values = settings.value("GeneralOptions/rightAlignValues", true).toBool();
 	while(!strans || (!date.isNull() && date <= enddate)) {
 
-		QTreeWidgetItem *i = new TransactionListViewItem(date, trans, strans, split, QString(), QString(), right_align_values ? transs->valueString() + " " : transs->valueString());
+		QTreeWidgetItem *i = new TransactionListViewItem(this, date, trans, strans, split);
+		//rows of scheduled transactions are found using both the schedule and the transaction
+		if(strans) item_index.insert(strans, i);
+		if(trans) item_index.insert(trans, i);
+		else item_index.insert(split, i);
+		if(filter_items) filter_items->append(i);
+		else transactionsView->insertTopLevelItem(0, i);
 
-		if(strans && strans->recurrence()) i->setText(0, QLocale().toString(date, QLocale::ShortFormat) + "**");
-		else i->setText(0, QLocale().toString(date, QLocale::ShortFormat));
-		transactionsView->insertTopLevelItem(0, i);
-		if(right_align_values) i->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
-
-		if((split && split->cost() > 0.0) || (trans && ((trans->type() == TRANSACTION_TYPE_EXPENSE && trans->value() > 0.0) || (trans->type() == TRANSACTION_TYPE_INCOME && trans->value() < 0.0)))) {
-			if(!expenseColor.isValid()) expenseColor = createExpenseColor(i, 2);
-			i->setForeground(2, expenseColor);
-		} else if((split && split->cost() < 0.0) || (trans && ((trans->type() == TRANSACTION_TYPE_EXPENSE && trans->value() < 0.0) || (trans->type() == TRANSACTION_TYPE_INCOME && trans->value() > 0.0)))) {
-			if(!incomeColor.isValid()) incomeColor = createIncomeColor(i, 2);
-			i->setForeground(2, incomeColor);
-		} else {
-			if(!transferColor.isValid()) transferColor = createTransferColor(i, 2);
-			i->setForeground(2, transferColor);
-		}
-		if(strans) {
-			QFont font = i->font(0);
-			font.setItalic(true);
-			i->setFont(0, font);
-			i->setFont(1, font);
-			i->setFont(2, font);
-			i->setFont(3, font);
-			i->setFont(4, font);
-			i->setFont(5, font);
-			i->setFont(6, font);
-			i->setFont(7, font);
-		}
-		if((trans && trans == selected_trans) || (split && split == selected_trans)) {
+		if(!filter_items && ((trans && trans == selected_trans) || (split && split == selected_trans))) {
 			transactionsView->blockSignals(true);
 			i->setSelected(true);
 			transactionsView->blockSignals(false);
 		}
-		if(trans && trans->parentSplit()) i->setText(1, trans->description() + "*");
-		else i->setText(1, transs->description());
-		if(trans) {
-			i->setText(from_col, trans->fromAccount()->name());
-			i->setText(to_col, trans->toAccount()->name());
-			if(payee_col >= 0) {
-				if(trans->type() == TRANSACTION_TYPE_EXPENSE) i->setText(payee_col, ((Expense*) trans)->payee());
-				else if(trans->type() == TRANSACTION_TYPE_INCOME) i->setText(payee_col, ((Income*) trans)->payer());
-			}
-			if(trans->parentSplit() && trans->comment().isEmpty()) i->setText(comments_col, trans->parentSplit()->comment());
-			else i->setText(comments_col, trans->comment());
-			if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(trans->quantity()));
-			if(tags_col >= 0) i->setText(tags_col, trans->tagsText(true));
-			if(!trans->associatedFile().isEmpty() || (trans->parentSplit() && !trans->parentSplit()->associatedFile().isEmpty())) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
-			if(trans->linksCount(true) > 0) i->setIcon(comments_col, LOAD_ICON_STATUS("go-jump"));
-		} else if(split) {
-			i->setText(3, split->category()->name());
-			i->setText(4, split->accountsString());
-			if(payee_col >= 0) i->setText(payee_col, split->payeeText());
-			if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(split->quantity()));
-			i->setText(comments_col, transs->comment());
-			if(tags_col >= 0) i->setText(tags_col, transs->tagsText());
-			if(!split->associatedFile().isEmpty()) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
-			if(split->linksCount() > 0) i->setIcon(comments_col, LOAD_ICON_STATUS("go-jump"));
-		}
 		current_value += transs->value(true);
 		current_quantity += transs->quantity();
-		if(strans && !strans->isOneTimeTransaction()) date = strans->recurrence()->nextOccurrence(date);
-		else break;
+		if(strans && !strans->isOneTimeTransaction()) {
+			occurrence_index++;
+			if(occurrence_index < occurrence_dates.count()) date = occurrence_dates.at(occurrence_index);
+			else date = QDate();
+		} else {
+			break;
+		}
 	}
 	if(update_total_value) {
 		updateStatistics();
@@ -1721,7 +1688,15 @@ void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool u
 	}
 }
 
+void TransactionListWidget::removeItem(QTreeWidgetItem *i_pre) {
+	TransactionListViewItem *i = (TransactionListViewItem*) i_pre;
+	if(i->scheduledTransaction()) item_index.remove(i->scheduledTransaction(), i);
+	if(i->transaction()) item_index.remove(i->transaction(), i);
+	else item_index.remove(i->splitTransaction(), i);
+	delete i;
+}
 void TransactionListWidget::onTransactionSplitUp(SplitTransaction *split) {
+	finishFiltering();
 	if(split->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) {
 		for(int i = 0; i < split->count(); i++) {
 			split->at(i)->setParentSplit(NULL);
@@ -1731,21 +1706,15 @@ void TransactionListWidget::onTransactionSplitUp(SplitTransaction *split) {
 			transactionsView->setSortingEnabled(true);
 		}
 	} else {
-		QTreeWidgetItemIterator it(transactionsView);
-		TransactionListViewItem *i = (TransactionListViewItem*) *it;
-		while(i) {
-			if(i->transaction() && i->transaction()->parentSplit() == split) {
-				i->setText(1, i->transaction()->description());
-				if(!split->associatedFile().isEmpty() && i->transaction()->associatedFile().isEmpty()) i->setIcon(2, QIcon());
-				if(split->linksCount() > 0 && i->transaction()->linksCount(true) == 0) i->setIcon(comments_col, QIcon());
-			}
-			++it;
-			i = (TransactionListViewItem*) *it;
+		for(int index = 0; index < split->count(); index++) {
+			QList<QTreeWidgetItem*> items = item_index.values(split->at(index));
+			for(int index2 = 0; index2 < items.count(); index2++) ((TransactionListViewItem*) items.at(index2))->refresh();
 		}
 		transactionSelectionChanged();
 	}
 }
 void TransactionListWidget::onTransactionAdded(Transactions *trans) {
+	finishFiltering();
 	appendFilterTransaction(trans, true);
 	switch(trans->generaltype()) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
@@ -1774,48 +1743,26 @@ void TransactionListWidget::onTransactionAdded(Transactions *trans) {
 	}
 }
 void TransactionListWidget::onTransactionModified(Transactions *transs, Transactions *oldtranss) {
+	finishFiltering();
 	switch(transs->generaltype()) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
 			Transaction *trans = (Transaction*) transs;
 			Transaction *oldtrans = (Transaction*) oldtranss;
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->transaction() == trans) {
-					current_value -= oldtrans->value(true);
-					current_quantity -= oldtrans->quantity();
-					break;
-				}
-				++it;
-				i = (TransactionListViewItem*) *it;
+			TransactionListViewItem *i = (TransactionListViewItem*) item_index.value(trans, NULL);
+			if(i) {
+				current_value -= oldtrans->value(true);
+				current_quantity -= oldtrans->quantity();
 			}
 			if(!i) {
 				appendFilterTransaction(trans, true);
 			} else {
 				if(filterWidget->filterTransaction(trans)) {
-					delete i;
+					removeItem(i);
 				} else {
 					current_value += trans->value(true);
 					current_quantity += trans->quantity();
 					i->setDate(trans->date());
-					i->setText(0, QLocale().toString(trans->date(), QLocale::ShortFormat));
-					if(trans->parentSplit()) i->setText(1, trans->description() + "*");
-					else i->setText(1, trans->description());
-					i->setText(2, right_align_values ? trans->valueString() + " " : transs->valueString());
-					i->setText(from_col, trans->fromAccount()->name());
-					i->setText(to_col, trans->toAccount()->name());
-					if(payee_col >= 0) {
-						if(trans->type() == TRANSACTION_TYPE_EXPENSE) i->setText(payee_col, ((Expense*) trans)->payee());
-						else if(trans->type() == TRANSACTION_TYPE_INCOME) i->setText(payee_col, ((Income*) trans)->payer());
-					}
-					if(trans->parentSplit() && trans->comment().isEmpty()) i->setText(comments_col, trans->parentSplit()->comment());
-					else i->setText(comments_col, trans->comment());
-					if(tags_col >= 0) i->setText(tags_col, transs->tagsText(true));
-					if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(transs->quantity()));
-					if(!trans->associatedFile().isEmpty() || (trans->parentSplit() && !trans->parentSplit()->associatedFile().isEmpty())) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
-					else i->setIcon(2, QIcon());
-					if(trans->linksCount(true) > 0) i->setIcon(comments_col, LOAD_ICON_STATUS("go-jump"));
-					else i->setIcon(comments_col, QIcon());
+					i->refresh();
 				}
 				updateStatistics();
 			}
@@ -1826,20 +1773,11 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
 			ScheduledTransaction *strans = (ScheduledTransaction*) transs;
 			ScheduledTransaction *oldstrans = (ScheduledTransaction*) oldtranss;
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->scheduledTransaction() == strans) {
-					current_value -= oldstrans->transaction()->value(true);
-					current_quantity -= oldstrans->transaction()->quantity();
-					QTreeWidgetItem *i_del = i;
-					++it;
-					i = (TransactionListViewItem*) *it;
-					delete i_del;
-				} else {
-					++it;
-					i = (TransactionListViewItem*) *it;
-				}
+			QList<QTreeWidgetItem*> items = item_index.values(strans);
+			for(int index = 0; index < items.count(); index++) {
+				current_value -= oldstrans->transaction()->value(true);
+				current_quantity -= oldstrans->transaction()->quantity();
+				removeItem(items.at(index));
 			}
 			appendFilterTransaction(strans, true);
 			updateStatistics();
@@ -1873,39 +1811,21 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 			}
 			MultiAccountTransaction *split = (MultiAccountTransaction*) transs;
 			MultiAccountTransaction *oldsplit = (MultiAccountTransaction*) oldtranss;
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->splitTransaction() == split) {
-					current_value -= oldsplit->value(true);
-					current_quantity -= oldsplit->quantity();
-					break;
-				}
-				++it;
-				i = (TransactionListViewItem*) *it;
+			TransactionListViewItem *i = (TransactionListViewItem*) item_index.value(split, NULL);
+			if(i) {
+				current_value -= oldsplit->value(true);
+				current_quantity -= oldsplit->quantity();
 			}
 			if(!i) {
 				appendFilterTransaction(split, true);
 			} else {
 				if(filterWidget->filterTransaction(split)) {
-					delete i;
+					removeItem(i);
 				} else {
 					current_value += split->value(true);
 					current_quantity += split->quantity();
 					i->setDate(split->date());
-					i->setText(0, QLocale().toString(split->date(), QLocale::ShortFormat));
-					i->setText(1, split->description() + "*");
-					i->setText(2, right_align_values ? split->valueString() + " " : split->valueString());
-					i->setText(3, split->category()->name());
-					i->setText(4, split->accountsString());
-					if(payee_col >= 0) i->setText(payee_col, split->payeeText());
-					i->setText(comments_col, split->comment());
-					if(tags_col >= 0) i->setText(tags_col, split->tagsText());
-					if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(split->quantity()));
-					if(!split->associatedFile().isEmpty()) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
-					else i->setIcon(2, QIcon());
-					if(split->linksCount() > 0) i->setIcon(comments_col, LOAD_ICON_STATUS("go-jump"));
-					else i->setIcon(comments_col, QIcon());
+					i->refresh();
 				}
 				updateStatistics();
 			}
@@ -1914,41 +1834,27 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 	}
 }
 void TransactionListWidget::onTransactionRemoved(Transactions *transs) {
+	finishFiltering();
 	switch(transs->generaltype()) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
 			Transaction *trans = (Transaction*) transs;
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->transaction() == trans) {
-					delete i;
-					current_value -= trans->value(true);
-					current_quantity -= trans->quantity();
-					updateStatistics();
-					break;
-				}
-				++it;
-				i = (TransactionListViewItem*) *it;
+			QTreeWidgetItem *i = item_index.value(trans, NULL);
+			if(i) {
+				removeItem(i);
+				current_value -= trans->value(true);
+				current_quantity -= trans->quantity();
+				updateStatistics();
 			}
 			editWidget->transactionRemoved(trans);
 			break;
 		}
 		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
 			ScheduledTransaction *strans = (ScheduledTransaction*) transs;
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->scheduledTransaction() == strans) {
-					current_value -= strans->transaction()->value(true);
-					current_quantity -= strans->transaction()->quantity();
-					QTreeWidgetItem *i_del = i;
-					++it;
-					i = (TransactionListViewItem*) *it;
-					delete i_del;
-				} else {
-					++it;
-					i = (TransactionListViewItem*) *it;
-				}
+			QList<QTreeWidgetItem*> items = item_index.values(strans);
+			for(int index = 0; index < items.count(); index++) {
+				current_value -= strans->transaction()->value(true);
+				current_quantity -= strans->transaction()->quantity();
+				removeItem(items.at(index));
 			}
 			updateStatistics();
 			if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
@@ -1965,18 +1871,12 @@ void TransactionListWidget::onTransactionRemoved(Transactions *transs) {
 		case GENERAL_TRANSACTION_TYPE_SPLIT: {
 			if(((SplitTransaction*) transs)->type() != SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) break;
 			MultiAccountTransaction *split = (MultiAccountTransaction*) transs;
-			QTreeWidgetItemIterator it(transactionsView);
-			TransactionListViewItem *i = (TransactionListViewItem*) *it;
-			while(i) {
-				if(i->splitTransaction() == split) {
-					delete i;
-					current_value -= split->value(true);
-					current_quantity -= split->quantity();
-					updateStatistics();
-					break;
-				}
-				++it;
-				i = (TransactionListViewItem*) *it;
+			QTreeWidgetItem *i = item_index.value(split, NULL);
+			if(i) {
+				removeItem(i);
+				current_value -= split->value(true);
+				current_quantity -= split->quantity();
+				updateStatistics();
 			}
 			break;
 		}
@@ -1988,77 +1888,162 @@ void TransactionListWidget::clearTransaction() {
 	editWidget->setTransaction(NULL);
 }
 void TransactionListWidget::filterTransactions() {
-	expenseColor = QColor();
-	incomeColor = QColor();
-	transferColor = QColor();
-	//QList<QTreeWidgetItem*> selection = transactionsView->selectedItems();
-	selected_trans = NULL;
-	/*if(selection.count() == 1) {
-		TransactionListViewItem *i = (TransactionListViewItem*) selection.first();
-		if(!i->scheduledTransaction()) {
-			if(i->splitTransaction()) selected_trans = i->splitTransaction();
-			else selected_trans = i->transaction();
-		}
-	}*/
-	transactionsView->clear();
-	current_value = 0.0;
-	current_quantity = 0.0;
-	switch(transtype) {
-		case TRANSACTION_TYPE_EXPENSE: {
-			for(TransactionList<Expense*>::const_iterator it = budget->expenses.constBegin(); it != budget->expenses.constEnd(); ++it) {
-				Expense *expense = *it;
-				appendFilterTransaction(expense, false);
-			}
-			for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
-				SecurityTransaction *sectrans = *it;
-				if(sectrans->account()->type() == ACCOUNT_TYPE_EXPENSES) {
-					appendFilterTransaction(sectrans, false);
+	filterDelayTimer->stop();
+	startFiltering(false);
+	finishFiltering();
+}
+void TransactionListWidget::onFilterChanged() {
+	cancelFiltering();
+	filterDelayTimer->start();
+}
+void TransactionListWidget::updateFilter() {
+	//if the new filter is narrower than the previous, only the listed transactions need to be tested
+	startFiltering(b_filter_valid && filterWidget->isRefinedFilter());
+}
+void TransactionListWidget::startFiltering(bool narrow) {
+	cancelFiltering();
+	filterWidget->saveFilterState();
+	b_filter_narrow = narrow;
+	if(narrow) {
+		QSet<Transactions*> schedules;
+		QTreeWidgetItemIterator it(transactionsView);
+		TransactionListViewItem *i = (TransactionListViewItem*) *it;
+		while(i) {
+			if(i->scheduledTransaction()) {
+				if(!schedules.contains(i->scheduledTransaction())) {
+					schedules.insert(i->scheduledTransaction());
+					filter_queue << i->scheduledTransaction();
 				}
+			} else if(i->splitTransaction()) {
+				filter_queue << i->splitTransaction();
+			} else {
+				filter_queue << i->transaction();
 			}
-			break;
+			++it;
+			i = (TransactionListViewItem*) *it;
 		}
-		case TRANSACTION_TYPE_INCOME: {
-			for(TransactionList<Income*>::const_iterator it = budget->incomes.constBegin(); it != budget->incomes.constEnd(); ++it) {
-				Income *income = *it;
-				appendFilterTransaction(income, false);
-			}
-			for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
-				SecurityTransaction *sectrans = *it;
-				if(sectrans->account()->type() == ACCOUNT_TYPE_INCOMES) {
-					appendFilterTransaction(sectrans, false);
+	} else {
+		b_filter_valid = false;
+		expenseColor = QColor();
+		incomeColor = QColor();
+		transferColor = QColor();
+		selected_trans = NULL;
+		item_index.clear();
+		transactionsView->clear();
+		current_value = 0.0;
+		current_quantity = 0.0;
+		QSettings settings;
+		right_align_values = settings.value("GeneralOptions/rightAlignValues", true).toBool();
+		editInfoLabel->setText("");
+		switch(transtype) {
+			case TRANSACTION_TYPE_EXPENSE: {
+				for(TransactionList<Expense*>::const_iterator it = budget->expenses.constBegin(); it != budget->expenses.constEnd(); ++it) {
+					filter_queue << *it;
 				}
+				for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
+					SecurityTransaction *sectrans = *it;
+					if(sectrans->account()->type() == ACCOUNT_TYPE_EXPENSES) filter_queue << sectrans;
+				}
+				break;
 			}
-			break;
-		}
-		default: {
-			for(TransactionList<Transfer*>::const_iterator it = budget->transfers.constBegin(); it != budget->transfers.constEnd(); ++it) {
-				Transfer *transfer = *it;
-				appendFilterTransaction(transfer, false);
+			case TRANSACTION_TYPE_INCOME: {
+				for(TransactionList<Income*>::const_iterator it = budget->incomes.constBegin(); it != budget->incomes.constEnd(); ++it) {
+					filter_queue << *it;
+				}
+				for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
+					SecurityTransaction *sectrans = *it;
+					if(sectrans->account()->type() == ACCOUNT_TYPE_INCOMES) filter_queue << sectrans;
+				}
+				break;
 			}
-			for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
-				SecurityTransaction *sectrans = *it;
-				if(sectrans->account()->type() == ACCOUNT_TYPE_ASSETS) {
-					appendFilterTransaction(sectrans, false);
+			default: {
+				for(TransactionList<Transfer*>::const_iterator it = budget->transfers.constBegin(); it != budget->transfers.constEnd(); ++it) {
+					filter_queue << *it;
+				}
+				for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
+					SecurityTransaction *sectrans = *it;
+					if(sectrans->account()->type() == ACCOUNT_TYPE_ASSETS) filter_queue << sectrans;
 				}
+				break;
 			}
-			break;
+		}
+		for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
+			filter_queue << *it;
+		}
+		for(SplitTransactionList<SplitTransaction*>::const_iterator it = budget->splitTransactions.constBegin(); it != budget->splitTransactions.constEnd(); ++it) {
+			filter_queue << *it;
+		}
+		//transactions that do not contain the description filter text are not tested
+		QSet<qlonglong> candidates;
+		if(filterWidget->findTextCandidates(candidates)) {
+			QList<Transactions*> queue;
+			for(QList<Transactions*>::const_iterator it = filter_queue.constBegin(); it != filter_queue.constEnd(); ++it) {
+				if(candidates.contains((*it)->id())) queue << *it;
+			}
+			filter_queue = queue;
 		}
 	}
-	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
-		ScheduledTransaction *strans = *it;
-		appendFilterTransaction(strans, false);
+	if(filter_queue.isEmpty()) {
+		b_filter_valid = true;
+		updateStatistics();
+	} else {
+		transactionsView->setSortingEnabled(false);
+		filterTimer->start();
 	}
-	for(SplitTransactionList<SplitTransaction*>::const_iterator it = budget->splitTransactions.constBegin(); it != budget->splitTransactions.constEnd(); ++it) {
-		SplitTransaction *split = *it;
-		appendFilterTransaction(split, false);
+}
+void TransactionListWidget::cancelFiltering() {
+	if(!filterTimer->isActive()) return;
+	filterTimer->stop();
+	filter_queue.clear();
+	transactionsView->setSortingEnabled(true);
+	//after an interrupted narrowing the list still includes all transactions matching the new filter
+	if(!b_filter_narrow) b_filter_valid = false;
+}
+void TransactionListWidget::finishFiltering() {
+	if(filterDelayTimer->isActive()) {
+		filterDelayTimer->stop();
+		updateFilter();
+	}
+	if(filterTimer->isActive()) filterNextTransactions(-1);
+}
+void TransactionListWidget::filterNextTransactions(int max_time) {
+	QElapsedTimer timer;
+	timer.start();
+	QList<QTreeWidgetItem*> items;
+	filter_items = &items;
+	//the last transactions in the lists are the most recent, and are shown first
+	while(!filter_queue.isEmpty() && (max_time < 0 || !timer.hasExpired(max_time))) {
+		Transactions *transs = filter_queue.takeLast();
+		if(b_filter_narrow) refilterTransaction(transs);
+		else appendFilterTransaction(transs, false);
+	}
+	filter_items = NULL;
+	if(!items.isEmpty()) transactionsView->addTopLevelItems(items);
+	if(filter_queue.isEmpty()) {
+		filterTimer->stop();
+		//the list is sorted once, when all items have been added
+		transactionsView->setSortingEnabled(true);
+		b_filter_valid = true;
 	}
-	/*selected_trans = NULL;
-	selection = transactionsView->selectedItems();
-	if(selection.count() == 0) {*/
-		editInfoLabel->setText("");
-	//}
 	updateStatistics();
-	transactionsView->setSortingEnabled(true);
+}
+void TransactionListWidget::refilterTransaction(Transactions *transs) {
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE) {
+		QList<QTreeWidgetItem*> items = item_index.values(transs);
+		for(int index = 0; index < items.count(); index++) removeFilterItem(items.at(index));
+		appendFilterTransaction(transs, false);
+	} else if(filterWidget->filterTransaction(transs)) {
+		QTreeWidgetItem *i = item_index.value(transs, NULL);
+		if(i) removeFilterItem(i);
+	}
+}
+void TransactionListWidget::removeFilterItem(QTreeWidgetItem *i_pre) {
+	TransactionListViewItem *i = (TransactionListViewItem*) i_pre;
+	Transactions *transs = i->splitTransaction();
+	if(!transs) transs = i->transaction();
+	current_value -= transs->value(true);
+	current_quantity -= transs->quantity();
+	removeItem(i);
 }
 
 void TransactionListWidget::currentTransactionChanged(QTreeWidgetItem *i) {
@@ -2336,21 +2321,83 @@ void TransactionListWidget::showFilter(bool focus_description) {
 void TransactionListWidget::showEdit() {tabs->setCurrentWidget(editWidget);}
 void TransactionListWidget::setFilter(QDate fromdate, QDate todate, double min, double max, Account *from_account, Account *to_account, QString description, QString tag, bool exclude, bool exact_match) {
 	filterWidget->setFilter(fromdate, todate, min, max, from_account, to_account, description, tag, exclude, exact_match);
+	finishFiltering();
 }
 void TransactionListWidget::currentTabChanged(int index) {
 	if(index == 0) editWidget->focusFirst();
 	else if(index == 1) filterWidget->focusFirst();
 }
 
-TransactionListViewItem::TransactionListViewItem(const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split, QString s1, QString s2, QString s3, QString s4, QString s5, QString s6, QString s7, QString s8) : QTreeWidgetItem(), o_trans(trans), o_strans(strans), o_split(split), d_date(trans_date) {
-	setText(0, s1);
-	setText(1, s2);
-	setText(2, s3);
-	setText(3, s4);
-	setText(4, s5);
-	setText(5, s6);
-	setText(6, s7);
-	setText(7, s8);
+TransactionListViewItem::TransactionListViewItem(TransactionListWidget *list_widget, const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split) : QTreeWidgetItem(), w(list_widget), o_trans(trans), o_strans(strans), o_split(split), d_date(trans_date) {}
+QVariant TransactionListViewItem::data(int column, int role) const {
+	Transactions *transs = o_split;
+	if(!transs) transs = o_trans;
+	switch(role) {
+		case Qt::DisplayRole: {
+			if(column == 0) {
+				if(o_strans && o_strans->recurrence()) return QLocale().toString(d_date, QLocale::ShortFormat) + "**";
+				return QLocale().toString(d_date, QLocale::ShortFormat);
+			} else if(column == 1) {
+				if(o_trans && o_trans->parentSplit()) return o_trans->description() + "*";
+				return transs->description();
+			} else if(column == 2) {
+				if(w->right_align_values) return transs->valueString() + " ";
+				return transs->valueString();
+			} else if(column == w->comments_col) {
+				if(o_trans && o_trans->parentSplit() && o_trans->comment().isEmpty()) return o_trans->parentSplit()->comment();
+				return transs->comment();
+			} else if(column == w->quantity_col) {
+				return w->budget->formatValue(transs->quantity());
+			} else if(column == w->tags_col) {
+				if(o_trans) return o_trans->tagsText(true);
+				return transs->tagsText();
+			} else if(o_trans) {
+				if(column == w->from_col) return o_trans->fromAccount()->name();
+				if(column == w->to_col) return o_trans->toAccount()->name();
+				if(column == w->payee_col) {
+					if(o_trans->type() == TRANSACTION_TYPE_EXPENSE) return ((Expense*) o_trans)->payee();
+					if(o_trans->type() == TRANSACTION_TYPE_INCOME) return ((Income*) o_trans)->payer();
+				}
+			} else if(o_split) {
+				if(column == 3) return o_split->category()->name();
+				if(column == 4) return o_split->accountsString();
+				if(column == w->payee_col) return o_split->payeeText();
+			}
+			return QVariant();
+		}
+		case Qt::DecorationRole: {
+			if(column == 2) {
+				if(o_trans && (!o_trans->associatedFile().isEmpty() || (o_trans->parentSplit() && !o_trans->parentSplit()->associatedFile().isEmpty()))) return LOAD_ICON_STATUS("mail-attachment");
+				if(o_split && !o_split->associatedFile().isEmpty()) return LOAD_ICON_STATUS("mail-attachment");
+			} else if(column == w->comments_col) {
+				if((o_trans && o_trans->linksCount(true) > 0) || (o_split && o_split->linksCount() > 0)) return LOAD_ICON_STATUS("go-jump");
+			}
+			return QVariant();
+		}
+		case Qt::ForegroundRole: {
+			if(column != 2) break;
+			if((o_split && o_split->cost() > 0.0) || (o_trans && ((o_trans->type() == TRANSACTION_TYPE_EXPENSE && o_trans->value() > 0.0) || (o_trans->type() == TRANSACTION_TYPE_INCOME && o_trans->value() < 0.0)))) {
+				if(!w->expenseColor.isValid()) w->expenseColor = createExpenseColor(w->transactionsView->viewport());
+				return QBrush(w->expenseColor);
+			} else if((o_split && o_split->cost() < 0.0) || (o_trans && ((o_trans->type() == TRANSACTION_TYPE_EXPENSE && o_trans->value() < 0.0) || (o_trans->type() == TRANSACTION_TYPE_INCOME && o_trans->value() > 0.0)))) {
+				if(!w->incomeColor.isValid()) w->incomeColor = createIncomeColor(w->transactionsView->viewport());
+				return QBrush(w->incomeColor);
+			}
+			if(!w->transferColor.isValid()) w->transferColor = createTransferColor(w->transactionsView->viewport());
+			return QBrush(w->transferColor);
+		}
+		case Qt::TextAlignmentRole: {
+			if(column == 2 && w->right_align_values) return (int) (Qt::AlignRight | Qt::AlignVCenter);
+			break;
+		}
+		case Qt::FontRole: {
+			if(!o_strans) break;
+			QFont font;
+			font.setItalic(true);
+			return font;
+		}
+	}
+	return QTreeWidgetItem::data(column, role);
 }
 bool TransactionListViewItem::operator<(const QTreeWidgetItem &i_pre) const {
 	int col = 0;
@@ -2375,6 +2422,10 @@ bool TransactionListViewItem::operator<(const QTreeWidgetItem &i_pre) const {
 		double d1 = t1->value(true), d2 = t2->value(true);
 		if(d1 < d2) return true;
 		if(d1 > d2) return false;
+	} else if(col == w->quantity_col) {
+		double d1 = t1->quantity(), d2 = t2->quantity();
+		if(d1 < d2) return true;
+		if(d1 > d2) return false;
 	}
 	return QTreeWidgetItem::operator<(i_pre);
 }
@@ -2393,4 +2444,8 @@ const QDate &TransactionListViewItem::date() const {
 void TransactionListViewItem::setDate(const QDate &newdate) {
 	d_date = newdate;
 }
+void TransactionListViewItem::refresh() {
+	//the view requests the modified data, and the item is moved if the sort order has changed
+	emitDataChanged();
+}
 
@@ -26,11 +26,13 @@
 #include <QTextStream>
 #include <QWidget>
 #include <QColor>
+#include <QHash>
 
 class QLabel;
 class QMenu;
 class QPushButton;
 class QTabWidget;
+class QTimer;
 class QTreeWidget;
 class QTreeWidgetItem;
 
@@ -48,6 +50,8 @@ class TransactionListWidget : public QWidget {
 
 	Q_OBJECT
 
+	friend class TransactionListViewItem;
+
 	public:
 
 		TransactionListWidget(bool extra_parameters, int transaction_type, Budget *budg, Eqonomize *main_win, QWidget *parent = 0);
@@ -80,6 +84,11 @@ class TransactionListWidget : public QWidget {
 		bool b_extra;
 		QTabWidget *tabs;
 		QTreeWidget *transactionsView;
+		QList<QTreeWidgetItem*> *filter_items;
+		QMultiHash<Transactions*, QTreeWidgetItem*> item_index;
+		QList<Transactions*> filter_queue;
+		QTimer *filterTimer, *filterDelayTimer;
+		bool b_filter_narrow, b_filter_valid;
 		QLabel *statLabel;
 		QPushButton *addButton, *modifyButton, *removeButton, *clearButton;
 		QMenu *listPopupMenu, *headerPopupMenu;
@@ -93,6 +102,12 @@ class TransactionListWidget : public QWidget {
 		QKeyEvent *key_event;
 
 		void keyPressEvent(QKeyEvent*);
+		void removeItem(QTreeWidgetItem*);
+		void removeFilterItem(QTreeWidgetItem*);
+		void refilterTransaction(Transactions*);
+		void startFiltering(bool narrow);
+		void cancelFiltering();
+		void finishFiltering();
 
 	signals:
 
@@ -124,6 +139,9 @@ class TransactionListWidget : public QWidget {
 		void onTransactionModified(Transactions*, Transactions*);
 		void onTransactionRemoved(Transactions*);
 		void filterTransactions();
+		void onFilterChanged();
+		void updateFilter();
+		void filterNextTransactions(int max_time = 20);
 		void currentTransactionChanged(QTreeWidgetItem*);
 		void transactionSelectionChanged();
 		void filterToActivated(Account*);
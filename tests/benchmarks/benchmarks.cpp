@@ -0,0 +1,347 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTranslator>
+#include <QTreeWidget>
+
+#include "account.h"
+#include "budget.h"
+#include "recurrence.h"
+#include "transaction.h"
+#include "transactionlistwidget.h"
+
+QTranslator translator_qt, translator_qtbase;
+
+class BenchmarkListWidget : public TransactionListWidget {
+
+	public:
+
+		BenchmarkListWidget(Budget *budg) : TransactionListWidget(false, TRANSACTION_TYPE_EXPENSE, budg, NULL) {}
+
+		void filterFirstSlice() {
+			startFiltering(false);
+			filterNextTransactions();
+			transactionsView->viewport()->repaint();
+		}
+		void filterRemaining() {
+			finishFiltering();
+		}
+		int rowCount() {
+			return transactionsView->topLevelItemCount();
+		}
+
+};
+
+class Benchmarks : public QObject {
+
+	Q_OBJECT
+
+	protected:
+
+		QTemporaryDir dir;
+
+		Budget *createBudget(int count, bool links = false);
+		QList<Transactions*> createTransactions(Budget *budget, int count, bool links = false);
+		QString createFile(int count, bool links = false);
+		Recurrence *createRecurrence(Budget *budget, int type);
+
+	private slots:
+
+		void getTransaction_data();
+		void getTransaction();
+		void loadLinkedFile_data();
+		void loadLinkedFile();
+		void loadThreads_data();
+		void loadThreads();
+		void importTransactions_data();
+		void importTransactions();
+		void countOccurrences_data();
+		void countOccurrences();
+		void expandOccurrences_data();
+		void expandOccurrences();
+		void filterFirstPaint_data();
+		void filterFirstPaint();
+
+};
+
+Budget *Benchmarks::createBudget(int count, bool links) {
+	Budget *budget = new Budget();
+	budget->addTransactions(createTransactions(budget, count, links));
+	return budget;
+}
+QList<Transactions*> Benchmarks::createTransactions(Budget *budget, int count, bool links) {
+	//count expenses, incomes and transfers spread over 25 years, with links between consecutive transactions
+	AssetsAccount *account = budget->findAssetsAccount("Account");
+	if(!account) {
+		account = new AssetsAccount(budget, ASSETS_TYPE_CURRENT, "Account");
+		budget->addAccount(account);
+	}
+	AssetsAccount *savings = budget->findAssetsAccount("Savings");
+	if(!savings) {
+		savings = new AssetsAccount(budget, ASSETS_TYPE_SAVINGS, "Savings");
+		budget->addAccount(savings);
+	}
+	QVector<ExpensesAccount*> categories;
+	for(int i = 0; i < 20; i++) {
+		ExpensesAccount *category = budget->findExpensesAccount(QString("Category %1").arg(i));
+		if(!category) {
+			category = new ExpensesAccount(budget, QString("Category %1").arg(i));
+			budget->addAccount(category);
+		}
+		categories << category;
+	}
+	IncomesAccount *salary = budget->findIncomesAccount("Salary");
+	if(!salary) {
+		salary = new IncomesAccount(budget, "Salary");
+		budget->addAccount(salary);
+	}
+	QDate first_date(2000, 1, 1);
+	QList<Transactions*> list;
+	list.reserve(count);
+	for(int i = 0; i < count; i++) {
+		QDate date = first_date.addDays((i * 7919) % 9125);
+		Transaction *trans;
+		if(i % 10 == 0) trans = new Income(budget, 1000.0 + i % 100, date, salary, account, QString("Salary %1").arg(i % 12));
+		else if(i % 10 == 1) trans = new Transfer(budget, 100.0 + i % 50, date, account, savings, QString("Savings %1").arg(i % 7));
+		else trans = new Expense(budget, 1.0 + (i % 997) / 10.0, date, categories.at(i % categories.count()), account, QString("Item %1").arg(i % 1000));
+		if(links && !list.isEmpty()) {
+			trans->addLinkId(list.last()->id());
+			list.last()->addLinkId(trans->id());
+		}
+		list << trans;
+	}
+	return list;
+}
+QString Benchmarks::createFile(int count, bool links) {
+	QString filename = dir.filePath(QString("budget_%1%2.eqz").arg(count).arg(links ? "_links" : ""));
+	if(QFile::exists(filename)) return filename;
+	Budget *budget = createBudget(count, links);
+	QString error = budget->saveFile(filename);
+	delete budget;
+	if(!error.isNull()) return QString();
+	return filename;
+}
+
+void Benchmarks::getTransaction_data() {
+	QTest::addColumn<int>("count");
+	QTest::newRow("25000") << 25000;
+	QTest::newRow("50000") << 50000;
+	QTest::newRow("100000") << 100000;
+	QTest::newRow("200000") << 200000;
+}
+void Benchmarks::getTransaction() {
+	QFETCH(int, count);
+	Budget *budget = createBudget(count);
+	QVector<qlonglong> ids;
+	ids.reserve(count);
+	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) ids << (*it)->id();
+	QBENCHMARK {
+		for(QVector<qlonglong>::const_iterator it = ids.constBegin(); it != ids.constEnd(); ++it) {
+			if(!budget->getTransaction(*it)) QFAIL("transaction not found");
+		}
+	}
+	delete budget;
+}
+void Benchmarks::loadLinkedFile_data() {
+	getTransaction_data();
+}
+void Benchmarks::loadLinkedFile() {
+	QFETCH(int, count);
+	QString filename = createFile(count, true);
+	QVERIFY(!filename.isEmpty());
+	QBENCHMARK {
+		Budget *budget = new Budget();
+		QString errors;
+		QString error = budget->loadFile(filename, errors);
+		QVERIFY2(error.isNull(), qPrintable(error));
+		QCOMPARE(budget->transactions.count(), count);
+		delete budget;
+	}
+}
+
+void Benchmarks::loadThreads_data() {
+	QTest::addColumn<int>("threads");
+	QTest::newRow("1 thread") << 1;
+	QTest::newRow("2 threads") << 2;
+	QTest::newRow("4 threads") << 4;
+	QTest::newRow("8 threads") << 8;
+}
+void Benchmarks::loadThreads() {
+	//the loaded budget must be saved identically to a budget loaded by a single thread (as backups, which do not have a random save id)
+	QFETCH(int, threads);
+	QString filename = createFile(100000);
+	QVERIFY(!filename.isEmpty());
+	QString reference = dir.filePath("reference.eqz");
+	if(!QFile::exists(reference)) {
+		Budget budget;
+		budget.setLoadThreadCount(1);
+		QString errors;
+		QVERIFY(budget.loadFile(filename, errors).isNull());
+		QVERIFY(budget.saveFile(reference, QFile::ReadUser | QFile::WriteUser, true).isNull());
+	}
+	Budget *budget = NULL;
+	QBENCHMARK {
+		delete budget;
+		budget = new Budget();
+		budget->setLoadThreadCount(threads);
+		QString errors;
+		QString error = budget->loadFile(filename, errors);
+		QVERIFY2(error.isNull(), qPrintable(error));
+	}
+	QString saved = dir.filePath(QString("threads_%1.eqz").arg(threads));
+	bool b_saved = budget->saveFile(saved, QFile::ReadUser | QFile::WriteUser, true).isNull();
+	delete budget;
+	QVERIFY(b_saved);
+	QFile file1(reference), file2(saved);
+	QVERIFY(file1.open(QIODevice::ReadOnly) && file2.open(QIODevice::ReadOnly));
+	QVERIFY(file1.readAll() == file2.readAll());
+}
+
+void Benchmarks::importTransactions_data() {
+	QTest::addColumn<int>("count");
+	QTest::addColumn<bool>("batch");
+	QTest::newRow("100000, one at a time") << 100000 << false;
+	QTest::newRow("100000, batch") << 100000 << true;
+}
+void Benchmarks::importTransactions() {
+	//transactions imported into a budget with existing transactions, in random date order as from a CSV or QIF file
+	QFETCH(int, count);
+	QFETCH(bool, batch);
+	Budget *budget = createBudget(50000);
+	QList<Transactions*> list = createTransactions(budget, count);
+	QElapsedTimer timer;
+	timer.start();
+	if(batch) {
+		budget->addTransactions(list);
+	} else {
+		for(QList<Transactions*>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) budget->addTransactions(*it);
+	}
+	QTest::setBenchmarkResult(timer.elapsed(), QTest::WalltimeMilliseconds);
+	QCOMPARE(budget->transactions.count(), 50000 + count);
+	delete budget;
+}
+Recurrence *Benchmarks::createRecurrence(Budget *budget, int type) {
+	//every day, or every second week on monday, wednesday and friday, for 25 years with every tenth occurrence removed
+	Recurrence *rec;
+	if(type == RECURRENCE_TYPE_DAILY) {
+		DailyRecurrence *drec = new DailyRecurrence(budget);
+		drec->set(QDate(2000, 1, 1), QDate(2024, 12, 31), 1);
+		rec = drec;
+	} else {
+		WeeklyRecurrence *wrec = new WeeklyRecurrence(budget);
+		wrec->set(QDate(2000, 1, 3), QDate(2024, 12, 31), true, false, true, false, true, false, false, 2);
+		rec = wrec;
+	}
+	QVector<QDate> dates;
+	rec->expandOccurrences(rec->startDate(), rec->endDate(), dates);
+	for(int i = 10; i < dates.count() - 1; i += 10) rec->addException(dates[i]);
+	return rec;
+}
+void Benchmarks::countOccurrences_data() {
+	QTest::addColumn<int>("type");
+	QTest::addColumn<bool>("iterative");
+	QTest::newRow("daily, iterative") << (int) RECURRENCE_TYPE_DAILY << true;
+	QTest::newRow("daily") << (int) RECURRENCE_TYPE_DAILY << false;
+	QTest::newRow("weekly, iterative") << (int) RECURRENCE_TYPE_WEEKLY << true;
+	QTest::newRow("weekly") << (int) RECURRENCE_TYPE_WEEKLY << false;
+}
+void Benchmarks::countOccurrences() {
+	//occurrences in each month of the recurrence
+	QFETCH(int, type);
+	QFETCH(bool, iterative);
+	Budget budget;
+	Recurrence *rec = createRecurrence(&budget, type);
+	int n = 0;
+	QBENCHMARK {
+		n = 0;
+		for(QDate month = rec->startDate(); month <= rec->endDate(); month = month.addMonths(1)) {
+			QDate last_day = month.addMonths(1).addDays(-1);
+			if(iterative) {
+				QDate date = rec->nextOccurrence(month, true);
+				while(!date.isNull() && date <= last_day) {
+					n++;
+					date = rec->nextOccurrence(date);
+				}
+			} else {
+				n += rec->countOccurrences(month, last_day);
+			}
+		}
+	}
+	QCOMPARE(n, rec->countOccurrences(rec->endDate()));
+	delete rec;
+}
+void Benchmarks::expandOccurrences_data() {
+	countOccurrences_data();
+}
+void Benchmarks::expandOccurrences() {
+	QFETCH(int, type);
+	QFETCH(bool, iterative);
+	Budget budget;
+	Recurrence *rec = createRecurrence(&budget, type);
+	QVector<QDate> dates;
+	QBENCHMARK {
+		dates.clear();
+		if(iterative) {
+			QDate date = rec->startDate();
+			while(!date.isNull()) {
+				dates << date;
+				date = rec->nextOccurrence(date);
+			}
+		} else {
+			rec->expandOccurrences(rec->startDate(), rec->endDate(), dates);
+		}
+	}
+	QCOMPARE(dates.count(), rec->countOccurrences(rec->endDate()));
+	delete rec;
+}
+void Benchmarks::filterFirstPaint_data() {
+	QTest::addColumn<int>("count");
+	QTest::addColumn<QString>("description");
+	QTest::newRow("100000") << 100000 << QString();
+	QTest::newRow("100000, description") << 100000 << QString("Item 1");
+	QTest::newRow("300000") << 300000 << QString();
+	QTest::newRow("300000, description") << 300000 << QString("Item 1");
+}
+void Benchmarks::filterFirstPaint() {
+	//time from a changed filter until the first rows of the expense list have been painted (filtering of the list does not need a main window)
+	QFETCH(int, count);
+	QFETCH(QString, description);
+	Budget *budget = createBudget(count);
+	BenchmarkListWidget *widget = new BenchmarkListWidget(budget);
+	widget->resize(800, 600);
+	widget->show();
+	QVERIFY(QTest::qWaitForWindowExposed(widget));
+	widget->setFilter(QDate(), QDate(2024, 12, 31), -1.0, -1.0, NULL, NULL, description);
+	int rows = widget->rowCount();
+	QBENCHMARK {
+		widget->filterFirstSlice();
+	}
+	QVERIFY(widget->rowCount() > 0);
+	widget->filterRemaining();
+	QCOMPARE(widget->rowCount(), rows);
+	delete widget;
+	delete budget;
+}
+
+QTEST_MAIN(Benchmarks)
+#include "benchmarks.moc"
@@ -0,0 +1,6 @@
+TEMPLATE = app
+TARGET = benchmarks
+include(../gui.pri)
+CONFIG -= testcase
+
+SOURCES += benchmarks.cpp
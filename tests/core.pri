@@ -0,0 +1,22 @@
+CONFIG += qt console testcase
+CONFIG -= app_bundle
+QT += testlib network
+INCLUDEPATH += $$PWD/../src
+MOC_DIR = build
+OBJECTS_DIR = build
+DEFINES += DATA_DIR=\\\"$$PWD/../data\\\"
+DEFINES += VERSION=\\\"$$fromfile($$PWD/../Eqonomize.pro, VERSION)\\\"
+
+HEADERS += $$PWD/../src/account.h \
+           $$PWD/../src/budget.h \
+           $$PWD/../src/currency.h \
+           $$PWD/../src/eqonomizelist.h \
+           $$PWD/../src/recurrence.h \
+           $$PWD/../src/security.h \
+           $$PWD/../src/transaction.h
+SOURCES += $$PWD/../src/account.cpp \
+           $$PWD/../src/budget.cpp \
+           $$PWD/../src/currency.cpp \
+           $$PWD/../src/recurrence.cpp \
+           $$PWD/../src/security.cpp \
+           $$PWD/../src/transaction.cpp
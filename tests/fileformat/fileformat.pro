@@ -0,0 +1,4 @@
+TEMPLATE = app
+TARGET = tst_fileformat
+include(../core.pri)
+SOURCES += tst_fileformat.cpp
@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "account.h"
+#include "budget.h"
+#include "recurrence.h"
+#include "transaction.h"
+
+class FileFormatTest : public QObject {
+
+	Q_OBJECT
+
+	protected:
+
+		QTemporaryDir dir;
+
+		Budget *createBudget();
+		Budget *loadBudget(const QString &filename);
+		QByteArray readFile(const QString &filename);
+
+	private slots:
+
+		void binaryRoundTrip();
+
+};
+
+Budget *FileFormatTest::createBudget() {
+	//transactions stored as binary records (with all record fields set), and a split and a schedule stored in the embedded document
+	Budget *budget = new Budget();
+	AssetsAccount *account = new AssetsAccount(budget, ASSETS_TYPE_CURRENT, "Account", 100.0);
+	budget->addAccount(account);
+	AssetsAccount *savings = new AssetsAccount(budget, ASSETS_TYPE_SAVINGS, "Savings");
+	budget->addAccount(savings);
+	ExpensesAccount *food = new ExpensesAccount(budget, "Food");
+	budget->addAccount(food);
+	IncomesAccount *salary = new IncomesAccount(budget, "Salary");
+	budget->addAccount(salary);
+	QList<Transactions*> list;
+	QDate date(2020, 1, 1);
+	for(int i = 0; i < 100; i++) {
+		Transaction *trans;
+		if(i % 3 == 0) {
+			Income *income = new Income(budget, 1000.0 + i, date.addDays(i), salary, account, QString("Salary %1").arg(i), QString("Comment %1").arg(i));
+			income->setPayer("Employer");
+			income->setReconciled(account, i % 2 == 0);
+			trans = income;
+		} else if(i % 3 == 1) {
+			Expense *expense = new Expense(budget, 10.5 + i, date.addDays(i), food, account, QString("Food %1").arg(i % 7));
+			expense->setPayee(QString("Shop %1").arg(i % 4));
+			expense->setQuantity(1.0 + i % 5);
+			expense->setReconciled(account, i % 2 == 0);
+			expense->addTag("Tag 1");
+			if(i % 2 == 0) expense->addTag("Tag 2");
+			if(i % 5 == 0) expense->setAssociatedFile(QString("receipt%1.pdf").arg(i));
+			trans = expense;
+		} else {
+			Transfer *transfer = new Transfer(budget, 50.0, 49.5, date.addDays(i), account, savings, QString("Transfer %1").arg(i));
+			transfer->setReconciled(account, true);
+			transfer->setReconciled(savings, i % 2 == 0);
+			trans = transfer;
+		}
+		trans->setTimestamp(1577836800 + i);
+		if(!list.isEmpty() && i % 10 == 0) {
+			trans->addLinkId(list.last()->id());
+			list.last()->addLinkId(trans->id());
+		}
+		list << trans;
+	}
+	budget->addTransactions(list);
+	MultiItemTransaction *split = new MultiItemTransaction(budget, date.addDays(10), account, "Groceries");
+	split->addTransaction(new Expense(budget, 12.0, date, food, account, "Bread"));
+	split->addTransaction(new Expense(budget, 8.0, date, food, account, "Milk"));
+	budget->addSplitTransaction(split);
+	MonthlyRecurrence *rec = new MonthlyRecurrence(budget);
+	rec->setOnDay(date, QDate(), 25, WEEKEND_HANDLING_NONE, 1);
+	budget->addScheduledTransaction(new ScheduledTransaction(budget, new Expense(budget, 500.0, date, food, account, "Rent"), rec));
+	return budget;
+}
+Budget *FileFormatTest::loadBudget(const QString &filename) {
+	Budget *budget = new Budget();
+	QString errors;
+	QString error = budget->loadFile(filename, errors);
+	if(!error.isNull() || !errors.isEmpty()) {
+		qWarning() << error << errors;
+		delete budget;
+		return NULL;
+	}
+	return budget;
+}
+QByteArray FileFormatTest::readFile(const QString &filename) {
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly)) return QByteArray();
+	return file.readAll();
+}
+
+void FileFormatTest::binaryRoundTrip() {
+	//binary -> XML -> binary gives identical files, and the XML matches the XML of the original budget
+	//(the XML files are saved as backups, which do not have a random save id)
+	QVERIFY(dir.isValid());
+	Budget *budget = createBudget();
+	bool saved = budget->saveFile(dir.filePath("original.eqz"), QFile::ReadUser | QFile::WriteUser, true).isNull() && budget->saveBinary(dir.filePath("first.eqb")).isNull();
+	delete budget;
+	QVERIFY(saved);
+
+	budget = loadBudget(dir.filePath("first.eqb"));
+	QVERIFY(budget);
+	int transactions = budget->transactions.count(), splits = budget->splitTransactions.count(), schedules = budget->scheduledTransactions.count();
+	saved = budget->saveFile(dir.filePath("converted.eqz"), QFile::ReadUser | QFile::WriteUser, true).isNull();
+	delete budget;
+	QVERIFY(saved);
+	QCOMPARE(transactions, 102);
+	QCOMPARE(splits, 1);
+	QCOMPARE(schedules, 1);
+
+	budget = loadBudget(dir.filePath("converted.eqz"));
+	QVERIFY(budget);
+	saved = budget->saveBinary(dir.filePath("second.eqb")).isNull();
+	delete budget;
+	QVERIFY(saved);
+
+	QByteArray original = readFile(dir.filePath("original.eqz"));
+	QVERIFY(!original.isEmpty());
+	QVERIFY(original == readFile(dir.filePath("converted.eqz")));
+	QByteArray first = readFile(dir.filePath("first.eqb"));
+	QVERIFY(!first.isEmpty());
+	QVERIFY(first == readFile(dir.filePath("second.eqb")));
+}
+
+QTEST_GUILESS_MAIN(FileFormatTest)
+#include "tst_fileformat.moc"
@@ -0,0 +1,46 @@
+include(core.pri)
+QT += widgets printsupport
+DEFINES += TRANSLATIONS_DIR=\\\"$$PWD/../translations\\\"
+DEFINES += DOCUMENTATION_DIR=\\\"$$PWD/../doc/html\\\"
+DEFINES += ICON_DIR=\\\"$$PWD/../data\\\"
+
+HEADERS += $$PWD/../src/accountcombobox.h \
+           $$PWD/../src/categoriescomparisonchart.h \
+           $$PWD/../src/categoriescomparisonreport.h \
+           $$PWD/../src/currencyconversiondialog.h \
+           $$PWD/../src/editaccountdialogs.h \
+           $$PWD/../src/editcurrencydialog.h \
+           $$PWD/../src/editscheduledtransactiondialog.h \
+           $$PWD/../src/editsplitdialog.h \
+           $$PWD/../src/eqonomize.h \
+           $$PWD/../src/eqonomizemonthselector.h \
+           $$PWD/../src/eqonomizevalueedit.h \
+           $$PWD/../src/importcsvdialog.h \
+           $$PWD/../src/ledgerdialog.h \
+           $$PWD/../src/overtimechart.h \
+           $$PWD/../src/overtimereport.h \
+           $$PWD/../src/qifimportexport.h \
+           $$PWD/../src/recurrenceeditwidget.h \
+           $$PWD/../src/transactioneditwidget.h \
+           $$PWD/../src/transactionfilterwidget.h \
+           $$PWD/../src/transactionlistwidget.h
+SOURCES += $$PWD/../src/accountcombobox.cpp \
+           $$PWD/../src/categoriescomparisonchart.cpp \
+           $$PWD/../src/categoriescomparisonreport.cpp \
+           $$PWD/../src/currencyconversiondialog.cpp \
+           $$PWD/../src/editaccountdialogs.cpp \
+           $$PWD/../src/editcurrencydialog.cpp \
+           $$PWD/../src/editscheduledtransactiondialog.cpp \
+           $$PWD/../src/editsplitdialog.cpp \
+           $$PWD/../src/eqonomize.cpp \
+           $$PWD/../src/eqonomizemonthselector.cpp \
+           $$PWD/../src/eqonomizevalueedit.cpp \
+           $$PWD/../src/importcsvdialog.cpp \
+           $$PWD/../src/ledgerdialog.cpp \
+           $$PWD/../src/overtimechart.cpp \
+           $$PWD/../src/overtimereport.cpp \
+           $$PWD/../src/qifimportexport.cpp \
+           $$PWD/../src/recurrenceeditwidget.cpp \
+           $$PWD/../src/transactioneditwidget.cpp \
+           $$PWD/../src/transactionfilterwidget.cpp \
+           $$PWD/../src/transactionlistwidget.cpp
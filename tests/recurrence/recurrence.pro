@@ -0,0 +1,4 @@
+TEMPLATE = app
+TARGET = tst_recurrence
+include(../core.pri)
+SOURCES += tst_recurrence.cpp
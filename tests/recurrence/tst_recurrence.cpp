@@ -0,0 +1,206 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "budget.h"
+#include "recurrence.h"
+
+QVector<QDate> iterate_occurrences(const Recurrence *rec, const QDate &enddate) {
+	//steps through the series from the first occurrence (nextOccurrence() from a date which is not an occurrence might skip an occurrence moved into the next month by weekend handling)
+	QVector<QDate> dates;
+	QDate date = rec->firstOccurrence();
+	while(!date.isNull() && date <= enddate) {
+		dates << date;
+		date = rec->nextOccurrence(date);
+	}
+	return dates;
+}
+QVector<QDate> dates_in_range(const QVector<QDate> &dates, const QDate &startdate, const QDate &enddate) {
+	QVector<QDate> range;
+	for(QVector<QDate>::const_iterator it = dates.constBegin(); it != dates.constEnd(); ++it) {
+		if(*it >= startdate && *it <= enddate) range << *it;
+	}
+	return range;
+}
+
+class RecurrenceTest : public QObject {
+
+	Q_OBJECT
+
+	protected:
+
+		Budget budget;
+
+		QList<Recurrence*> createRecurrences();
+
+	private slots:
+
+		void countFixedOccurrences();
+		void weeklyStartWeek();
+		void countOccurrences();
+		void expandOccurrences();
+
+};
+
+void RecurrenceTest::countFixedOccurrences() {
+	DailyRecurrence rec(&budget);
+	rec.set(QDate(2020, 1, 1), QDate(), 1, 10);
+	QCOMPARE(rec.lastOccurrence(), QDate(2020, 1, 10));
+	QCOMPARE(rec.countOccurrences(QDate(2019, 12, 1), QDate(2020, 2, 1)), 10);
+	QCOMPARE(rec.countOccurrences(QDate(2020, 1, 1), QDate(2020, 1, 10)), 10);
+	//ranges ending before the last occurrence
+	QCOMPARE(rec.countOccurrences(QDate(2020, 1, 1), QDate(2020, 1, 5)), 5);
+	QCOMPARE(rec.countOccurrences(QDate(2020, 1, 9)), 9);
+	QCOMPARE(rec.countOccurrences(QDate(2019, 12, 31)), 0);
+}
+void RecurrenceTest::weeklyStartWeek() {
+	//every third week on monday and wednesday, 2019-12-30 is in ISO week 1 (as the start date), but 52 weeks later
+	WeeklyRecurrence rec(&budget);
+	rec.set(QDate(2019, 1, 2), QDate(), true, false, true, false, false, false, false, 3);
+	QCOMPARE(rec.nextOccurrence(QDate(2019, 12, 23)), QDate(2019, 12, 25));
+	QCOMPARE(rec.nextOccurrence(QDate(2019, 12, 25)), QDate(2020, 1, 13));
+	QCOMPARE(rec.nextOccurrence(QDate(2019, 12, 29)), QDate(2020, 1, 13));
+	QCOMPARE(rec.countOccurrences(QDate(2019, 12, 26), QDate(2020, 1, 12)), 0);
+}
+QList<Recurrence*> RecurrenceTest::createRecurrences() {
+	//recurrences of all types with different frequencies, end dates and exceptions
+	QList<Recurrence*> list;
+	QDate start_dates[] = {QDate(2019, 1, 2), QDate(2020, 2, 29), QDate(2021, 12, 27), QDate(2022, 1, 9)};
+	for(int i_date = 0; i_date < 4; i_date++) {
+		const QDate &start_date = start_dates[i_date];
+		int frequencies[] = {1, 2, 3, 5, 13};
+		for(int i_freq = 0; i_freq < 5; i_freq++) {
+			int frequency = frequencies[i_freq];
+			DailyRecurrence *drec = new DailyRecurrence(&budget);
+			drec->set(start_date, QDate(), frequency);
+			list << drec;
+			drec = new DailyRecurrence(&budget);
+			drec->set(start_date, start_date.addDays(400), frequency);
+			list << drec;
+			drec = new DailyRecurrence(&budget);
+			drec->set(start_date, QDate(), frequency, 50);
+			list << drec;
+			WeeklyRecurrence *wrec = new WeeklyRecurrence(&budget);
+			wrec->set(start_date, QDate(), true, false, true, false, false, false, false, frequency);
+			list << wrec;
+			wrec = new WeeklyRecurrence(&budget);
+			wrec->set(start_date, start_date.addDays(800), false, false, false, false, true, true, true, frequency);
+			list << wrec;
+			wrec = new WeeklyRecurrence(&budget);
+			wrec->set(start_date, QDate(), start_date.dayOfWeek() == 1, start_date.dayOfWeek() == 2, start_date.dayOfWeek() == 3, start_date.dayOfWeek() == 4, start_date.dayOfWeek() == 5, start_date.dayOfWeek() == 6, start_date.dayOfWeek() == 7, frequency, 30);
+			list << wrec;
+			wrec = new WeeklyRecurrence(&budget);
+			wrec->set(start_date, QDate(), true, true, true, true, true, true, true, frequency);
+			list << wrec;
+		}
+		for(int frequency = 1; frequency <= 3; frequency++) {
+			WeekendHandling weekend_handlings[] = {WEEKEND_HANDLING_NONE, WEEKEND_HANDLING_BEFORE, WEEKEND_HANDLING_AFTER, WEEKEND_HANDLING_NEAREST};
+			for(int i_wh = 0; i_wh < 4; i_wh++) {
+				WeekendHandling weekend_handling = weekend_handlings[i_wh];
+				MonthlyRecurrence *mrec = new MonthlyRecurrence(&budget);
+				mrec->setOnDay(start_date, QDate(), 31, weekend_handling, frequency);
+				list << mrec;
+				mrec = new MonthlyRecurrence(&budget);
+				mrec->setOnDay(start_date, QDate(), 1, weekend_handling, frequency, 20);
+				list << mrec;
+				mrec = new MonthlyRecurrence(&budget);
+				mrec->setOnDay(start_date, start_date.addDays(700), 0, weekend_handling, frequency);
+				list << mrec;
+				mrec = new MonthlyRecurrence(&budget);
+				mrec->setOnDay(start_date, QDate(), 15, weekend_handling, frequency);
+				list << mrec;
+			}
+			MonthlyRecurrence *mrec = new MonthlyRecurrence(&budget);
+			mrec->setOnDayOfWeek(start_date, QDate(), 5, 5, frequency);
+			list << mrec;
+			mrec = new MonthlyRecurrence(&budget);
+			mrec->setOnDayOfWeek(start_date, start_date.addDays(1000), 1, -1, frequency);
+			list << mrec;
+			YearlyRecurrence *yrec = new YearlyRecurrence(&budget);
+			yrec->setOnDayOfYear(start_date, QDate(), 60, WEEKEND_HANDLING_NONE, frequency);
+			list << yrec;
+			yrec = new YearlyRecurrence(&budget);
+			yrec->setOnDayOfYear(start_date, QDate(), 366, WEEKEND_HANDLING_NONE, frequency);
+			list << yrec;
+			yrec = new YearlyRecurrence(&budget);
+			yrec->setOnDayOfMonth(start_date, QDate(), 2, 29, WEEKEND_HANDLING_NONE, frequency);
+			list << yrec;
+			yrec = new YearlyRecurrence(&budget);
+			yrec->setOnDayOfMonth(start_date, QDate(), 1, 15, WEEKEND_HANDLING_AFTER, frequency, 4);
+			list << yrec;
+			yrec = new YearlyRecurrence(&budget);
+			yrec->setOnDayOfWeek(start_date, QDate(), 11, 4, 4, frequency);
+			list << yrec;
+			yrec = new YearlyRecurrence(&budget);
+			yrec->setOnDayOfWeek(start_date, start_date.addDays(2000), 5, 1, -1, frequency);
+			list << yrec;
+		}
+	}
+	int n = list.count();
+	for(int i = 0; i < n; i++) {
+		//the same recurrence with every fifth occurrence, and a date which is not an occurrence, removed
+		Recurrence *rec = list[i]->copy();
+		QVector<QDate> dates = iterate_occurrences(rec, rec->startDate().addDays(1500));
+		for(int i_date = 5; i_date < dates.count() - 1; i_date += 5) rec->addException(dates[i_date]);
+		if(dates.count() > 2) {
+			QDate date = dates[1].addDays(1);
+			if(date != dates[2]) rec->addException(date);
+		}
+		list << rec;
+	}
+	return list;
+}
+void RecurrenceTest::countOccurrences() {
+	QList<Recurrence*> list = createRecurrences();
+	int lengths[] = {0, 1, 6, 7, 13, 30, 364, 1500};
+	for(QList<Recurrence*>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) {
+		Recurrence *rec = *it;
+		QVector<QDate> occurrences = iterate_occurrences(rec, rec->startDate().addDays(2500));
+		for(QDate startdate = rec->startDate().addDays(-10); startdate < rec->startDate().addDays(900); startdate = startdate.addDays(37)) {
+			for(int i = 0; i < 8; i++) {
+				QDate enddate = startdate.addDays(lengths[i]);
+				QCOMPARE(rec->countOccurrences(startdate, enddate), dates_in_range(occurrences, startdate, enddate).count());
+			}
+		}
+		QCOMPARE(rec->countOccurrences(rec->startDate().addDays(1500)), dates_in_range(occurrences, rec->startDate(), rec->startDate().addDays(1500)).count());
+	}
+	qDeleteAll(list);
+}
+void RecurrenceTest::expandOccurrences() {
+	QList<Recurrence*> list = createRecurrences();
+	int lengths[] = {0, 1, 6, 7, 13, 30, 364, 1500};
+	for(QList<Recurrence*>::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) {
+		Recurrence *rec = *it;
+		QVector<QDate> occurrences = iterate_occurrences(rec, rec->startDate().addDays(2500));
+		for(QDate startdate = rec->startDate().addDays(-10); startdate < rec->startDate().addDays(900); startdate = startdate.addDays(37)) {
+			for(int i = 0; i < 8; i++) {
+				QDate enddate = startdate.addDays(lengths[i]);
+				QVector<QDate> dates;
+				rec->expandOccurrences(startdate, enddate, dates);
+				QCOMPARE(dates, dates_in_range(occurrences, startdate, enddate));
+			}
+		}
+	}
+	qDeleteAll(list);
+}
+
+QTEST_GUILESS_MAIN(RecurrenceTest)
+#include "tst_recurrence.moc"